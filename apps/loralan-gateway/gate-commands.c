@@ -54,8 +54,11 @@ static void exec_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *
 
 	switch (c) {
 	case CMD_PING:
+		/* Select replies framing, pong is sent already framed the new way */
+		gc_set_framing((payload[0] == GC_PING_BINARY) ? GC_FRAMING_BINARY : GC_FRAMING_TEXT);
+
 		/* Send pong response */
-		gc_pending_fifo_push(fifo, "!\n");
+		gc_reply_pong(fifo);
 
 		/* Send flush message */
 		msg_t msg;
@@ -64,20 +67,10 @@ static void exec_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *
 		break;
 
 	case CMD_DEVLIST:
+		/* List is streamed to the writer as the queue drains, so it's not limited by the queue size */
 		for (int i = 0; i < LS_GATE_MAX_NODES; i++) {
-			if (!devs->nodes_free_list[i]) {
-				char buf[128];
-
-				/* L */
-				sprintf(buf, "%c%08X%08X%08X%08X%04X%04X\n", REPLY_LIST,
-						(unsigned int) (devs->nodes[i].node_id >> 32), (unsigned int) (devs->nodes[i].node_id & 0xFFFFFFFF),
-						(unsigned int) (devs->nodes[i].app_id >> 32), (unsigned int) (devs->nodes[i].app_id & 0xFFFFFFFF),
-						(unsigned int) ((ls->_internal.ping_count - devs->nodes[i].last_seen) * LS_PING_TIMEOUT_S),
-						(unsigned int) devs->nodes[i].node_class);
-
-				if (!gc_pending_fifo_push(fifo, buf)) {
-					puts("gc: pending fifo overflowed!");
-				}
+			if (ls_devlist_is_in_network(devs, i)) {
+				gc_reply_list(fifo, writer, ls, &devs->nodes[i]);
 			}
 		}
 
@@ -121,7 +114,11 @@ static void exec_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *
 		}
 
 		/* Send LoRa message */
-		ls_gate_send_to(ls, node->addr, a, numdigits / 2);
+		if (ls_gate_send_to(ls, node->addr, a, numdigits / 2) == -LS_E_PQ_OVERFLOW) {
+			printf("[error] Downlink queue is full, data for %08X%08X dropped.\n",
+                    (unsigned int) (nodeid >> 32),
+                    (unsigned int) (nodeid & 0xFFFFFFFF));
+		}
 		break;
 	}
 
@@ -287,7 +284,7 @@ static void exec_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *
 
 	case CMD_KICK_ALL_STATIC: {
 		for (int i = 0; i < LS_GATE_MAX_NODES; i++) {
-			if (!devs->nodes_free_list[i]) {
+			if (ls_devlist_is_in_network(devs, i)) {
 				if (devs->nodes[i].is_static) {
 					/* Remove device */
 					ls_devlist_remove_device(devs, i);
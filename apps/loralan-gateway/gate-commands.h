@@ -68,6 +68,42 @@ typedef enum {
 	REPLY_PENDING_REQ = 'R', /* Gate requesting pending frames from upper layer */
 } gate_reply_type_t;
 
+/*
+ * Replies framing, selected by the host with the CMD_PING argument:
+ * "P" switches to text framing, "PB" switches to binary framing. Commands are always text.
+ *
+ * Text framing: reply type character followed by fields in hex digits and '\n'.
+ *
+ * Binary framing: every reply is a SLIP (RFC 1055) frame delimited by GC_SLIP_END bytes.
+ * Frame holds reply type byte, raw reply fields and CRC16-CCITT (initial value 0x1D0F)
+ * of the type and fields. Multibyte values including the CRC are big-endian.
+ *
+ *	REPLY_PONG									type
+ *	REPLY_LIST									type, node ID (8), app ID (8), last seen in seconds (4), node class (1)
+ *	REPLY_IND									type, node ID (8), RSSI (2), node status (1), payload (N)
+ *	REPLY_JOIN									type, node ID (8), node class (1)
+ *	REPLY_KICK, REPLY_ACK, REPLY_PENDING_REQ	type, node ID (8)
+ */
+typedef enum {
+	GC_FRAMING_TEXT = 0,		/* ASCII hex lines */
+	GC_FRAMING_BINARY,			/* SLIP frames with CRC */
+} gc_framing_t;
+
+#define GC_PING_BINARY 'B'		/* CMD_PING argument to switch replies to binary framing */
+
+#define GC_SLIP_END		(0xC0)
+#define GC_SLIP_ESC		(0xDB)
+#define GC_SLIP_ESC_END	(0xDC)
+#define GC_SLIP_ESC_ESC	(0xDD)
+
 void gc_parse_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *fifo, char *cmd);
 
+void gc_set_framing(gc_framing_t framing);
+
+void gc_reply_pong(gc_pending_fifo_t *fifo);
+void gc_reply_list(gc_pending_fifo_t *fifo, kernel_pid_t writer, ls_gate_t *ls, ls_gate_node_t *node);
+void gc_reply_node(gc_pending_fifo_t *fifo, gate_reply_type_t type, uint64_t node_id);
+void gc_reply_join(gc_pending_fifo_t *fifo, ls_gate_node_t *node);
+void gc_reply_ind(gc_pending_fifo_t *fifo, ls_gate_node_t *node, int16_t rssi, uint8_t status, uint8_t *buf, size_t bufsize);
+
 #endif /* GATE_COMMANDS_H_ */
@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup    
+ * @ingroup     
+ * @brief       
+ * @{
+ * @file		gate-replies.c
+ * @brief       gate replies to the host in text and binary framing
+ * @author      Eugene Ponomarev
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "utils.h"
+#include "pending-fifo.h"
+#include "gate-commands.h"
+#include "ls-gate.h"
+#include "iolist.h"
+#include "checksum/crc16_ccitt.h"
+
+/* Switched by the reader thread, read by the threads sending replies */
+static atomic_int framing = ATOMIC_VAR_INIT(GC_FRAMING_TEXT);
+
+static inline bool binary_framing(void) {
+	return atomic_load(&framing) == GC_FRAMING_BINARY;
+}
+
+void gc_set_framing(gc_framing_t f) {
+	atomic_store(&framing, f);
+}
+
+/* Appends byte to the reply being built, escaping SLIP special characters */
+static void slip_put(gc_pending_fifo_t *fifo, uint8_t byte) {
+	if (byte == GC_SLIP_END || byte == GC_SLIP_ESC) {
+		uint8_t esc[2] = { GC_SLIP_ESC, (byte == GC_SLIP_END) ? GC_SLIP_ESC_END : GC_SLIP_ESC_ESC };
+		gc_pending_fifo_write(fifo, esc, sizeof(esc));
+		return;
+	}
+
+	gc_pending_fifo_write(fifo, &byte, 1);
+}
+
+/* Replies streamed by commands wait for the writer, replies from the radio callbacks are dropped when queue is full */
+static void push_reply(gc_pending_fifo_t *fifo, const void *buf, size_t len, kernel_pid_t writer) {
+	bool ok;
+
+	if (writer != KERNEL_PID_UNDEF) {
+		ok = gc_pending_fifo_push_wait(fifo, buf, len, writer);
+	} else {
+		ok = gc_pending_fifo_push_len(fifo, buf, len);
+	}
+
+	if (!ok) {
+		puts("gc: pending fifo overflowed!");
+	}
+}
+
+/**
+ * @brief Encodes reply fields into SLIP frame with trailing CRC right in the queue
+ */
+static void push_binary(gc_pending_fifo_t *fifo, const iolist_t *iol, kernel_pid_t writer) {
+	const uint8_t end = GC_SLIP_END;
+	uint16_t crc = crc16_ccitt_calc(NULL, 0);
+	size_t len = 0;
+
+	for (const iolist_t *i = iol; i != NULL; i = i->iol_next) {
+		len += i->iol_len;
+	}
+
+	/* Room for the frame delimiters and every byte escaped, CRC included */
+	if (!gc_pending_fifo_begin(fifo, 2 + 2 * (len + 2), writer)) {
+		puts("gc: pending fifo overflowed!");
+		return;
+	}
+
+	/* Leading END flushes any line noise accumulated by the host */
+	gc_pending_fifo_write(fifo, &end, 1);
+
+	for (; iol != NULL; iol = iol->iol_next) {
+		const uint8_t *data = iol->iol_base;
+
+		crc = crc16_ccitt_update(crc, data, iol->iol_len);
+
+		for (size_t i = 0; i < iol->iol_len; i++) {
+			slip_put(fifo, data[i]);
+		}
+	}
+
+	slip_put(fifo, crc >> 8);
+	slip_put(fifo, crc & 0xFF);
+
+	gc_pending_fifo_write(fifo, &end, 1);
+	gc_pending_fifo_end(fifo);
+}
+
+static uint8_t *put_be(uint8_t *dst, uint64_t value, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		dst[i] = value >> (8 * (size - 1 - i));
+	}
+
+	return dst + size;
+}
+
+void gc_reply_pong(gc_pending_fifo_t *fifo) {
+	if (binary_framing()) {
+		uint8_t type = REPLY_PONG;
+		iolist_t iol = { .iol_base = &type, .iol_len = 1 };
+
+		push_binary(fifo, &iol, KERNEL_PID_UNDEF);
+	} else {
+		gc_pending_fifo_push(fifo, "!\n");
+	}
+}
+
+void gc_reply_list(gc_pending_fifo_t *fifo, kernel_pid_t writer, ls_gate_t *ls, ls_gate_node_t *node) {
+	uint32_t last_seen = (ls->_internal.ping_count - node->last_seen) * LS_PING_TIMEOUT_S;
+
+	if (binary_framing()) {
+		uint8_t reply[1 + 8 + 8 + 4 + 1];
+		uint8_t *p = reply;
+
+		*p++ = REPLY_LIST;
+		p = put_be(p, node->node_id, 8);
+		p = put_be(p, node->app_id, 8);
+		p = put_be(p, last_seen, 4);
+		*p++ = node->node_class;
+
+		iolist_t iol = { .iol_base = reply, .iol_len = sizeof(reply) };
+		push_binary(fifo, &iol, writer);
+		return;
+	}
+
+	char buf[128];
+
+	/* L */
+	sprintf(buf, "%c%08X%08X%08X%08X%04X%04X\n", REPLY_LIST,
+			(unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF),
+			(unsigned int) (node->app_id >> 32), (unsigned int) (node->app_id & 0xFFFFFFFF),
+			(unsigned int) last_seen,
+			(unsigned int) node->node_class);
+
+	push_reply(fifo, buf, strlen(buf), writer);
+}
+
+void gc_reply_node(gc_pending_fifo_t *fifo, gate_reply_type_t type, uint64_t node_id) {
+	if (binary_framing()) {
+		uint8_t reply[1 + 8];
+
+		reply[0] = type;
+		put_be(reply + 1, node_id, 8);
+
+		iolist_t iol = { .iol_base = reply, .iol_len = sizeof(reply) };
+		push_binary(fifo, &iol, KERNEL_PID_UNDEF);
+		return;
+	}
+
+	char str[19] = {};
+	sprintf(str, "%c%08X%08X\n", type, (unsigned int) (node_id >> 32), (unsigned int) (node_id & 0xFFFFFFFF));
+
+	gc_pending_fifo_push(fifo, str);
+}
+
+void gc_reply_join(gc_pending_fifo_t *fifo, ls_gate_node_t *node) {
+	if (binary_framing()) {
+		uint8_t reply[1 + 8 + 1];
+
+		reply[0] = REPLY_JOIN;
+		put_be(reply + 1, node->node_id, 8);
+		reply[9] = node->node_class;
+
+		iolist_t iol = { .iol_base = reply, .iol_len = sizeof(reply) };
+		push_binary(fifo, &iol, KERNEL_PID_UNDEF);
+		return;
+	}
+
+	char str[128] = { '\0' };
+	sprintf(str, "%c%08X%08X%u\n", REPLY_JOIN, (unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF), (unsigned int) node->node_class);
+
+	gc_pending_fifo_push(fifo, str);
+}
+
+void gc_reply_ind(gc_pending_fifo_t *fifo, ls_gate_node_t *node, int16_t rssi, uint8_t status, uint8_t *buf, size_t bufsize) {
+	if (binary_framing()) {
+		uint8_t hdr[1 + 8 + 2 + 1];
+
+		hdr[0] = REPLY_IND;
+		put_be(hdr + 1, node->node_id, 8);
+		put_be(hdr + 9, (uint16_t) rssi, 2);
+		hdr[11] = status;
+
+		/* Payload is encoded right from the frame buffer */
+		iolist_t data = { .iol_base = buf, .iol_len = bufsize };
+		iolist_t iol = { .iol_next = &data, .iol_base = hdr, .iol_len = sizeof(hdr) };
+
+		push_binary(fifo, &iol, KERNEL_PID_UNDEF);
+		return;
+	}
+
+	char hex[GC_MAX_REPLY_LEN - 19] = {};
+	if (bufsize > sizeof(hex))
+		bufsize = sizeof(hex);
+
+	char buf_rssi[5] = {};
+	bytes_to_hex((uint8_t *) &rssi, 2, buf_rssi, true);
+
+	char buf_status[5]  = {};
+	bytes_to_hex(&status, 1, buf_status, true);
+
+	bytes_to_hex(buf, bufsize, hex, false);
+	printf("Data: %u bytes, 0x%s\n", (unsigned) bufsize, hex);
+
+	char str[GC_MAX_REPLY_LEN] = { };
+	sprintf(str, "%c%08X%08X%s%s%s\n", REPLY_IND,
+			(unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF),
+			buf_rssi,
+			buf_status,
+			hex);
+
+	gc_pending_fifo_push(fifo, str);
+}
+
+#ifdef __cplusplus
+}
+#endif
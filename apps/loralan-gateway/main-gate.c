@@ -137,11 +137,12 @@ static void *writer(void *arg)
     while (1) {
         msg_receive(&msg);
 
-        char buf[GC_MAX_REPLY_LEN];
-        while (!gc_pending_fifo_empty(&fifo)) {
-            if (gc_pending_fifo_pop(&fifo, buf)) {
-                uart_write(uart, (uint8_t *) buf, strlen(buf));
-            }
+        /* Replies are written right from the queue memory */
+        const uint8_t *data;
+        size_t len;
+        while ((len = gc_pending_fifo_peek(&fifo, &data)) > 0) {
+            uart_write(uart, data, len);
+            gc_pending_fifo_consume(&fifo, len);
         }
     }
 
@@ -232,11 +233,7 @@ static void node_kicked_cb(ls_gate_node_t *node)
 {
     printf("ls-gate: node 0x%08X%08X kicked for long silence\n", (unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF));
 
-    char str[18] = {};
-
-    sprintf(str, "%c%08X%08X\n", REPLY_KICK, (unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF));
-
-    gc_pending_fifo_push(&fifo, str);
+    gc_reply_node(&fifo, REPLY_KICK, node->node_id);
 }
 
 static uint32_t node_joined_cb(ls_gate_node_t *node)
@@ -246,10 +243,7 @@ static uint32_t node_joined_cb(ls_gate_node_t *node)
            (unsigned int) node->addr);
 
     /* Notify the gate */
-    char str[128] = { '\0' };
-    sprintf(str, "%c%08X%08X%u\n", REPLY_JOIN, (unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF), (unsigned int) node->node_class);
-
-    gc_pending_fifo_push(&fifo, str);
+    gc_reply_join(&fifo, node);
 
     /* Return random app nonce */
     return sx127x_random(&sx127x);
@@ -265,29 +259,7 @@ static bool accept_node_join_cb(uint64_t dev_id, uint64_t app_id)
 
 void app_data_received_cb(ls_gate_node_t *node, ls_gate_channel_t *ch, uint8_t *buf, size_t bufsize, uint8_t status)
 {
-    char hex[GC_MAX_REPLY_LEN - 19] = {};
-    if (bufsize > sizeof(hex))
-    	bufsize = sizeof(hex);
-
-    int16_t rssi = ch->last_rssi;
-
-    char buf_rssi[5] = {};
-    bytes_to_hex((uint8_t *) &rssi, 2, buf_rssi, true);
-    
-    char buf_status[5]  = {};
-    bytes_to_hex(&status, 1, buf_status, true);
-
-    bytes_to_hex(buf, bufsize, hex, false);
-    printf("Data: %u bytes, 0x%s\n", bufsize, hex);
-
-    char str[GC_MAX_REPLY_LEN] = { };
-    sprintf(str, "%c%08X%08X%s%s%s\n", REPLY_IND,
-    		(unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF),
-			buf_rssi,
-            buf_status,
-			hex);
-
-    gc_pending_fifo_push(&fifo, str);
+    gc_reply_ind(&fifo, node, ch->last_rssi, status, buf, bufsize);
 }
 
 void app_data_ack_cb(ls_gate_node_t *node, ls_gate_channel_t *ch)
@@ -296,20 +268,13 @@ void app_data_ack_cb(ls_gate_node_t *node, ls_gate_channel_t *ch)
     
     printf("ls-gate: data acknowledged from 0x%08X%08X\n", (unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF));
 
-    char str[18] = {};
-
-    sprintf(str, "%c%08X%08X\n", REPLY_ACK, (unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF));
-
-    gc_pending_fifo_push(&fifo, str);
+    gc_reply_node(&fifo, REPLY_ACK, node->node_id);
 }
 
 static void pending_frames_req_cb(ls_gate_node_t *node) {
 	printf("ls-gate: requesting next pending frame for 0x%08X%08X\n", (unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF));
 
-    char str[18] = {};
-    sprintf(str, "%c%08X%08X\n", REPLY_PENDING_REQ,
-    		(unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF));
-    gc_pending_fifo_push(&fifo, str);
+    gc_reply_node(&fifo, REPLY_PENDING_REQ, node->node_id);
 }
 
 static void ls_setup(ls_gate_t *ls)
@@ -406,7 +371,7 @@ static int ls_list_cmd(int argc, char **argv)
     printf("num.\t|\taddr.\t\t|\tnode id.\t\t|\tapp id.\t\t\t|\tlast seen\n");
 
     for (int i = 0; i < LS_GATE_MAX_NODES; i++) {
-        if (!devs->nodes_free_list[i]) {
+        if (ls_devlist_is_in_network(devs, i)) {
             printf("%02d.\t|\t0x%08X\t|\t0x%08X%08X\t|\t0x%08X%08X\t|\t%d sec. ago\n", (unsigned int) (i + 1),
                    (unsigned int) devs->nodes[i].addr,
                    (unsigned int) (devs->nodes[i].node_id >> 32), (unsigned int) (devs->nodes[i].node_id & 0xFFFFFFFF),
@@ -55,6 +55,8 @@ extern "C" {
 
 #include "unwds-common.h"
 #include "unwds-gpio.h"
+#include "unwds-batch.h"
+#include "unwds-tlv.h"
 #include "ls-settings.h"
 #include "ls-end-device.h"
 #include "ls-init-device.h"
@@ -177,6 +179,9 @@ static void time_req_ack_cb(time_t time) {
 
 void appdata_send_failed_cb(void)
 {
+	/* Readings are based on the ones the network didn't get */
+	unwds_tlv_uplink_lost();
+
 	if (!unwds_get_node_settings().no_join) {
 		puts("[LoRa] rejoining");
 //		joined_timeout_cb();
@@ -267,6 +272,7 @@ static void ls_setup(ls_ed_t *ls)
     ls->settings.class = unwds_get_node_settings().nodeclass;
 
     ls->settings.dr = unwds_get_node_settings().dr;
+    ls->settings.adr = unwds_get_node_settings().adr;
     ls->settings.channel = unwds_get_node_settings().channel;
 
     ls->settings.channels_table = regions[unwds_get_node_settings().region_index].channels;
@@ -310,6 +316,7 @@ int ls_set_cmd(int argc, char **argv)
         printf("\tregion <0-%d> -- sets channels region\n", LS_UNI_NUM_REGIONS - 1);
         puts("\tch <ch> -- sets device channel in selected region");
         puts("\tdr <0-6> -- sets device data rate [0 - slowest, 3 - average, 6 - fastest]");
+        puts("\tadr <0/1> -- lets the gateway adjust data rate and TX power");
         puts("\tmaxretr <0-255> -- sets maximum number of retransmissions of confirmed app. data [5 is recommended]");
         puts("\tclass <A/B/C> -- sets device class");
         puts("\time -- request network time");
@@ -328,6 +335,11 @@ int ls_set_cmd(int argc, char **argv)
 
         ls.settings.dr = (ls_datarate_t) v;
     }
+    else if (strcmp(key, "adr") == 0) {
+    	char v = value[0];
+
+    	ls.settings.adr = (v == '1');
+    }
     else if (strcmp(key, "ch") == 0) {
         uint8_t v = strtol(value, NULL, 10);
 
@@ -402,6 +414,7 @@ int ls_set_cmd(int argc, char **argv)
 
     unwds_set_channel(ls.settings.channel);
     unwds_set_dr(ls.settings.dr);
+    unwds_set_adr(ls.settings.adr);
     unwds_set_max_retr(ls.settings.max_retr);
     unwds_set_class(ls.settings.class);
 
@@ -458,6 +471,8 @@ static void print_config(void)
     printf("CHANNEL = %d [%d]\n", unwds_get_node_settings().channel, (unsigned) regions[unwds_get_node_settings().region_index].channels[unwds_get_node_settings().channel]);
 
     printf("DATARATE = %d\n", unwds_get_node_settings().dr);
+
+    printf("ADR = %s\n", (unwds_get_node_settings().adr) ? "yes" : "no");
     
     printf("CONFIRMED = %s\n", (unwds_get_node_settings().confirmation) ? "yes" : "no");
     
@@ -645,6 +660,11 @@ static void unwds_callback(module_data_t *buf)
     int res = ls_ed_send_app_data(&ls, buf->data, buf->length, true, buf->as_ack, false);
 
     if (res < 0) {
+        /* Data waits in the FIFO until the node joins, otherwise it's lost */
+        if (res != -LS_SEND_E_NOT_JOINED) {
+            unwds_tlv_uplink_lost();
+        }
+
         if (res == -LS_SEND_E_FQ_OVERFLOW) {
             puts("[error] Uplink queue overflowed!");
         }
@@ -667,6 +687,12 @@ static void unwds_callback(module_data_t *buf)
     blink_led(LED_GREEN);
 }
 
+/* Confirmed app. data is kept in the FIFO until acknowledged, batch must fit there */
+static size_t batch_max_payload(void)
+{
+    return APPDATA_FIFO_MAX_APPDATA_SIZE;
+}
+
 static int unwds_init(void) {
     radio_init();
     ls_setup(&ls);
@@ -696,7 +722,9 @@ void init_normal(shell_command_t *commands)
         puts("[!] Device is not configured yet. Type \"help\" to see list of possible configuration commands.");
         puts("[!] Configure the node and type \"reboot\" to reboot and apply settings.");
     } else {
-        unwds_device_init(unwds_callback, unwds_init, unwds_join, unwds_sleep);
+        /* Readings are coalesced into batches if UNWDS_BATCH_LATENCY_MS is set */
+        unwds_batch_init(unwds_callback, batch_max_payload, UNWDS_BATCH_LATENCY_MS);
+        unwds_device_init(unwds_batch_push, unwds_init, unwds_join, unwds_sleep);
     }
 
     /* Add our commands to shell */
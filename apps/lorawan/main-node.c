@@ -63,6 +63,8 @@ extern "C" {
 
 #include "unwds-common.h"
 #include "unwds-gpio.h"
+#include "unwds-batch.h"
+#include "unwds-tlv.h"
 
 #include "main.h"
 #include "utils.h"
@@ -189,6 +191,9 @@ static void *sender_thread(void *arg) {
                 case MSG_TYPE_LORAMAC_TX_CNF_FAILED:
                     puts("[LoRa] Uplink confirmation failed");
                     uplinks_failed++;
+
+                    /* Readings are based on the ones the network didn't get */
+                    unwds_tlv_uplink_lost();
                     
                     if (uplinks_failed > unwds_get_node_settings().max_retr) {
                         puts("[LoRa] Too many uplinks failed, rejoining");
@@ -579,6 +584,7 @@ static void unwds_callback(module_data_t *buf)
             bytes = 32;
         } else {
             printf("[LoRa] Payload too big: %d bytes (should be 30 bytes max)\n", buf->length);
+            unwds_tlv_uplink_lost();
             return;
         }
     }
@@ -610,6 +616,10 @@ static void unwds_callback(module_data_t *buf)
     
     int res = semtech_loramac_send(&ls, buf->data, buf->length);
 
+    if (res != SEMTECH_LORAMAC_TX_SCHEDULED) {
+        unwds_tlv_uplink_lost();
+    }
+
     switch (res) {
         case SEMTECH_LORAMAC_BUSY:
             puts("[error] MAC already busy");
@@ -636,6 +646,12 @@ static void unwds_callback(module_data_t *buf)
     blink_led(LED_GREEN);
 }
 
+/* Payload is padded to 32 bytes at most, with 2 status bytes at the end */
+static size_t batch_max_payload(void)
+{
+    return 30;
+}
+
 static int unwds_init(void) {
     radio_init();
     ls_setup(&ls);
@@ -644,6 +660,12 @@ static int unwds_init(void) {
 }
 
 static void unwds_join(void) {
+    /* Resume the session saved before reset instead of joining again */
+    if (semtech_loramac_restore_session(&ls)) {
+        puts("[LoRa] session restored, join skipped");
+        return;
+    }
+
     msg_send(&msg_join, sender_pid);
 }
 
@@ -666,7 +688,9 @@ void init_normal(shell_command_t *commands)
         sender_pid = thread_create(sender_stack, sizeof(sender_stack), THREAD_PRIORITY_MAIN - 2,
                                    THREAD_CREATE_STACKTEST, sender_thread, &ls,  "LoRa sender thread");
 
-        unwds_device_init(unwds_callback, unwds_init, unwds_join, unwds_sleep);
+        /* Readings are coalesced into batches if UNWDS_BATCH_LATENCY_MS is set */
+        unwds_batch_init(unwds_callback, batch_max_payload, UNWDS_BATCH_LATENCY_MS);
+        unwds_device_init(unwds_batch_push, unwds_init, unwds_join, unwds_sleep);
     }
     
     /* Add our commands to shell */
@@ -33,18 +33,322 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdio.h>
 
 #include "appdata-fifo.h"
-#include "mutex.h"
+#include "mutex_pi.h"
 #include "irq.h"
 
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+#ifdef APPDATA_FIFO_PERSISTENT
+#include "assert.h"
+#include "cpu.h"
+#include "periph/eeprom.h"
+#include "checksum/fletcher16.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#ifdef APPDATA_FIFO_PERSISTENT
+
+/* EEPROM record layout */
+#define RECORD_SEQ      0
+#define RECORD_SIZE     2
+#define RECORD_FLAGS    3
+#define RECORD_ID       4
+#define RECORD_DATA     5
+#define RECORD_CRC      (RECORD_DATA + APPDATA_FIFO_MAX_APPDATA_SIZE)
+#define RECORD_STATE    (RECORD_CRC + 2)
+
+#define RECORD_FLAG_CONFIRMED   (1 << 0)
+#define RECORD_FLAG_WITH_ACK    (1 << 1)
+
+/* State byte is written apart from the record and is not covered by the checksum */
+#define RECORD_STATE_PENDING    0x5A
+#define RECORD_STATE_COMMITTED  0xA5
+
+#ifdef EEPROM_SIZE
+static_assert(APPDATA_FIFO_EEPROM_ADDR + APPDATA_FIFO_SIZE * APPDATA_FIFO_RECORD_SIZE <= EEPROM_SIZE,
+              "appdata-fifo: APPDATA_FIFO_SIZE records don't fit into the EEPROM");
+#endif
+
+static uint32_t record_addr(int i) {
+	return APPDATA_FIFO_EEPROM_ADDR + i * APPDATA_FIFO_RECORD_SIZE;
+}
+
+static uint16_t record_seq(const uint8_t *rec) {
+	return rec[RECORD_SEQ] | (rec[RECORD_SEQ + 1] << 8);
+}
+
+/**
+ * @brief Reads the record, returns false if there's no valid record in the slot
+ */
+static bool read_record(int i, uint8_t *rec) {
+	if (eeprom_read(record_addr(i), rec, APPDATA_FIFO_RECORD_SIZE) != APPDATA_FIFO_RECORD_SIZE) {
+		return false;
+	}
+
+	if ((rec[RECORD_STATE] != RECORD_STATE_PENDING) && (rec[RECORD_STATE] != RECORD_STATE_COMMITTED)) {
+		return false;
+	}
+
+	/* Record may be partially written if the power was lost */
+	uint16_t crc = rec[RECORD_CRC] | (rec[RECORD_CRC + 1] << 8);
+	return fletcher16(rec, RECORD_CRC) == crc;
+}
+
+static void commit_record(int i) {
+	eeprom_write_byte(record_addr(i) + RECORD_STATE, RECORD_STATE_COMMITTED);
+}
+
+/**
+ * @brief Returns the number of records fitting into the EEPROM of the part
+ */
+static uint8_t ring_size(void) {
+#ifdef MODULE_CORTEXM_COMMON
+	/* EEPROM size of the STM32 parts is known only at run time */
+	size_t eeprom_size = cpu_status.eeprom.size;
+
+	if (eeprom_size < APPDATA_FIFO_EEPROM_ADDR + APPDATA_FIFO_SIZE * APPDATA_FIFO_RECORD_SIZE) {
+		size_t size = (eeprom_size > APPDATA_FIFO_EEPROM_ADDR) ?
+					  (eeprom_size - APPDATA_FIFO_EEPROM_ADDR) / APPDATA_FIFO_RECORD_SIZE : 0;
+
+		printf("[appdata] EEPROM fits %u of %u entries\n", (unsigned) size, APPDATA_FIFO_SIZE);
+		assert(size > 0);
+		return size;
+	}
+#endif
+
+	return APPDATA_FIFO_SIZE;
+}
+
+/**
+ * @brief Restores the queue from the records in EEPROM
+ */
+static void load(appdata_fifo_t *fifo) {
+	fifo->seq = 0;
+	fifo->front = 0;
+	fifo->count = 0;
+
+	uint8_t rec[APPDATA_FIFO_RECORD_SIZE];
+
+	/* Find the most recent record */
+	int last = -1;
+	uint16_t last_seq = 0;
+	for (int i = 0; i < fifo->size; i++) {
+		if (!read_record(i, rec)) {
+			continue;
+		}
+
+		uint16_t seq = record_seq(rec);
+		if ((last < 0) || ((int16_t)(seq - last_seq) > 0)) {
+			last = i;
+			last_seq = seq;
+		}
+	}
+
+	if (last < 0) {
+		return;
+	}
+
+	fifo->seq = last_seq + 1;
+
+	/* Pending records are the contiguous run ending with the most recent one */
+	int i = last;
+	uint16_t expected = last_seq;
+	while ((fifo->count < fifo->size) && read_record(i, rec) &&
+		   (rec[RECORD_STATE] == RECORD_STATE_PENDING) && (record_seq(rec) == expected)) {
+		fifo->count++;
+		expected--;
+		i = (i + fifo->size - 1) % fifo->size;
+	}
+
+	/* Next record is written right after the most recent one */
+	fifo->front = (last + 1 + fifo->size - fifo->count) % fifo->size;
+
+	DEBUG("[appdata] %d pending entries restored\n", fifo->count);
+}
 
 void appdata_fifo_init(appdata_fifo_t *fifo) {
-	mutex_init(&fifo->mutex);
+	mutex_pi_init(&fifo->mutex);
+	fifo->size = ring_size();
+
+	load(fifo);
+}
+
+static bool read_front(appdata_fifo_t *fifo, appdata_fifo_entry_t *e) {
+	uint8_t rec[APPDATA_FIFO_RECORD_SIZE];
+
+	if (!read_record(fifo->front, rec)) {
+		return false;
+	}
+
+	memset(e, 0, sizeof(appdata_fifo_entry_t));
+	e->size = rec[RECORD_SIZE];
+	if (e->size > APPDATA_FIFO_MAX_APPDATA_SIZE) {
+		e->size = APPDATA_FIFO_MAX_APPDATA_SIZE;
+	}
+	memcpy(e->data, &rec[RECORD_DATA], e->size);
+	e->id = rec[RECORD_ID];
+
+	e->is_confirmed = (rec[RECORD_FLAGS] & RECORD_FLAG_CONFIRMED) != 0;
+	e->is_with_ack = (rec[RECORD_FLAGS] & RECORD_FLAG_WITH_ACK) != 0;
+
+	return true;
+}
+
+bool appdata_fifo_pop(appdata_fifo_t *fifo, appdata_fifo_entry_t *e) {
+	mutex_pi_lock(&fifo->mutex);
+
+	if (fifo->count == 0) {
+		mutex_pi_unlock(&fifo->mutex);
+		return false;
+	}
+
+	bool res = true;
+	if (e != NULL) {
+		res = read_front(fifo, e);
+	}
+
+	/* Entry is delivered, it won't be restored after reset */
+	commit_record(fifo->front);
+
+	fifo->front = (fifo->front + 1) % fifo->size;
+	fifo->count--;
+
+	mutex_pi_unlock(&fifo->mutex);
+	return res;
+}
+
+bool appdata_fifo_peek(appdata_fifo_t *fifo, appdata_fifo_entry_t *e) {
+	mutex_pi_lock(&fifo->mutex);
+
+	bool res = (fifo->count != 0) && read_front(fifo, e);
+
+	mutex_pi_unlock(&fifo->mutex);
+	return res;
+}
+
+bool appdata_fifo_pop_next(appdata_fifo_t *fifo) {
+	mutex_pi_lock(&fifo->mutex);
+
+	if (fifo->count < 2) {
+		mutex_pi_unlock(&fifo->mutex);
+		return false;
+	}
+
+	/* Front record takes the place and the sequence number of the next one,
+	 * so the pending records stay contiguous. Old front is committed after
+	 * the copy is written, power loss in between restores it twice */
+	uint8_t rec[APPDATA_FIFO_RECORD_SIZE];
+	uint8_t next[APPDATA_FIFO_RECORD_SIZE];
+	int i = (fifo->front + 1) % fifo->size;
+
+	if (!read_record(fifo->front, rec) || !read_record(i, next)) {
+		/* Damaged record, the queue is taken from what is left in EEPROM
+		 * rather than dropping an entry nobody has acknowledged */
+		puts("[appdata] damaged record, queue restored from EEPROM");
+		load(fifo);
+
+		mutex_pi_unlock(&fifo->mutex);
+		return false;
+	}
+
+	rec[RECORD_SEQ] = next[RECORD_SEQ];
+	rec[RECORD_SEQ + 1] = next[RECORD_SEQ + 1];
+
+	uint16_t crc = fletcher16(rec, RECORD_CRC);
+	rec[RECORD_CRC] = crc & 0xFF;
+	rec[RECORD_CRC + 1] = crc >> 8;
+	rec[RECORD_STATE] = RECORD_STATE_PENDING;
+
+	if (eeprom_write(record_addr(i), rec, sizeof(rec)) != sizeof(rec)) {
+		mutex_pi_unlock(&fifo->mutex);
+		return false;
+	}
+
+	commit_record(fifo->front);
+
+	fifo->front = i;
+	fifo->count--;
+
+	mutex_pi_unlock(&fifo->mutex);
+	return true;
+}
+
+bool appdata_fifo_push(appdata_fifo_t *fifo, uint8_t *buf, size_t bufsize, uint8_t id, bool is_confirmed, bool is_with_ack) {
+	if (bufsize > APPDATA_FIFO_MAX_APPDATA_SIZE) {
+		return false;
+	}
+
+	mutex_pi_lock(&fifo->mutex);
+
+	if (fifo->count == fifo->size) {
+		mutex_pi_unlock(&fifo->mutex);
+		return false;
+	}
+
+	uint8_t rec[APPDATA_FIFO_RECORD_SIZE];
+	memset(rec, 0, sizeof(rec));
+
+	rec[RECORD_SEQ] = fifo->seq & 0xFF;
+	rec[RECORD_SEQ + 1] = fifo->seq >> 8;
+	rec[RECORD_SIZE] = bufsize;
+	rec[RECORD_FLAGS] = (is_confirmed ? RECORD_FLAG_CONFIRMED : 0) | (is_with_ack ? RECORD_FLAG_WITH_ACK : 0);
+	rec[RECORD_ID] = id;
+	memcpy(&rec[RECORD_DATA], buf, bufsize);
+
+	uint16_t crc = fletcher16(rec, RECORD_CRC);
+	rec[RECORD_CRC] = crc & 0xFF;
+	rec[RECORD_CRC + 1] = crc >> 8;
+	rec[RECORD_STATE] = RECORD_STATE_PENDING;
+
+	int i = (fifo->front + fifo->count) % fifo->size;
+	if (eeprom_write(record_addr(i), rec, sizeof(rec)) != sizeof(rec)) {
+		mutex_pi_unlock(&fifo->mutex);
+		return false;
+	}
+
+	fifo->seq++;
+	fifo->count++;
+
+	mutex_pi_unlock(&fifo->mutex);
+	return true;
+}
+
+bool appdata_fifo_full(appdata_fifo_t *fifo) {
+	return fifo->count == fifo->size;
+}
+
+bool appdata_fifo_empty(appdata_fifo_t *fifo) {
+	return fifo->count == 0;
+}
+
+int appdata_fifo_size(appdata_fifo_t *fifo) {
+	return fifo->count;
+}
+
+void appdata_fifo_clear(appdata_fifo_t *fifo) {
+	mutex_pi_lock(&fifo->mutex);
+
+	while (fifo->count) {
+		commit_record(fifo->front);
+		fifo->front = (fifo->front + 1) % fifo->size;
+		fifo->count--;
+	}
+
+	mutex_pi_unlock(&fifo->mutex);
+}
+
+#else
+
+
+void appdata_fifo_init(appdata_fifo_t *fifo) {
+	mutex_pi_init(&fifo->mutex);
 	fifo->front = fifo->start = -1;
 }
 
@@ -53,7 +357,7 @@ bool appdata_fifo_pop(appdata_fifo_t *fifo, appdata_fifo_entry_t *e) {
 		return false;
 	}
 
-	mutex_lock(&fifo->mutex);
+	mutex_pi_lock(&fifo->mutex);
 
 	if (e != NULL) {
 		*e = fifo->fifo[fifo->front];
@@ -62,12 +366,12 @@ bool appdata_fifo_pop(appdata_fifo_t *fifo, appdata_fifo_entry_t *e) {
 	if (fifo->front == fifo->start) {
 		fifo->front = fifo->start = -1;
 
-		mutex_unlock(&fifo->mutex);
+		mutex_pi_unlock(&fifo->mutex);
 		return true;
 	}
 	fifo->front = (fifo->front + 1) % APPDATA_FIFO_SIZE;
 
-	mutex_unlock(&fifo->mutex);
+	mutex_pi_unlock(&fifo->mutex);
 	return true;
 }
 
@@ -76,10 +380,26 @@ bool appdata_fifo_peek(appdata_fifo_t *fifo, appdata_fifo_entry_t *e) {
 		return false;
 	}
 
-	mutex_lock(&fifo->mutex);
+	mutex_pi_lock(&fifo->mutex);
 	*e = fifo->fifo[fifo->front];
-	mutex_unlock(&fifo->mutex);
+	mutex_pi_unlock(&fifo->mutex);
+
+	return true;
+}
+
+bool appdata_fifo_pop_next(appdata_fifo_t *fifo) {
+	if (appdata_fifo_empty(fifo) || (fifo->front == fifo->start)) {
+		return false;
+	}
+
+	mutex_pi_lock(&fifo->mutex);
+
+	/* Front entry takes the place of the next one */
+	int next = (fifo->front + 1) % APPDATA_FIFO_SIZE;
+	fifo->fifo[next] = fifo->fifo[fifo->front];
+	fifo->front = next;
 
+	mutex_pi_unlock(&fifo->mutex);
 	return true;
 }
 
@@ -139,6 +459,7 @@ void appdata_fifo_clear(appdata_fifo_t *fifo) {
 	irq_restore(c);
 }
 
+#endif /* APPDATA_FIFO_PERSISTENT */
 
 #ifdef __cplusplus
 }
@@ -32,17 +32,43 @@
 #define APPDATA_FIFO_H_
 
 #include <stdint.h>
-#include "mutex.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include "mutex_pi.h"
 
 /**
  * @brief Maximum application data payload size in bytes.
  */
 #define APPDATA_FIFO_MAX_APPDATA_SIZE 32
 
+#ifdef APPDATA_FIFO_PERSISTENT
+/**
+ * @brief EEPROM address of the persistent FIFO, must not overlap the modules' settings.
+ */
+#ifndef APPDATA_FIFO_EEPROM_ADDR
+#define APPDATA_FIFO_EEPROM_ADDR 4096
+#endif
+
+/**
+ * @brief Maximum number of entries to store in FIFO.
+ *
+ * Each entry takes APPDATA_FIFO_RECORD_SIZE bytes of EEPROM and no RAM.
+ * Parts with less EEPROM keep as many entries as fit past APPDATA_FIFO_EEPROM_ADDR.
+ */
+#ifndef APPDATA_FIFO_SIZE
+#define APPDATA_FIFO_SIZE 48
+#endif
+
+/**
+ * @brief Size of the EEPROM record: sequence number, size, flags, ID, data, checksum and state.
+ */
+#define APPDATA_FIFO_RECORD_SIZE (2 + 1 + 1 + 1 + APPDATA_FIFO_MAX_APPDATA_SIZE + 2 + 1)
+#else
 /**
  * @brief Maximum number of entries to store in FIFO.
  */
 #define APPDATA_FIFO_SIZE 2
+#endif
 
 typedef struct {
 	uint8_t data[APPDATA_FIFO_MAX_APPDATA_SIZE];	/**< Application data */
@@ -53,6 +79,23 @@ typedef struct {
 	bool is_with_ack;								/**< Implicit ACK to the app. data previously received */
 } appdata_fifo_entry_t;
 
+#ifdef APPDATA_FIFO_PERSISTENT
+/**
+ * @brief describes the frame queue kept in EEPROM.
+ *
+ * Entries are appended to the ring of EEPROM records and marked as committed
+ * when popped, so the pending entries survive reset. Records are written in turn
+ * to spread the wear over the whole ring.
+ */
+typedef struct {
+	uint16_t seq;	/**< Sequence number of the next record */
+	uint8_t front;	/**< Record at the queue's front */
+	uint8_t count;	/**< Number of pending records */
+	uint8_t size;	/**< Number of records fitting into the EEPROM */
+
+	mutex_pi_t mutex; /**< FIFO's mutex, held by the low priority publishers too */
+} appdata_fifo_t;
+#else
 /**
  * @brief describes the frame queue.
  */
@@ -62,8 +105,9 @@ typedef struct {
 	int front;	/**< Pointer to the queue's front */
 	int start;	/**< Pointer to the queue's start */
 
-	mutex_t mutex; /**< FIFO's mutex */
+	mutex_pi_t mutex; /**< FIFO's mutex, held by the low priority publishers too */
 } appdata_fifo_t;
+#endif
 
 void appdata_fifo_init(appdata_fifo_t *fifo);
 
@@ -71,6 +115,11 @@ bool appdata_fifo_pop(appdata_fifo_t *fifo, appdata_fifo_entry_t *e);
 
 bool appdata_fifo_peek(appdata_fifo_t *fifo, appdata_fifo_entry_t *e);
 
+/**
+ * @brief Removes the oldest entry behind the front one, the front entry is kept.
+ */
+bool appdata_fifo_pop_next(appdata_fifo_t *fifo);
+
 bool appdata_fifo_push(appdata_fifo_t *fifo, uint8_t *buf, size_t bufsize, uint8_t id, bool is_confirmed, bool is_with_ack);
 
 bool appdata_fifo_full(appdata_fifo_t *fifo);
@@ -78,6 +78,45 @@
  */
 #define LS_ED_SLEEP_REQUEST_DELAY 1
 
+/**
+ * @brief Initial contention window of the channel access [ms], doubles every time the channel is busy.
+ */
+#define LS_ED_LBT_BACKOFF_MS 50
+
+/**
+ * @brief Join request waits a random delay of half to the full window before the channel access [ms].
+ *
+ * Nodes invited or powered on at once then don't collide with their join requests.
+ */
+#ifndef LS_ED_JOIN_JITTER_MS
+#define LS_ED_JOIN_JITTER_MS 8000
+#endif
+
+/**
+ * @brief Maximum contention window for the application data [ms].
+ */
+#define LS_ED_LBT_MAX_BACKOFF_MS 3000
+
+/**
+ * @brief Maximum contention window for the acknowledges [ms].
+ */
+#define LS_ED_LBT_ACK_MAX_BACKOFF_MS 500
+
+/**
+ * @brief Number of consecutive CADs without activity for the channel to be considered free.
+ */
+#define LS_ED_LBT_FREE_CADS 2
+
+/**
+ * @brief Frame is sent anyway after the channel was found busy that many times.
+ */
+#define LS_ED_LBT_MAX_BUSY 6
+
+/**
+ * @brief Number of uplinks without any downlink after which the ADR settings are dropped.
+ */
+#define LS_ED_ADR_ACK_LIMIT 32
+
 // TODO: optimize these values to reduce memory consumption
 #if defined (UNWDS_BUILD_MINIMAL)
     #define LS_UQ_HANDLER_STACKSIZE			(1536)
@@ -98,6 +137,17 @@ typedef enum {
 	LS_ED_APPDATA_ACK_EXPIRED,
 } ls_ed_tim_cmd_t;
 
+/**
+ * @brief Uplink queue handler messages.
+ */
+typedef enum {
+	LS_ED_UQ_SEND = 0,		/**< Send next frame from the queue */
+	LS_ED_UQ_LBT_CAD,		/**< Backoff is over, start channel activity detection */
+	LS_ED_UQ_LBT_FREE,		/**< No channel activity detected */
+	LS_ED_UQ_LBT_BUSY,		/**< Channel activity detected */
+	LS_ED_UQ_LBT_TIMEOUT,	/**< No CAD result from the transceiver */
+} ls_ed_uq_cmd_t;
+
 /**
  * @brief LoRa-Star stack status.
  */
@@ -152,6 +202,7 @@ typedef struct {
 	ls_channel_t channel;						/**< Channel for the end-device */
 	ls_node_class_t class;						/**< Device class */
 	uint8_t max_retr;							/**< Maximum number of retransmissions */
+	bool adr;									/**< Follow data rate and TX power commands of the gate */
 	bool no_join;								/**< Statically personalized device, no join required */
     bool auto_shutdown;
     bool confirmation;
@@ -211,8 +262,17 @@ typedef struct {
 	mutex_t curr_frame_mutex; /**< Mutex on current frame */
 
 	int16_t last_rssi;		  /**< RSSI value of the last frame received */
+
+	uint8_t adr_cmd;          /**< ADR command in use, 0 for the data rate and TX power from the settings */
+	uint8_t adr_ack_cnt;      /**< Number of uplinks since the last downlink */
     
-    bool last_cad_success;     /**< last Channel Activity Detection result */
+    /* Listen Before Talk */
+    rtctimers_millis_t lbt_timer;   /**< Backoff and CAD timeout timer */
+    msg_t lbt_msg;                  /**< Message sent to the uplink queue handler by the timer */
+    bool lbt_active;                /**< Channel access for the next frame is in progress */
+    bool lbt_cad_running;           /**< Waiting for the CAD result */
+    uint8_t lbt_free;               /**< Number of consecutive CADs without activity */
+    uint8_t lbt_busy;               /**< Number of times the channel was found busy */
     
 	uint8_t num_reopened;		/**< Number of RX window reopening */
 
@@ -221,6 +281,7 @@ typedef struct {
 	 * messages to preserve them from losing if network key is changed and encrypted frames are invalid.
 	 */
 	appdata_fifo_t appdata_fifo; /**< Application data FIFO */
+	bool appdata_pending;        /**< Oldest FIFO entry is sent and waits for the ACK */
 } ls_ed_internal_t;
 
 /**
@@ -39,8 +39,6 @@ extern "C" {
 #include "thread.h"
 #include "mutex.h"
 
-#include "periph/adc.h"
-
 #include "ls-init-device.h"
 #include "ls-mac-types.h"
 #include "ls-mac.h"
@@ -63,26 +61,27 @@ static msg_t msg_rx2;
 static msg_t msg_join_timeout;
 static msg_t msg_ack_timeout;
 
+static inline ls_datarate_t current_dr(ls_ed_t *ls)
+{
+    return (ls->_internal.adr_cmd) ? LS_ADR_CMD_DR(ls->_internal.adr_cmd) : ls->settings.dr;
+}
+
 static void configure_sx127x(ls_ed_t *ls)
 {
-    ls_datarate_t dr = (!ls->_internal.use_rx_window_2_settings) ? ls->settings.dr : LS_RX2_DR;
+    ls_datarate_t dr = (!ls->_internal.use_rx_window_2_settings) ? current_dr(ls) : LS_RX2_DR;
     ls_channel_t ch = (!ls->_internal.use_rx_window_2_settings) ? ls->settings.channel : LS_RX2_CH;
     
     ls_setup_sx127x(ls->_internal.device, dr, ls->settings.channels_table[ch]);
+
+    /* TX power lowered by the gate */
+    if (ls->_internal.adr_cmd) {
+        int16_t power = TX_OUTPUT_POWER - LS_ADR_POWER_STEP_DB * LS_ADR_CMD_POWER(ls->_internal.adr_cmd);
+        ls->_internal.device->driver->set(ls->_internal.device, NETOPT_TX_POWER, &power, sizeof(int16_t));
+    }
     
     DEBUG("[LoRa] SX127X configured\n");
 }
 
-static void anticollision_delay(void) {
-	/* Pseudorandom delay up to 8 seconds for collision avoidance */
-	unsigned int delay = random_uint32_range(1000, 8000);
-
-	DEBUG("[LoRa] random delay %d ms\n", (unsigned int) (delay));
-	rtctimers_millis_sleep(delay);
-
-	DEBUG("[LoRa] delay end\n");
-}
-
 static void enter_rx(ls_ed_t *ls)
 {
     assert(ls != NULL);
@@ -106,8 +105,7 @@ static void enter_rx(ls_ed_t *ls)
 static inline void schedule_tx(ls_ed_t *ls)
 {
     msg_t msg;
-    msg_t msg_queue[4];
-    msg_init_queue(msg_queue, 4);
+    msg.type = LS_ED_UQ_SEND;
     
     /* Send message to the frame queue thread to initiate frame transmission */
     DEBUG("[LoRa] sending message to uplink queue\n");
@@ -132,7 +130,6 @@ static void open_rx_windows(ls_ed_t *ls)
 }
 
 static void send_next(ls_ed_t *ls) {
-    anticollision_delay();
 	ls->_internal.confirmation_required = false;
     
     DEBUG("[LoRa] sending frame\n");
@@ -148,34 +145,20 @@ static void send_next(ls_ed_t *ls) {
     }
 }
 
-static uint8_t get_node_status(void)
+/**
+ * @brief Reports the data rate and TX power the node uses, so the gate knows if its ADR command is taken.
+ */
+static uint8_t adr_status(ls_ed_t *ls)
 {
-    DEBUG("[LoRa] battery and voltage\n");
-    
-    return 0;
-    
-    if (adc_init(ADC_LINE(ADC_VREF_INDEX)) < 0) {
-        DEBUG("[LoRa] ADC init error\n");
+    if (!ls->settings.adr) {
         return 0;
     }
-    
-    DEBUG("[LoRa] ADC initialized\n");
-    
-    uint16_t vdd;
-    /* 2000 mV min voltage */
-    /* 50 mV per bit resolution */
-    vdd = (adc_sample(ADC_LINE(ADC_VREF_INDEX), ADC_RES_12BIT) - 2000)/50;
-    
-    if (adc_init(ADC_LINE(ADC_TEMPERATURE_INDEX)) < 0) {
-        return ((uint8_t)vdd & 0x1F);
+
+    if (ls->_internal.adr_cmd) {
+        return ls->_internal.adr_cmd;
     }
-    int temp;
-    temp = adc_sample(ADC_LINE(ADC_TEMPERATURE_INDEX), ADC_RES_12BIT);
-    temp = 40 + ((temp + 105) / 200); /* -40 is the minimim, 20 deg C per bit */
-    
-    DEBUG("[LoRa] V = %d, T = %d\n", vdd, temp);
-    
-    return (uint8_t)((vdd & 0x1F) | ((temp & 0x7) << 5));
+
+    return LS_ADR_CMD(ls->settings.dr, 0);
 }
 
 static int send_frame(ls_ed_t *ls, ls_type_t type, uint8_t *buf, size_t buflen)
@@ -189,7 +172,7 @@ static int send_frame(ls_ed_t *ls, ls_type_t type, uint8_t *buf, size_t buflen)
     ls_assemble_frame(ls->_internal.dev_addr, type, buf, buflen, frame);
 
     frame->header.fid = ls->_internal.last_fid;
-    frame->header.status = get_node_status();
+    frame->header.status = adr_status(ls);
 
     /* Enqueue frame */
     if (ls_frame_fifo_full(&ls->_internal.uplink_queue)) {
@@ -259,6 +242,95 @@ static bool ack_recv(ls_ed_t *ls, ls_frame_t  *frame) {
 	return close_rx_window;
 }
 
+/**
+ * @brief Sends the oldest entries of the app. data FIFO.
+ *
+ * Unconfirmed entries are removed as they are queued, confirmed entry is kept
+ * in the FIFO until the gate acknowledges it, so only one of them is in flight.
+ */
+static int send_backlog(ls_ed_t *ls) {
+    appdata_fifo_t *fifo = &ls->_internal.appdata_fifo;
+    appdata_fifo_entry_t e;
+    int res = LS_OK;
+
+    if (ls->_internal.appdata_pending) {
+        DEBUG("[LoRa] waiting for the FIFO entry to be acknowledged\n");
+        return LS_OK;
+    }
+
+    while (!appdata_fifo_empty(fifo) && !ls_frame_fifo_full(&ls->_internal.uplink_queue)) {
+        if (!appdata_fifo_peek(fifo, &e)) {
+            DEBUG("[LoRa] remove damaged FIFO entry\n");
+            appdata_fifo_pop(fifo, NULL);
+            continue;
+        }
+
+        DEBUG("[LoRa] sending delayed app. data [fid: %d, size: %d]\n", e.id, e.size);
+
+        if (e.is_confirmed) {
+            ls->_internal.appdata_pending = true;
+            res = ls_ed_send_app_data(ls, e.data, e.size, true, e.is_with_ack, true);
+            if (res < 0) {
+                /* Nothing is in flight, entry is sent again with the next backlog */
+                ls->_internal.appdata_pending = false;
+            }
+            return res;
+        }
+
+        appdata_fifo_pop(fifo, NULL);
+        res = ls_ed_send_app_data(ls, e.data, e.size, false, e.is_with_ack, true);
+    }
+
+    return res;
+}
+
+static void appdata_acked(ls_ed_t *ls) {
+    /* Remove app data we've got ACK for from FIFO */
+    if (ls->_internal.appdata_pending) {
+        DEBUG("[LoRa] remove FIFO entry\n");
+        appdata_fifo_pop(&ls->_internal.appdata_fifo, NULL);
+        ls->_internal.appdata_pending = false;
+    }
+
+    send_backlog(ls);
+}
+
+/**
+ * @brief Applies the ADR command from the status byte of the downlink frame.
+ */
+static void adr_recv(ls_ed_t *ls, uint8_t status) {
+    /* Gate hears us */
+    ls->_internal.adr_ack_cnt = 0;
+
+    if (!ls->settings.adr || !(status & LS_ADR_CMD_FLAG)) {
+        return;
+    }
+
+    if (LS_ADR_CMD_DR(status) > LS_DR6 || LS_ADR_CMD_POWER(status) > LS_ADR_POWER_MAX_STEP) {
+        DEBUG("[LoRa] invalid ADR command 0x%02X\n", status);
+        return;
+    }
+
+    ls->_internal.adr_cmd = status;
+    printf("[LoRa] ADR: DR%d, TX power %d dBm\n", LS_ADR_CMD_DR(status),
+           TX_OUTPUT_POWER - LS_ADR_POWER_STEP_DB * LS_ADR_CMD_POWER(status));
+}
+
+/**
+ * @brief Counts uplinks, falls back to the settings if the gate doesn't hear us any more.
+ */
+static void adr_uplink(ls_ed_t *ls) {
+    if (!ls->_internal.adr_cmd) {
+        return;
+    }
+
+    if (++ls->_internal.adr_ack_cnt >= LS_ED_ADR_ACK_LIMIT) {
+        puts("[LoRa] ADR: no downlinks, back to the default data rate and TX power");
+        ls->_internal.adr_cmd = 0;
+        ls->_internal.adr_ack_cnt = 0;
+    }
+}
+
 static void data_recv(ls_ed_t *ls, ls_frame_t *frame) {
     if (frame->header.dev_addr != ls->_internal.dev_addr) {
         DEBUG("[LoRa] address mismatch\n");
@@ -331,6 +403,8 @@ static bool frame_recv(ls_ed_t *ls, ls_frame_t *frame)
             DEBUG("[LoRa] invalid MIC\n");
             return false;
         }
+
+        adr_recv(ls, frame->header.status);
     } else {
         if (!ls_validate_frame_mic(ls->settings.crypto.join_key, frame)) {
             DEBUG("[LoRa] invalid MIC\n");
@@ -358,39 +432,36 @@ static bool frame_recv(ls_ed_t *ls, ls_frame_t *frame)
             /* Must be joined to the network first */
             DEBUG("[LoRa] ack with data received\n");
 
-            /* Remove app data we've got ACK for from FIFO */
-            if (!appdata_fifo_empty(&ls->_internal.appdata_fifo)) {
-                DEBUG("[LoRa] remove FIFO entry\n");
-                appdata_fifo_pop(&ls->_internal.appdata_fifo, NULL);
-            }
-
             DEBUG("[LoRa] decrypting payload\n");
             ls_decrypt_frame_payload(ls->settings.crypto.aes_key, frame);
 
             bool close_rx_window = ack_recv(ls, frame);
             data_recv(ls, frame);
 
+            appdata_acked(ls);
+
             return close_rx_window;
 
     		break;
 
-        case LS_DL_ACK:                             /* Downlink frame acknowledge for confirmed messages */
+        case LS_DL_ACK: {                           /* Downlink frame acknowledge for confirmed messages */
             DEBUG("[LoRa] ack received\n");
 
-            /* Remove app data we've got ACK for from FIFO */
-            if (!appdata_fifo_empty(&ls->_internal.appdata_fifo)) {
-                DEBUG("[LoRa] remove FIFO entry\n");
-                appdata_fifo_pop(&ls->_internal.appdata_fifo, NULL);
-            }
+            bool close_rx_window = ack_recv(ls, frame);
+            appdata_acked(ls);
 
-            return ack_recv(ls, frame);
+            return close_rx_window;
+        }
 
         case LS_DL:         /* Downlink frame */
             DEBUG("[LoRa] donwlink frame received\n");
             DEBUG("[LoRa] decrypting payload\n");
             ls_decrypt_frame_payload(ls->settings.crypto.aes_key, frame);
 
-            data_recv(ls, frame);
+            /* Empty frame carries the ADR command only */
+            if (frame->payload.len > 0) {
+                data_recv(ls, frame);
+            }
             return true;
 
         case LS_DL_JOIN_ACK: { /* Downlink join acknowledge */
@@ -431,6 +502,10 @@ static bool frame_recv(ls_ed_t *ls, ls_frame_t *frame)
             /* Make device joined */
             ls->_internal.is_joined = true;
 
+            /* Gate starts the new session with our own data rate and TX power */
+            ls->_internal.adr_cmd = 0;
+            ls->_internal.adr_ack_cnt = 0;
+
             /* Notify application code via callback */
             DEBUG("[LoRa] notify application\n");
             if (ls->joined_cb != NULL) {
@@ -438,20 +513,9 @@ static bool frame_recv(ls_ed_t *ls, ls_frame_t *frame)
             }
 
             /* Check for queued data to send after join */
-            appdata_fifo_t *fifo = &ls->_internal.appdata_fifo;
             DEBUG("[LoRa] checking FIFO after join\n");
-
-    		while(!appdata_fifo_empty(fifo)) {
-    			appdata_fifo_entry_t e;
-
-    			if (!appdata_fifo_pop(fifo, &e)) {
-    				break;
-    			}
-
-    			DEBUG("[LoRa] sending delayed app. data [fid: %d, size: %d]\n", e.id, e.size);
-
-    			ls_ed_send_app_data(ls, e.data, e.size, e.is_confirmed, e.is_with_ack, true);
-    		}
+            ls->_internal.appdata_pending = false;
+            send_backlog(ls);
             
             DEBUG("[LoRa] done\n");
 
@@ -493,8 +557,6 @@ static bool frame_recv(ls_ed_t *ls, ls_frame_t *frame)
             DEBUG("[LoRa] remove join timeout timer\n");
             rtctimers_millis_remove(&ls->_internal.join_req_expired);
 
-			anticollision_delay();
-
             /* Proceed to join procedure as requested */
             DEBUG("[LoRa] join\n");
             ls_ed_join(ls);
@@ -626,16 +688,16 @@ static void sx127x_handler(netdev_t *dev, netdev_event_t event, void *arg)
             break;
             
         case NETDEV_EVENT_CAD_DONE:
-            DEBUG("[LoRa] CAD done\n");
-            ls->_internal.last_cad_success = false;
-            ls_ed_sleep(ls);
-            break;
-            
-        case NETDEV_EVENT_CAD_DETECTED:
-            DEBUG("[LoRa] CAD detected\n");
-            ls->_internal.last_cad_success = true;
+        case NETDEV_EVENT_CAD_DETECTED: {
+            DEBUG("[LoRa] CAD %s\n", (event == NETDEV_EVENT_CAD_DETECTED) ? "detected" : "done");
             ls_ed_sleep(ls);
+
+            /* Pass the result to the channel access procedure */
+            msg_t msg;
+            msg.type = (event == NETDEV_EVENT_CAD_DETECTED) ? LS_ED_UQ_LBT_BUSY : LS_ED_UQ_LBT_FREE;
+            msg_try_send(&msg, ls->_internal.uq_thread_pid);
             break;
+        }
             
         case NETDEV_EVENT_VALID_HEADER:
             puts("[LoRa] header received, switch to RX state");
@@ -700,8 +762,195 @@ static void get_type_str(ls_type_t type, char *str) {
 }
 #endif
 
+/**
+ * @brief Sends the frame from the uplink queue head, channel access is done.
+ */
+static void transmit_next(ls_ed_t *ls)
+{
+    ls->_internal.lbt_active = false;
+
+    if (ls_frame_fifo_empty(&ls->_internal.uplink_queue)) {
+        ls->state = LS_ED_IDLE;
+        DEBUG("[LoRa] FIFO is empty\n");
+        return;
+    }
+
+    /* Get frame from queue top */
+    ls_frame_t *f;
+    ls_frame_t frame;
+    if (!ls_frame_fifo_peek(&ls->_internal.uplink_queue, &frame)) {
+        DEBUG("[LoRa] error getting frame from FIFO\n");
+        return;
+    }
+
+    f = &frame;
+
+    ls->_internal.confirmation_required = (f->header.type == LS_UL_CONF);
+
+    /* Current frame is not confirmed app. data */
+    if (!ls->_internal.confirmation_required) {
+    	/* Remove frame from queue */
+    	ls_frame_fifo_pop(&ls->_internal.uplink_queue, NULL);
+
+    	/* Update frame's FID to the last one and advance it */
+    	f->header.fid = ls->_internal.last_fid++;
+    } else {
+        /* Update frame's FID to the last one */
+        f->header.fid = ls->_internal.last_fid;
+
+        /* Start retransmission timer */
+        rtctimers_millis_set_msg(&ls->_internal.conf_ack_expired, 1000*LS_ACK_TIMEOUT, &msg_ack_timeout, ls->_internal.tim_thread_pid);
+    }
+
+    ls->state = LS_ED_TRANSMITTING;
+
+    if (f->header.type != LS_UL_JOIN_REQ) {
+        adr_uplink(ls);
+    }
+
+    DEBUG("[LoRa] reconfigure transceiver\n");
+    /* Configure to sleep */
+    uint8_t state = NETOPT_STATE_SLEEP;
+    ls->_internal.device->driver->set(ls->_internal.device, NETOPT_STATE, &state, sizeof(uint8_t));
+
+    size_t header_size = sizeof(ls_header_t) + sizeof(ls_payload_len_t);
+    size_t payload_size = 0;
+
+    /* Apply cryptography procedures */
+    if (f->header.type != LS_UL_JOIN_REQ) {
+        DEBUG("[LoRa] encrypt regular frame\n");
+        ls_encrypt_frame(ls->settings.crypto.mic_key, ls->settings.crypto.aes_key, f, &payload_size);
+    }
+    else {
+        DEBUG("[LoRa] encrypt join request\n");
+        ls_encrypt_frame(ls->settings.crypto.join_key, ls->settings.crypto.join_key, f, &payload_size);
+    }
+    DEBUG("[LoRa] sending data to transceiver\n");
+
+#if ENABLE_DEBUG
+    char type_str[10] = {};
+    get_type_str(f->header.type, type_str);
+    printf(">mhdr=0x%02X, mic=0x%04X, addr=0x%02X, <%s> fid=0x%02X (%d bytes) [%d left]\n", (unsigned int) f->header.mhdr,
+           (unsigned int) f->header.mic, (unsigned int) f->header.dev_addr,
+           type_str,
+           (unsigned int) f->header.fid, header_size + payload_size,
+		   ls_frame_fifo_size(&ls->_internal.uplink_queue));
+#endif
+    /* Configure for TX */
+    configure_sx127x(ls);
+    DEBUG("[LoRa] transceiver configured\n");
+    
+    /* Send frame into LoRa PHY */
+    iolist_t data = {
+        .iol_base = f,
+        .iol_len = header_size + payload_size,
+    };
+    
+    if (ls->_internal.device->driver->send(ls->_internal.device, &data) < 0) {
+        puts("[LoRa] cannot send, device busy");
+    }
+    
+    DEBUG("[LoRa] data sent\n");
+}
+
+/**
+ * @brief Sends the message to the uplink queue handler after the delay.
+ */
+static void lbt_set_timer(ls_ed_t *ls, ls_ed_uq_cmd_t cmd, uint32_t delay_ms)
+{
+    rtctimers_millis_remove(&ls->_internal.lbt_timer);
+
+    ls->_internal.lbt_msg.type = cmd;
+    rtctimers_millis_set_msg(&ls->_internal.lbt_timer, delay_ms, &ls->_internal.lbt_msg, ls->_internal.uq_thread_pid);
+}
+
+/**
+ * @brief Starts Channel Activity Detection, result is reported by the transceiver.
+ */
+static void lbt_start_cad(ls_ed_t *ls)
+{
+    /* Approximate CAD duration at the current datarate */
+    ls_datarate_t dr = current_dr(ls);
+    uint32_t cad_ms = 5 + ((100 + 10*dr) >> dr);
+
+    /* Configure to sleep */
+    uint8_t state = NETOPT_STATE_SLEEP;
+    ls->_internal.device->driver->set(ls->_internal.device, NETOPT_STATE, &state, sizeof(uint8_t));
+
+    configure_sx127x(ls);
+
+    ls->_internal.lbt_cad_running = true;
+
+    state = NETOPT_STATE_CAD;
+    ls->_internal.device->driver->set(ls->_internal.device, NETOPT_STATE, &state, sizeof(uint8_t));
+
+    /* Don't wait forever if the CAD interrupt is lost */
+    lbt_set_timer(ls, LS_ED_UQ_LBT_TIMEOUT, 4 * cad_ms);
+}
+
+/**
+ * @brief Channel is busy, retry after randomized exponential backoff.
+ *
+ * @return true if the frame should be sent right away
+ */
+static bool lbt_backoff(ls_ed_t *ls)
+{
+    ls->_internal.lbt_free = 0;
+
+    /* Send anyway if we tried too many times */
+    if (++ls->_internal.lbt_busy >= LS_ED_LBT_MAX_BUSY) {
+        puts("[LoRa] channel is busy, sending anyway");
+        return true;
+    }
+
+    /* Acknowledges must fit into the gate's receive window */
+    uint32_t max_window = LS_ED_LBT_MAX_BACKOFF_MS;
+    ls_frame_t frame;
+    if (ls_frame_fifo_peek(&ls->_internal.uplink_queue, &frame) &&
+        ((frame.header.type == LS_UL_ACK) || (frame.header.type == LS_UL_UNC_ACK))) {
+        max_window = LS_ED_LBT_ACK_MAX_BACKOFF_MS;
+    }
+
+    uint32_t window = LS_ED_LBT_BACKOFF_MS << ls->_internal.lbt_busy;
+    if (window > max_window) {
+        window = max_window;
+    }
+
+    uint32_t delay = random_uint32_range(window / 2, window);
+    DEBUG("[LoRa] channel activity detected, backoff %d ms\n", (int) delay);
+
+    lbt_set_timer(ls, LS_ED_UQ_LBT_CAD, delay);
+
+    return false;
+}
+
+/**
+ * @brief No activity detected by CAD.
+ *
+ * @return true if the frame should be sent right away
+ */
+static bool lbt_free(ls_ed_t *ls)
+{
+    if (++ls->_internal.lbt_free < LS_ED_LBT_FREE_CADS) {
+        lbt_start_cad(ls);
+        return false;
+    }
+
+    /* CAD only detects LoRa preambles, check for any other transmission too */
+    uint32_t freq = ls->settings.channels_table[ls->settings.channel];
+    if (!sx127x_is_channel_free((sx127x_t *) ls->_internal.device, freq, LS_CHANNEL_FREE_RSSI)) {
+        DEBUG("[LoRa] channel RSSI is above the threshold\n");
+        return lbt_backoff(ls);
+    }
+
+    return true;
+}
+
 /**
  * Uplink frame queue handler thread body.
+ *
+ * Channel access is done asynchronously: CAD results and the backoff timer
+ * are delivered to this thread as messages.
  */
 static void *uq_handler(void *arg)
 {
@@ -710,128 +959,80 @@ static void *uq_handler(void *arg)
     DEBUG("[LoRa] uplink frame queue handler thread started\n");
 
     ls_ed_t *ls = (ls_ed_t *) arg;
-    msg_init_queue(ls->_internal.uq_msg_queue, sizeof(ls->_internal.uq_msg_queue));
+    msg_init_queue(ls->_internal.uq_msg_queue, sizeof(ls->_internal.uq_msg_queue) / sizeof(msg_t));
     msg_t msg;
 
     while (1) {
         msg_receive(&msg);
         DEBUG("[LoRa] message received\n");
-        
-        if (ls_frame_fifo_empty(&ls->_internal.uplink_queue)) {
-            ls->state = LS_ED_IDLE;
-            DEBUG("[LoRa] FIFO is empty\n");
-            continue;
-        }
-
-        /* Get frame from queue top */
-        ls_frame_t *f;
-        ls_frame_t frame;
-        if (!ls_frame_fifo_peek(&ls->_internal.uplink_queue, &frame)) {
-            DEBUG("[LoRa] error getting frame from FIFO\n");
-            continue;
-        }
 
-        f = &frame;
-
-        ls->_internal.confirmation_required = (f->header.type == LS_UL_CONF);
+        switch (msg.type) {
+            case LS_ED_UQ_SEND:
+                /* Queued frames are sent one by one */
+                if (ls->_internal.lbt_active) {
+                    DEBUG("[LoRa] channel access in progress\n");
+                    break;
+                }
 
-        /* Current frame is not confirmed app. data */
-        if (!ls->_internal.confirmation_required) {
-        	/* Remove frame from queue */
-        	ls_frame_fifo_pop(&ls->_internal.uplink_queue, NULL);
+                if (ls_frame_fifo_empty(&ls->_internal.uplink_queue)) {
+                    ls->state = LS_ED_IDLE;
+                    DEBUG("[LoRa] FIFO is empty\n");
+                    break;
+                }
 
-        	/* Update frame's FID to the last one and advance it */
-        	f->header.fid = ls->_internal.last_fid++;
-        } else {
-            /* Update frame's FID to the last one */
-            f->header.fid = ls->_internal.last_fid;
+                ls->state = LS_ED_TRANSMITTING;
 
-            /* Start retransmission timer */
-            rtctimers_millis_set_msg(&ls->_internal.conf_ack_expired, 1000*LS_ACK_TIMEOUT, &msg_ack_timeout, ls->_internal.tim_thread_pid);
-        }
+                ls->_internal.lbt_active = true;
+                ls->_internal.lbt_cad_running = false;
+                ls->_internal.lbt_free = 0;
+                ls->_internal.lbt_busy = 0;
 
-        ls->state = LS_ED_TRANSMITTING;
+                /* Short random delay desynchronizes the nodes triggered by the same event */
+                uint32_t jitter = random_uint32_range(0, LS_ED_LBT_BACKOFF_MS);
 
-        DEBUG("[LoRa] reconfigure transceiver\n");
-        /* Configure to sleep */
-        uint8_t state = NETOPT_STATE_SLEEP;
-        ls->_internal.device->driver->set(ls->_internal.device, NETOPT_STATE, &state, sizeof(uint8_t));
+                /* Join requests of the nodes invited at once need a much wider window */
+                ls_frame_t frame;
+                if (ls_frame_fifo_peek(&ls->_internal.uplink_queue, &frame) &&
+                    (frame.header.type == LS_UL_JOIN_REQ)) {
+                    jitter = random_uint32_range(LS_ED_JOIN_JITTER_MS / 2, LS_ED_JOIN_JITTER_MS);
+                }
 
-        /* Configure SX127X to TX */
-        configure_sx127x(ls);
+                DEBUG("[LoRa] channel access in %d ms\n", (int) jitter);
+                lbt_set_timer(ls, LS_ED_UQ_LBT_CAD, jitter);
+                break;
 
-        size_t header_size = sizeof(ls_header_t) + sizeof(ls_payload_len_t);
-        size_t payload_size = 0;
+            case LS_ED_UQ_LBT_CAD:
+                if (ls->_internal.lbt_active) {
+                    lbt_start_cad(ls);
+                }
+                break;
 
-        /* Apply cryptography procedures */
-        if (f->header.type != LS_UL_JOIN_REQ) {
-            DEBUG("[LoRa] encrypt regular frame\n");
-            ls_encrypt_frame(ls->settings.crypto.mic_key, ls->settings.crypto.aes_key, f, &payload_size);
-        }
-        else {
-            DEBUG("[LoRa] encrypt join request\n");
-            ls_encrypt_frame(ls->settings.crypto.join_key, ls->settings.crypto.join_key, f, &payload_size);
-        }
-        /* Listen Before Talk with LoRa CAD support */
-        /* delays between CAD requests */
-        int delay_ms = 5 + ((100 + 10*ls->settings.dr) >> ls->settings.dr);
-        
-        DEBUG("[LoRa] checking channel activity every %d ms\n", delay_ms);
-        
-        int cad_tries = 0;
-        for (int k = 0; k < 10; k++) {
-            ls->_internal.last_cad_success = 0;
-
-            uint8_t state = NETOPT_STATE_CAD;
-            ls->_internal.device->driver->set(ls->_internal.device, NETOPT_STATE, &state, sizeof(uint8_t));
-
-            //xtimer_spin(xtimer_ticks_from_usec(delay_ms * 1000));
-            rtctimers_millis_sleep(delay_ms);
-            if (ls->_internal.last_cad_success) {
-                DEBUG("[LoRa] channel activity detected\n");
-                
-                /* send anyway if we tried too many times */
-                cad_tries++;
-                if (cad_tries > 5) {
+            case LS_ED_UQ_LBT_FREE:
+            case LS_ED_UQ_LBT_BUSY:
+            case LS_ED_UQ_LBT_TIMEOUT:
+                /* Ignore stale results */
+                if (!ls->_internal.lbt_active || !ls->_internal.lbt_cad_running) {
                     break;
                 }
-                
-                /* otherwise restart CAD after a pause */
-                if ((f->header.type == LS_UL_ACK) || (f->header.type == LS_UL_UNC_ACK)) {
-                    rtctimers_millis_sleep(500);
+
+                ls->_internal.lbt_cad_running = false;
+                rtctimers_millis_remove(&ls->_internal.lbt_timer);
+
+                bool send_now;
+                if (msg.type == LS_ED_UQ_LBT_BUSY) {
+                    send_now = lbt_backoff(ls);
                 } else {
-                    rtctimers_millis_sleep(3000);
+                    send_now = lbt_free(ls);
                 }
-                /* xtimer_spin(xtimer_ticks_from_usec(delay_ms * 1000 * 5)); */
-                k = 0;
-            }
-        }
-        DEBUG("[LoRa] sending data to transceiver\n");
 
-#if ENABLE_DEBUG
-        char type_str[10] = {};
-        get_type_str(f->header.type, type_str);
-        printf(">mhdr=0x%02X, mic=0x%04X, addr=0x%02X, <%s> fid=0x%02X (%d bytes) [%d left]\n", (unsigned int) f->header.mhdr,
-               (unsigned int) f->header.mic, (unsigned int) f->header.dev_addr,
-               type_str,
-               (unsigned int) f->header.fid, header_size + payload_size,
-			   ls_frame_fifo_size(&ls->_internal.uplink_queue));
-#endif
-        /* Configure for TX */
-        configure_sx127x(ls);
-        DEBUG("[LoRa] transceiver configured\n");
-        
-        /* Send frame into LoRa PHY */
-        iolist_t data = {
-            .iol_base = f,
-            .iol_len = header_size + payload_size,
-        };
-        
-        if (ls->_internal.device->driver->send(ls->_internal.device, &data) < 0) {
-            puts("[LoRa] cannot send, device busy");
+                if (send_now) {
+                    transmit_next(ls);
+                }
+                break;
+
+            default:
+                break;
         }
-        
-        DEBUG("[LoRa] data sent\n");
     }
 
     return NULL;
@@ -962,6 +1163,9 @@ static void *tim_handler(void *arg)
                     DEBUG("[LoRa] stop retransmitting\n");
                     ls->_internal.num_retr = 0;
 
+                    /* Entry stays in the FIFO and is sent again after rejoin */
+                    ls->_internal.appdata_pending = false;
+
                     if (ls->appdata_send_failed_cb != NULL) {
                         ls->appdata_send_failed_cb();
                     }
@@ -1011,6 +1215,8 @@ int ls_ed_init(ls_ed_t *ls)
     ls->_internal.last_fid = 0;
     ls->_internal.num_retr = 0;
     ls->_internal.is_joined = false;
+    ls->_internal.adr_cmd = 0;
+    ls->_internal.adr_ack_cnt = 0;
 
     if (!ls->settings.no_join) {
     	ls->_internal.dev_addr = LS_ADDR_UNDEFINED;
@@ -1021,6 +1227,7 @@ int ls_ed_init(ls_ed_t *ls)
 
     /* Initialize appdata queue */
     appdata_fifo_init(&ls->_internal.appdata_fifo);
+    ls->_internal.appdata_pending = false;
 
     /* Initialize uplink frame queue */
     ls_frame_fifo_init(&ls->_internal.uplink_queue);
@@ -1078,12 +1285,21 @@ int ls_ed_send_app_data(ls_ed_t *ls, uint8_t *buf, size_t buflen, bool confirmed
         DEBUG("[LoRa] pushing data to FIFO\n");
         appdata_fifo_t *fifo = &ls->_internal.appdata_fifo;
 
-        /* Last data has priority, so we can pop oldest item from the queue if it's full */
+        /* Last data has priority, so we can pop oldest item from the queue if it's full.
+         * The front entry awaiting ACK is in flight, the one behind it goes instead */
         if (appdata_fifo_full(fifo)) {
-            appdata_fifo_pop(fifo, NULL);
+            if (ls->_internal.appdata_pending) {
+                appdata_fifo_pop_next(fifo);
+            }
+            else {
+                appdata_fifo_pop(fifo, NULL);
+            }
         }
 
-        appdata_fifo_push(fifo, buf, buflen, ls->_internal.last_fid, confirmed, with_ack);
+        if (!appdata_fifo_push(fifo, buf, buflen, ls->_internal.last_fid, confirmed, with_ack)) {
+            DEBUG("[LoRa] unable to push data to FIFO\n");
+            return -LS_SEND_E_FIFO_ERROR;
+        }
         
         /* Not joined to the network, delay appdata frame until device is joined */
         if (!ls->settings.no_join && !ls->_internal.is_joined) {
@@ -1091,17 +1307,8 @@ int ls_ed_send_app_data(ls_ed_t *ls, uint8_t *buf, size_t buflen, bool confirmed
             return -LS_SEND_E_NOT_JOINED;
         }
         
-        if (appdata_fifo_size(fifo) > 1) {
-            DEBUG("[LoRa] FIFO is not empty, postpone new data\n");
-            
-            appdata_fifo_entry_t e;
-            appdata_fifo_peek(fifo, &e);
-            DEBUG("[LoRa] send oldest data instead [fid: %d, size: %d]\n", e.id, e.size);
-            buf = e.data;
-            buflen = e.size;
-            confirmed = e.is_confirmed;
-            with_ack = e.is_with_ack;
-        }
+        /* FIFO is sent oldest first, new data waits for the entries before it to be acknowledged */
+        return send_backlog(ls);
     }
 
     ls->_internal.confirmation_required = false;
@@ -1136,6 +1343,7 @@ void ls_ed_unjoin(ls_ed_t *ls)
     /* Clear uplink queue */
     ls_frame_fifo_clear(&ls->_internal.uplink_queue);
     ls->_internal.confirmation_required = false;
+    ls->_internal.appdata_pending = false;
 
 	/* Stop timers */
     rtctimers_millis_remove(&ls->_internal.join_req_expired);
@@ -1190,7 +1398,8 @@ int ls_ed_join(ls_ed_t *ls)
 
     /* Launch timeout timer */
     DEBUG("[LoRa] set join timeout timer\n");
-    rtctimers_millis_set_msg(&ls->_internal.join_req_expired, 1000*LS_JOIN_TIMEOUT, &msg_join_timeout, ls->_internal.tim_thread_pid);
+    /* Request goes out after the join jitter */
+    rtctimers_millis_set_msg(&ls->_internal.join_req_expired, 1000*LS_JOIN_TIMEOUT + LS_ED_JOIN_JITTER_MS, &msg_join_timeout, ls->_internal.tim_thread_pid);
 
     return LS_OK;
 }
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup    loralan_gateway_adr LoRaLAN gateway ADR
+ * @ingroup     loralan_gateway
+ * @brief       Adaptive data rate and TX power control of the LoRaLAN nodes
+ *
+ * Gate collects the SNR of the node's uplinks and commands it to the fastest
+ * data rate and the lowest TX power the link margin allows. Nodes report
+ * their ADR state in the status byte of each uplink, so the gate knows
+ * which settings the node actually uses and leaves ADR-off nodes alone.
+ * @{
+ * @file		ls-gate-adr.h
+ * @brief       Adaptive data rate engine of the LoRaLAN gateway
+ * @author      Oleg Artamonov
+ */
+#ifndef LS_GATE_ADR_H_
+#define LS_GATE_ADR_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ls-gate.h"
+
+/**
+ * @brief Link margin kept above the demodulation floor [dB]
+ */
+#ifndef LS_GATE_ADR_MARGIN_DB
+#define LS_GATE_ADR_MARGIN_DB 10
+#endif
+
+/**
+ * @brief Number of downlinks the ADR command goes with until the node takes it
+ */
+#ifndef LS_GATE_ADR_RETRIES
+#define LS_GATE_ADR_RETRIES 3
+#endif
+
+/**
+ * @brief Forgets the link quality history, node starts with its own settings.
+ */
+void ls_gate_adr_reset(ls_gate_node_t *node);
+
+/**
+ * @brief Records the SNR of the node's uplink and decides on the new data rate and TX power.
+ *
+ * Data rate is raised only to the data rates some channel of the gate listens to
+ * at the node's frequency, the rest of the link margin goes to TX power.
+ *
+ * Pending command is done when the node reports the commanded settings
+ * in the uplink status byte, and dropped after LS_GATE_ADR_RETRIES downlinks.
+ *
+ * @param[in] ls        gate the uplink is received by
+ * @param[in] ch        channel the uplink is received on
+ * @param[in] node      node the uplink is received from
+ * @param[in] snr       SNR of the uplink [dB]
+ * @param[in] status    status byte of the uplink, node's ADR state
+ */
+void ls_gate_adr_uplink(ls_gate_t *ls, ls_gate_channel_t *ch, ls_gate_node_t *node, int8_t snr,
+                        uint8_t status);
+
+/**
+ * @brief Checks if the node has an ADR command waiting for the downlink.
+ */
+static inline bool ls_gate_adr_pending(ls_gate_node_t *node)
+{
+    return (node->adr.cmd != 0) && (node->adr.retries < LS_GATE_ADR_RETRIES);
+}
+
+/**
+ * @brief Takes the ADR command to send in the downlink status byte.
+ *
+ * Command stays pending until the node's uplink shows it's taken.
+ *
+ * @return status byte of the downlink frame, 0 if there's no command
+ */
+uint8_t ls_gate_adr_command(ls_gate_t *ls, ls_gate_node_t *node);
+
+#endif /* LS_GATE_ADR_H_ */
@@ -34,7 +34,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-#include "mutex.h"
+#include "mutex_pi.h"
+#include "bitfield.h"
 
 #include "ls-crypto.h"
 #include "ls-mac-types.h"
@@ -46,14 +47,97 @@
  * depend on available RAM
  */
 
-#if defined(CPU_FAM_STM32L4)
+#if defined(CPU_FAM_STM32L4) || defined(CPU_NATIVE)
     #define LS_GATE_MAX_NODES 1000
     #define LS_GATE_NONCES_PER_DEVICE 20
+    #define LS_GATE_INDEX_BITS 11
+    #define LS_GATE_SESSION_CACHE_SIZE 32
+    #define LS_GATE_DL_POOL_SIZE 64
 #else
     #define LS_GATE_MAX_NODES 100
     #define LS_GATE_NONCES_PER_DEVICE 8
+    #define LS_GATE_INDEX_BITS 8
+    #define LS_GATE_SESSION_CACHE_SIZE 16
+    #define LS_GATE_DL_POOL_SIZE 16
 #endif
 
+/**
+ * Size of the node ID hash index, must be a power of two and at least twice
+ * as large as LS_GATE_MAX_NODES to keep probe sequences short
+ */
+#define LS_GATE_INDEX_SIZE (1 << LS_GATE_INDEX_BITS)
+
+/**
+ * Empty slot marker for the node ID hash index
+ */
+#define LS_GATE_INDEX_EMPTY 0
+
+/**
+ * End of list marker for the nodes activity list
+ */
+#define LS_GATE_LRU_NONE 0xFFFF
+
+/**
+ * Number of frame IDs below the highest received one that are still tracked for duplicates
+ */
+#define LS_GATE_FID_WINDOW_SIZE 32
+
+/**
+ * Sliding anti-replay window of received frame IDs (RFC 6479 style).
+ * Bit N of the bitmap is set if frame ID (top - N) was received, empty bitmap means no frames were received yet
+ */
+typedef struct __attribute__((__packed__)) {
+	ls_frame_id_t top;			/**< Highest frame ID received */
+	uint32_t bitmap;			/**< Received frame IDs in the window ending at top */
+} ls_gate_fid_window_t;
+
+/**
+ * Maximum size of the queued downlink application data
+ */
+#define LS_GATE_DL_DATA_SIZE 128
+
+/**
+ * End of list marker for the downlink queues
+ */
+#define LS_GATE_DL_NONE 0xFF
+
+/**
+ * Owner of the free downlink entry
+ */
+#define LS_GATE_DL_NO_OWNER 0xFFFF
+
+#if LS_GATE_DL_POOL_SIZE >= LS_GATE_DL_NONE
+#error "LS_GATE_DL_POOL_SIZE must be less than LS_GATE_DL_NONE"
+#endif
+
+/**
+ * Downlink frame waiting for the node's uplink in the shared pool
+ */
+typedef struct {
+	uint32_t expires;			/**< Ping count the frame is dropped at */
+	uint16_t owner;				/**< Address of the node the frame is queued for, LS_GATE_DL_NO_OWNER if entry is free */
+	uint8_t next;				/**< Next frame of the same node or the next free entry */
+	uint8_t len;				/**< Length of the data */
+	uint8_t data[LS_GATE_DL_DATA_SIZE];	/**< Application data */
+} ls_gate_dl_entry_t;
+
+/**
+ * Number of uplinks the adaptive data rate decision is based on
+ */
+#define LS_GATE_ADR_HISTORY 8
+
+/**
+ * Adaptive data rate state of the node
+ */
+typedef struct __attribute__((__packed__)) {
+	int8_t snr[LS_GATE_ADR_HISTORY];	/**< Ring of SNR values of the last uplinks [dB] */
+	uint8_t snr_head;			/**< Ring position of the next SNR value */
+	uint8_t num_snr;			/**< Number of SNR values collected with the current settings */
+	uint8_t power;				/**< TX power step the node reported using */
+	uint8_t cmd;				/**< ADR command the node hasn't taken yet, 0 if none */
+	uint8_t retries;			/**< Downlinks the pending command went with */
+} ls_gate_adr_t;
+
 typedef struct __attribute__((__packed__)){
     uint64_t node_id;			/**< Node unique ID */
 	uint64_t app_id;			/**< Application unique ID */    
@@ -61,20 +145,43 @@ typedef struct __attribute__((__packed__)){
 	uint32_t app_nonce;			/**< Application nonce */
     ls_addr_t addr;				/**< Node unique address in network */
 	void *node_ch;				/**< Node's channel */
-    ls_nonce_t nonce[LS_GATE_NONCES_PER_DEVICE]; /**< List of accepted device nonces */
+    ls_nonce_t dev_nonce;		/**< Device nonce of the current session */
+	uint16_t nonces[LS_GATE_NONCES_PER_DEVICE]; /**< Ring of accepted device nonce fingerprints, 0 is empty */
 	ls_node_class_t node_class;	/**< Node's class */
     ls_device_status_t status;	/**< Last received device status */
-	ls_frame_id_t last_fid;		/**< Last received frame ID */
-	uint8_t num_nonces;			/**< Number of remembered nonces  */
+	ls_gate_fid_window_t fids;	/**< Received frame IDs window */
+	ls_gate_adr_t adr;			/**< Link quality history and data rate settings */
+	uint8_t nonces_head;		/**< Ring position of the next nonce fingerprint */
 	uint8_t num_pending;		/**< Number of frames pending */
+	uint8_t dl_head;			/**< First frame of the node's downlink queue, LS_GATE_DL_NONE if empty */
+	uint8_t dl_tail;			/**< Last frame of the node's downlink queue */
+	uint64_t rx_deadline;		/**< Time the node's receive window closes after its last uplink [us] */
 	bool is_static;				/**< Statically personalized device, won't be kicked for idle */
 } ls_gate_node_t;
 
+/**
+ * Derived session keys of the node, cached until the node joins again or gets kicked.
+ * Cache is direct-mapped by the node address, LS_GATE_SESSION_CACHE_SIZE must be a power of two
+ */
+typedef struct {
+	ls_addr_t addr;					/**< Address of the node keys belong to, LS_ADDR_UNDEFINED if entry is empty */
+	ls_mic_ctx_t mic_ctx;			/**< Precomputed HMAC state of the MIC key */
+	uint8_t aes_key[AES_KEY_SIZE];	/**< Payload encryption key */
+} ls_gate_session_t;
+
 typedef struct {
 	ls_gate_node_t nodes[LS_GATE_MAX_NODES];
-	bool nodes_free_list[LS_GATE_MAX_NODES];
+	BITFIELD(nodes_used, LS_GATE_MAX_NODES);		/**< Occupied node records, bit number is node's address */
+	uint16_t nodes_index[LS_GATE_INDEX_SIZE];		/**< Open addressing index by node ID, holds (address + 1) */
+	ls_gate_session_t sessions[LS_GATE_SESSION_CACHE_SIZE];	/**< Session keys cache */
+	uint16_t lru_prev[LS_GATE_MAX_NODES];			/**< Previous node in the activity list, LS_GATE_LRU_NONE for the first one */
+	uint16_t lru_next[LS_GATE_MAX_NODES];			/**< Next node in the activity list, LS_GATE_LRU_NONE for the last one */
+	uint16_t lru_head;								/**< Least recently seen node */
+	uint16_t lru_tail;								/**< Most recently seen node */
+	ls_gate_dl_entry_t downlinks[LS_GATE_DL_POOL_SIZE];	/**< Downlink frames of all nodes, linked into per-node queues */
+	uint8_t dl_free;								/**< First free downlink entry, LS_GATE_DL_NONE if pool is exhausted */
     size_t num_nodes;
-    mutex_t mutex;
+    mutex_pi_t mutex;
 } ls_gate_devices_t;
 
 void ls_devlist_init(ls_gate_devices_t *devlist);
@@ -84,6 +191,9 @@ ls_gate_node_t *ls_devlist_add_by_addr(ls_gate_devices_t *devlist, ls_addr_t add
 bool ls_devlist_check_nonce(ls_gate_devices_t *devlist, uint64_t node_id, uint32_t nonce);
 ls_gate_node_t *add_nonce(ls_gate_devices_t *devlist, uint64_t node_id, uint32_t nonce);
 
+void ls_devlist_reset_fid(ls_gate_node_t *node);
+bool ls_devlist_accept_fid(ls_gate_node_t *node, ls_frame_id_t fid);
+
 ls_gate_node_t *ls_devlist_get(ls_gate_devices_t *devlist, ls_addr_t addr);
 ls_gate_node_t *ls_devlist_get_by_nodeid(ls_gate_devices_t *devlist, uint64_t nodeid);
 
@@ -93,4 +203,18 @@ bool ls_devlist_is_full(ls_gate_devices_t *devlist);
 
 bool ls_devlist_remove_device(ls_gate_devices_t *devlist, ls_addr_t addr);
 
+void ls_devlist_touch(ls_gate_devices_t *devlist, ls_gate_node_t *node, uint32_t now);
+ls_gate_node_t *ls_devlist_least_recent(ls_gate_devices_t *devlist);
+
+bool ls_devlist_dl_push(ls_gate_devices_t *devlist, ls_gate_node_t *node, const uint8_t *buf, size_t len, uint32_t now, uint32_t expires);
+bool ls_devlist_dl_next(ls_gate_devices_t *devlist, ls_gate_node_t *node, uint32_t now, uint8_t *buf, size_t *len);
+void ls_devlist_dl_sent(ls_gate_devices_t *devlist, ls_gate_node_t *node);
+
+static inline bool ls_devlist_dl_empty(ls_gate_node_t *node) {
+	return node->dl_head == LS_GATE_DL_NONE;
+}
+
+void ls_devlist_get_session(ls_gate_devices_t *devlist, ls_gate_node_t *node, ls_gate_session_t *session);
+void ls_devlist_invalidate_session(ls_gate_devices_t *devlist, ls_addr_t addr);
+
 #endif /* LS_GATE_DEVICE_LIST_H_ */
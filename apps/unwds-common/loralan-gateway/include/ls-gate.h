@@ -45,6 +45,11 @@
 #include "sx127x_params.h"
 #include "sx127x_netdev.h"
 
+#ifdef LS_GATE_EVENT_LOOP
+#include "event.h"
+#include "event/timeout.h"
+#endif
+
 /**
  * @brief Delay before sending frame from queue
  */
@@ -70,6 +75,23 @@
  */
 #define LS_MAX_PING_DIFFERENCE (60 * 60 * 12)  /* 36 hours */
 
+/**
+ * @brief Time after the uplink of the class A node the reply has to be sent within [us].
+ *
+ * Node listens for LS_RX_DELAY1 seconds after the uplink, the rest is left for the preamble
+ */
+#define LS_GATE_RX_DEADLINE (2500U * US_PER_MS)
+
+/**
+ * @brief Lifetime of the downlink queued for the class A node in seconds.
+ */
+#define LS_GATE_DL_LIFETIME_S (60 * 60)
+
+/**
+ * @brief Lifetime of the queued downlink in ping counts.
+ */
+#define LS_GATE_DL_LIFETIME (LS_GATE_DL_LIFETIME_S / LS_PING_TIMEOUT_S)
+
 #define LS_TX_DELAY_MIN_MS 100
 #define LS_TX_DELAY_MAX_MS 1000
 
@@ -77,11 +99,6 @@
 #define LS_RX2_DR LS_DR3
 #define LS_RX2_CH 0
 
-/**
- * @brief RSSI of the channel considered free.
- */
-#define LS_CHANNEL_FREE_RSSI -100
-
 /**
  * @brief LoRa-Star stack status.
  */
@@ -128,6 +145,16 @@ typedef struct {
     uint32_t keepalive_period_ms;    /**< Period of calling `keepalive_cb` [milliseconds] */
 } ls_gate_settings_t;
 
+#ifdef LS_GATE_EVENT_LOOP
+/**
+ * @brief Gateway event, carries the channel or the gate it was posted for.
+ */
+typedef struct {
+    event_t super;                  /**< Event queue entry */
+    void *arg;                      /**< Channel or gate pointer */
+} ls_gate_event_t;
+#endif
+
 /**
  * @brief Holds internal channel-related data such as transceiver handler, thread stack, etc.
  */
@@ -138,9 +165,20 @@ typedef struct {
     ls_frame_t current_frame;    /**< Memory for current frame */
     mutex_t channel_mutex;        /**< Mutex on the channel */
 
-    ls_frame_fifo_t ul_fifo;    /**< Uplink frame queue */
+    ls_frame_fifo_t ul_fifo;    /**< Uplink frame queue, replies to the nodes are kept at the front */
+    ls_addr_t tx_addr;          /**< Node the frame being sent is addressed to */
+    ls_addr_t rx_window_addr;   /**< Node the open receive window is waiting for, LS_ADDR_UNDEFINED for any node */
+
+#ifdef LS_GATE_EVENT_LOOP
+    ls_gate_event_t ev_isr;        /**< Transceiver interrupt event */
+    ls_gate_event_t ev_tx;        /**< Send next frame from the uplink queue event */
+    ls_gate_event_t ev_rx1;        /**< First receive window expired event */
 
+    event_timeout_t rx_window1;    /**< First receive window timer */
+#else
     xtimer_t    rx_window1;        /**< First receive window timer */
+    msg_t rx1_msg;                /**< First receive window expired message */
+#endif
 } ls_channel_internal_t;
 
 typedef enum {
@@ -159,6 +197,7 @@ typedef struct {
     uint32_t frequency;                    /**< LoRa frequency */
 
     int16_t    last_rssi;                    /**< RSSI of last received packet on this channel */
+    int8_t last_snr;                    /**< SNR of last received packet on this channel */
 
     ls_channel_state_t state;            /**< State of the channel */
 
@@ -171,14 +210,26 @@ typedef struct {
 #define LS_TIM_HANDLER_STACKSIZE        (2048)
 #define LS_TIM_MSG_QUEUE_SIZE 8
 
+#define LS_EVENT_HANDLER_STACKSIZE        (2048)
+
 /**
  * @brief Lora-Star gate stack internal data.
  */
 typedef struct {
     uint32_t ping_count;                /**< Ping count, increments every PING_TIMEOUT us */
-    xtimer_t ping_timer;                /**< Timer for periodic ping count increment */
     xtimer_t keepalive_timer;            /**< Timer for periodic keepalive callback calls */
 
+#ifdef LS_GATE_EVENT_LOOP
+    /* Whole MAC runs on the single event queue */
+    event_queue_t queue;                /**< Gate events queue */
+    ls_gate_event_t ev_ping;            /**< Ping count increment event */
+    event_timeout_t ping_timer;         /**< Timer for periodic ping count increment */
+
+    kernel_pid_t event_thread_pid;
+    char event_thread_stack[LS_EVENT_HANDLER_STACKSIZE];
+#else
+    xtimer_t ping_timer;                /**< Timer for periodic ping count increment */
+
     /* Timeout message handler data */
     kernel_pid_t tim_thread_pid;
     char tim_thread_stack[LS_TIM_HANDLER_STACKSIZE];
@@ -186,7 +237,7 @@ typedef struct {
     /* Uplink queue handler data */
     kernel_pid_t uq_thread_pid;
     char uq_thread_stack[LS_TIM_HANDLER_STACKSIZE];
-
+#endif
 } ls_gate_internal_t;
 
 /**
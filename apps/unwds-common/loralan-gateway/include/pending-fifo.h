@@ -32,22 +32,69 @@
 #define PENDING_FIFO_H_
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "mutex.h"
+#include "sema.h"
+#include "tsrb.h"
+#include "kernel_types.h"
 
-#define GC_MAX_PENDING 16
+/**
+ * @brief Size of the replies ring in bytes, must be a power of two
+ */
+#ifndef GC_PENDING_BUF_SIZE
+#define GC_PENDING_BUF_SIZE 2048
+#endif
+
+/**
+ * @brief Maximum length of a single reply
+ */
 #define GC_MAX_REPLY_LEN 256
 
 /**
- * @brief describes the frame queue.
+ * @brief Length of the record header, holds the reply length (little-endian)
+ */
+#define GC_PENDING_HDR_LEN 2
+
+/**
+ * @brief Maximum length of a reply built in place with gc_pending_fifo_begin()
+ */
+#define GC_MAX_RECORD_LEN (GC_PENDING_BUF_SIZE - GC_PENDING_HDR_LEN)
+
+/**
+ * @brief Type of the message asking the consumer to flush the queue
+ */
+#define GC_PENDING_MSG_FLUSH 0x4746
+
+#if GC_PENDING_BUF_SIZE < GC_PENDING_HDR_LEN + GC_MAX_REPLY_LEN
+#error "GC_PENDING_BUF_SIZE must fit at least one reply of GC_MAX_REPLY_LEN bytes"
+#endif
+
+#if GC_PENDING_BUF_SIZE > 0x10000
+#error "GC_PENDING_BUF_SIZE must not exceed 64 KiB, record lengths are 16-bit"
+#endif
+
+/**
+ * @brief describes the replies queue.
+ *
+ * Replies are stored back to back as length-prefixed records in a byte ring,
+ * so short replies take only as much space as they need. Producers are
+ * serialized with the mutex and publish a record only when it is written
+ * completely, the single consumer (UART writer) reads the ring in place.
  */
 typedef struct {
-	char fifo[GC_MAX_PENDING][GC_MAX_REPLY_LEN];	/**< Queue data */
+	char buf[GC_PENDING_BUF_SIZE];	/**< Queue data */
+	tsrb_t rb;						/**< Ring over the queue data */
+
+	uint16_t left;		/**< Bytes of the current record not yet consumed */
 
-	int front;	/**< Pointer to the queue's front */
-	int rear;	/**< Pointer to the queue's start */
+	uint16_t reserved;	/**< Room reserved for the record being built */
+	uint16_t written;	/**< Bytes of the record being built written so far */
 
-	mutex_t mutex; /**< FIFO's mutex */
+	mutex_t mutex;		/**< Producers' mutex */
+	sema_t space;		/**< Posted by the consumer when it frees space for the waiting producer */
+	volatile bool waiting;	/**< Producer waits for space */
 } gc_pending_fifo_t;
 
 /**
@@ -61,21 +108,107 @@ void gc_pending_fifo_init(gc_pending_fifo_t *fifo);
  * @brief evicts element from the end of a queue.
  *
  * @param	[IN]	*fifo	pointer to the FIFO structure
- * @param	[OUT]	*reply	pointer to the buf to write
+ * @param	[OUT]	*reply	pointer to the buf to write, long enough for the longest reply queued
+ *
+ * @return length of the reply, 0 if queue is empty
+ */
+size_t gc_pending_fifo_pop(gc_pending_fifo_t *fifo, char *buf);
+
+/**
+ * @brief returns contiguous chunk of the queued data without copying it.
+ *
+ * Chunk never crosses the record or the ring boundary, so the whole queue
+ * is read by the sequence of peek/consume calls until peek returns 0.
+ * Must be called from the single consumer thread only.
+ *
+ * @param	[IN]	*fifo	pointer to the FIFO structure
+ * @param	[OUT]	**data	pointer to the chunk start
+ *
+ * @return length of the chunk, 0 if queue is empty
+ */
+size_t gc_pending_fifo_peek(gc_pending_fifo_t *fifo, const uint8_t **data);
+
+/**
+ * @brief releases bytes returned by gc_pending_fifo_peek().
+ *
+ * Wakes up the producer waiting in gc_pending_fifo_push_wait(), if any.
  *
- * @return false if queue is empty
+ * @param	*fifo	pointer to the FIFO structure
+ * @param	len		number of bytes to release, up to the chunk length
  */
-bool gc_pending_fifo_pop(gc_pending_fifo_t *fifo, char *buf);
+void gc_pending_fifo_consume(gc_pending_fifo_t *fifo, size_t len);
 
 /**
- * @brief inserts element into the queue.
+ * @brief inserts null-terminated text reply into the queue.
  *
  * @param	*fifo	pointer to the FIFO structure
- * @param	*buf	pointer to the reply buffer to insert
+ * @param	*buf	pointer to the reply string to insert
  *
  * @return 	false if frame is full
  */
-bool gc_pending_fifo_push(gc_pending_fifo_t *fifo, char buf[GC_MAX_REPLY_LEN]);
+bool gc_pending_fifo_push(gc_pending_fifo_t *fifo, const char *buf);
+
+/**
+ * @brief inserts reply of the specified length into the queue, reply may contain zero bytes.
+ *
+ * @param	*fifo	pointer to the FIFO structure
+ * @param	*buf	pointer to the reply data to insert
+ * @param	len		length of the reply, up to GC_MAX_REPLY_LEN bytes
+ *
+ * @return 	false if queue has no room for the reply or reply is too long
+ */
+bool gc_pending_fifo_push_len(gc_pending_fifo_t *fifo, const void *buf, size_t len);
+
+/**
+ * @brief inserts reply into the queue, waits for the consumer to free space if needed.
+ *
+ * Flush message is sent to the consumer thread before each wait, so it must
+ * not be called by the consumer itself nor by time-critical threads. Only one
+ * thread may wait for space at a time.
+ *
+ * @param	*fifo	pointer to the FIFO structure
+ * @param	*buf	pointer to the reply data to insert
+ * @param	len		length of the reply, up to GC_MAX_REPLY_LEN bytes
+ * @param	writer	PID of the consumer thread
+ *
+ * @return 	false if reply is too long
+ */
+bool gc_pending_fifo_push_wait(gc_pending_fifo_t *fifo, const void *buf, size_t len, kernel_pid_t writer);
+
+/**
+ * @brief starts reply built in place in the queue.
+ *
+ * Room for max_len bytes is reserved and producers' lock is held until
+ * gc_pending_fifo_end(), so the reply must be written without blocking.
+ * With the writer specified waits for space as gc_pending_fifo_push_wait() does.
+ *
+ * @param	*fifo	pointer to the FIFO structure
+ * @param	max_len	maximum length of the reply, up to GC_MAX_RECORD_LEN bytes
+ * @param	writer	PID of the consumer thread to wait for, KERNEL_PID_UNDEF not to wait
+ *
+ * @return 	false if queue has no room for the reply or reply is too long
+ */
+bool gc_pending_fifo_begin(gc_pending_fifo_t *fifo, size_t max_len, kernel_pid_t writer);
+
+/**
+ * @brief appends data to the reply started with gc_pending_fifo_begin().
+ *
+ * @param	*fifo	pointer to the FIFO structure
+ * @param	*data	pointer to the data to append
+ * @param	len		length of the data
+ *
+ * @return 	false if data exceeds room reserved for the reply
+ */
+bool gc_pending_fifo_write(gc_pending_fifo_t *fifo, const void *data, size_t len);
+
+/**
+ * @brief publishes the reply started with gc_pending_fifo_begin().
+ *
+ * Empty reply is dropped.
+ *
+ * @param	*fifo	pointer to the FIFO structure
+ */
+void gc_pending_fifo_end(gc_pending_fifo_t *fifo);
 
 /**
  * @biref checks that queue is empty or not.
@@ -91,7 +224,7 @@ bool gc_pending_fifo_empty(gc_pending_fifo_t *fifo);
  *
  * @param	*fifo	pointer to the FIFO structure
  *
- * @return	true if queue is full
+ * @return	true if queue has no room even for the shortest reply
  */
 bool gc_pending_fifo_full(gc_pending_fifo_t *fifo);
 
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @ingroup     loralan_gateway_adr
+ * @{
+ * @file		ls-gate-adr.c
+ * @brief       Adaptive data rate engine of the LoRaLAN gateway
+ * @author      Oleg Artamonov
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ls-mac-types.h"
+#include "ls-gate.h"
+#include "ls-gate-adr.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+/**
+ * @brief SNR required to demodulate the frame at the data rate [dB], SX127x datasheet
+ */
+static const int8_t required_snr[] = {
+    -20,    /* DR0, SF12 */
+    -17,    /* DR1, SF11 */
+    -15,    /* DR2, SF10 */
+    -12,    /* DR3, SF9 */
+    -10,    /* DR4, SF8 */
+    -7,     /* DR5, SF7 */
+    -7,     /* DR6, SF7 250 kHz */
+};
+
+static ls_gate_channel_t *find_channel(ls_gate_t *ls, uint32_t frequency, ls_datarate_t dr)
+{
+    for (size_t i = 0; i < ls->num_channels; i++) {
+        if (ls->channels[i].frequency == frequency && ls->channels[i].dr == dr) {
+            return &ls->channels[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int max_snr(const ls_gate_adr_t *adr)
+{
+    int snr = adr->snr[0];
+    for (unsigned i = 1; i < adr->num_snr; i++) {
+        if (adr->snr[i] > snr) {
+            snr = adr->snr[i];
+        }
+    }
+
+    return snr;
+}
+
+void ls_gate_adr_reset(ls_gate_node_t *node)
+{
+    memset(&node->adr, 0, sizeof(node->adr));
+}
+
+void ls_gate_adr_uplink(ls_gate_t *ls, ls_gate_channel_t *ch, ls_gate_node_t *node, int8_t snr,
+                        uint8_t status)
+{
+    ls_gate_adr_t *adr = &node->adr;
+
+    /* Node doesn't follow the commands */
+    if (!(status & LS_ADR_CMD_FLAG)) {
+        if (adr->cmd || adr->num_snr) {
+            DEBUG("ls-gate-adr: node 0x%08X has ADR disabled\n", (unsigned) node->addr);
+            ls_gate_adr_reset(node);
+        }
+        return;
+    }
+
+    adr->power = LS_ADR_CMD_POWER(status);
+
+    if (adr->cmd) {
+        if ((LS_ADR_CMD_DR(status) == LS_ADR_CMD_DR(adr->cmd)) &&
+            (LS_ADR_CMD_POWER(status) == LS_ADR_CMD_POWER(adr->cmd))) {
+            DEBUG("ls-gate-adr: node 0x%08X took the command\n", (unsigned) node->addr);
+        }
+        else if (adr->retries < LS_GATE_ADR_RETRIES) {
+            /* Frames heard before the node takes the command describe the old settings */
+            return;
+        }
+        else {
+            DEBUG("ls-gate-adr: node 0x%08X ignored the command\n", (unsigned) node->addr);
+        }
+
+        adr->cmd = 0;
+        adr->retries = 0;
+        adr->num_snr = 0;
+    }
+
+    adr->snr[adr->snr_head] = snr;
+    adr->snr_head = (adr->snr_head + 1) % LS_GATE_ADR_HISTORY;
+
+    if (adr->num_snr < LS_GATE_ADR_HISTORY) {
+        adr->num_snr++;
+    }
+
+    /* Single frames are too noisy to decide on */
+    if (adr->num_snr < LS_GATE_ADR_HISTORY) {
+        return;
+    }
+
+    int margin = max_snr(adr) - required_snr[ch->dr] - LS_GATE_ADR_MARGIN_DB;
+
+    /* Fastest data rate the margin allows and the gate listens to at the node's frequency */
+    ls_datarate_t dr = ch->dr;
+    for (int i = ch->dr + 1; i <= LS_DR6; i++) {
+        if (required_snr[i] - required_snr[ch->dr] > margin) {
+            break;
+        }
+
+        if (find_channel(ls, ch->frequency, (ls_datarate_t) i) != NULL) {
+            dr = (ls_datarate_t) i;
+        }
+    }
+
+    margin -= required_snr[dr] - required_snr[ch->dr];
+
+    /* Rest of the margin goes to TX power, which is raised back as soon as the link degrades */
+    int steps;
+    if (margin >= 0) {
+        steps = margin / LS_ADR_POWER_STEP_DB;
+    }
+    else {
+        steps = -((-margin + LS_ADR_POWER_STEP_DB - 1) / LS_ADR_POWER_STEP_DB);
+    }
+
+    int power = adr->power + steps;
+    if (power > LS_ADR_POWER_MAX_STEP) {
+        power = LS_ADR_POWER_MAX_STEP;
+    }
+    else if (power < 0) {
+        power = 0;
+    }
+
+    if (dr == ch->dr && power == adr->power) {
+        return;
+    }
+
+    DEBUG("ls-gate-adr: node 0x%08X, SNR margin %d dB, DR%d -> DR%d, power step %d -> %d\n",
+          (unsigned) node->addr, margin, ch->dr, dr, adr->power, power);
+
+    adr->cmd = LS_ADR_CMD(dr, power);
+    adr->retries = 0;
+}
+
+uint8_t ls_gate_adr_command(ls_gate_t *ls, ls_gate_node_t *node)
+{
+    (void)ls;
+
+    if (!ls_gate_adr_pending(node)) {
+        return 0;
+    }
+
+    /* Node's channel follows its uplinks, so downlinks switch to the new data rate once it's taken */
+    node->adr.retries++;
+
+    return node->adr.cmd;
+}
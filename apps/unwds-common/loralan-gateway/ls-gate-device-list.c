@@ -35,9 +35,10 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "xtimer.h"
-#include "mutex.h"
+#include "mutex_pi.h"
 
 #include "ls-mac-types.h"
 #include "ls-gate-device-list.h"
@@ -45,19 +46,190 @@ extern "C" {
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
+#define LS_GATE_INDEX_MASK (LS_GATE_INDEX_SIZE - 1)
+
 /**
  * @brief Initialize list of connected nodes
  */
 void ls_devlist_init(ls_gate_devices_t *devlist) {
+	/* All node records are free and index is empty */
 	memset(devlist, 0, sizeof(ls_gate_devices_t));
 
-	for(int i = 0; i < LS_GATE_MAX_NODES; i++) {
-		devlist->nodes_free_list[i] = true;
-    }
-	mutex_init(&devlist->mutex);    
+	for (int i = 0; i < LS_GATE_SESSION_CACHE_SIZE; i++) {
+		devlist->sessions[i].addr = LS_ADDR_UNDEFINED;
+	}
+
+	/* Activity list is empty */
+	memset(devlist->lru_prev, 0xFF, sizeof(devlist->lru_prev));
+	memset(devlist->lru_next, 0xFF, sizeof(devlist->lru_next));
+	devlist->lru_head = devlist->lru_tail = LS_GATE_LRU_NONE;
+
+	/* All downlink entries are free */
+	for (int i = 0; i < LS_GATE_DL_POOL_SIZE; i++) {
+		devlist->downlinks[i].owner = LS_GATE_DL_NO_OWNER;
+		devlist->downlinks[i].next = (i + 1 < LS_GATE_DL_POOL_SIZE) ? i + 1 : LS_GATE_DL_NONE;
+	}
+	devlist->dl_free = 0;
+
+	mutex_pi_init(&devlist->mutex);    
     DEBUG("ls-gate-device-list: device list initialized\n");
 }
 
+/**
+ * @brief Home slot of the node ID in the hash index (Fibonacci hashing of the folded EUI-64)
+ */
+static inline uint32_t index_hash(uint64_t node_id) {
+	uint32_t h = (uint32_t) (node_id ^ (node_id >> 32));
+	h *= 0x9E3779B1U;
+
+	return h >> (32 - LS_GATE_INDEX_BITS);
+}
+
+/**
+ * @brief Looks up index slot holding the node with specified ID, returns -1 if there's no such node
+ */
+static int index_find(ls_gate_devices_t *devlist, uint64_t node_id) {
+	uint32_t pos = index_hash(node_id);
+
+	for (uint32_t i = 0; i < LS_GATE_INDEX_SIZE; i++) {
+		uint16_t entry = devlist->nodes_index[pos];
+
+		if (entry == LS_GATE_INDEX_EMPTY) {
+			return -1;
+		}
+
+		if (devlist->nodes[entry - 1].node_id == node_id) {
+			return pos;
+		}
+
+		pos = (pos + 1) & LS_GATE_INDEX_MASK;
+	}
+
+	return -1;
+}
+
+/**
+ * @brief Puts the node record into the hash index, node must not be indexed yet
+ */
+static void index_insert(ls_gate_devices_t *devlist, ls_addr_t addr) {
+	uint32_t pos = index_hash(devlist->nodes[addr].node_id);
+
+	/* Index is larger than the list, so there's always a free slot */
+	while (devlist->nodes_index[pos] != LS_GATE_INDEX_EMPTY) {
+		pos = (pos + 1) & LS_GATE_INDEX_MASK;
+	}
+
+	devlist->nodes_index[pos] = addr + 1;
+}
+
+/**
+ * @brief Removes the node record from the hash index.
+ *
+ * Entries following the removed one are shifted back so that lookups never need tombstones.
+ */
+static void index_remove(ls_gate_devices_t *devlist, ls_addr_t addr) {
+	int found = index_find(devlist, devlist->nodes[addr].node_id);
+	if (found < 0) {
+		return;
+	}
+
+	uint32_t hole = found;
+	uint32_t pos = hole;
+
+	devlist->nodes_index[hole] = LS_GATE_INDEX_EMPTY;
+
+	while (1) {
+		pos = (pos + 1) & LS_GATE_INDEX_MASK;
+
+		uint16_t entry = devlist->nodes_index[pos];
+		if (entry == LS_GATE_INDEX_EMPTY) {
+			break;
+		}
+
+		/* Move the entry into the hole unless its home slot lies cyclically in (hole, pos] */
+		uint32_t home = index_hash(devlist->nodes[entry - 1].node_id);
+		if (((pos - home) & LS_GATE_INDEX_MASK) >= ((pos - hole) & LS_GATE_INDEX_MASK)) {
+			devlist->nodes_index[hole] = entry;
+			devlist->nodes_index[pos] = LS_GATE_INDEX_EMPTY;
+			hole = pos;
+		}
+	}
+}
+
+/**
+ * @brief Checks if the node is in the activity list
+ */
+static inline bool lru_linked(ls_gate_devices_t *devlist, ls_addr_t addr) {
+	return devlist->lru_prev[addr] != LS_GATE_LRU_NONE || devlist->lru_head == addr;
+}
+
+/**
+ * @brief Removes the node from the activity list, devlist must be locked
+ */
+static void lru_unlink(ls_gate_devices_t *devlist, ls_addr_t addr) {
+	if (!lru_linked(devlist, addr)) {
+		return;
+	}
+
+	uint16_t prev = devlist->lru_prev[addr];
+	uint16_t next = devlist->lru_next[addr];
+
+	if (prev != LS_GATE_LRU_NONE) {
+		devlist->lru_next[prev] = next;
+	} else {
+		devlist->lru_head = next;
+	}
+
+	if (next != LS_GATE_LRU_NONE) {
+		devlist->lru_prev[next] = prev;
+	} else {
+		devlist->lru_tail = prev;
+	}
+
+	devlist->lru_prev[addr] = devlist->lru_next[addr] = LS_GATE_LRU_NONE;
+}
+
+/**
+ * @brief Appends the node to the activity list as the most recently seen one, devlist must be locked
+ */
+static void lru_append(ls_gate_devices_t *devlist, ls_addr_t addr) {
+	devlist->lru_prev[addr] = devlist->lru_tail;
+	devlist->lru_next[addr] = LS_GATE_LRU_NONE;
+
+	if (devlist->lru_tail != LS_GATE_LRU_NONE) {
+		devlist->lru_next[devlist->lru_tail] = addr;
+	} else {
+		devlist->lru_head = addr;
+	}
+
+	devlist->lru_tail = addr;
+}
+
+static inline ls_gate_session_t *session_slot(ls_gate_devices_t *devlist, ls_addr_t addr) {
+	return &devlist->sessions[addr & (LS_GATE_SESSION_CACHE_SIZE - 1)];
+}
+
+/**
+ * @brief Drops cached session keys of the node, devlist must be locked
+ */
+static void invalidate_session(ls_gate_devices_t *devlist, ls_addr_t addr) {
+	ls_gate_session_t *session = session_slot(devlist, addr);
+
+	if (session->addr == addr) {
+		session->addr = LS_ADDR_UNDEFINED;
+	}
+}
+
+/**
+ * @brief Folds device nonce into the 16-bit fingerprint stored in the nonce ring
+ */
+static inline uint16_t nonce_fingerprint(uint32_t nonce) {
+	uint16_t fp = (uint16_t) (nonce ^ (nonce >> 16));
+
+	/* Zero marks empty ring cell */
+	return (fp != 0) ? fp : 1;
+}
+
 /**
  * @brief Clears tracked nonces list
  */
@@ -70,40 +242,104 @@ static void clear_nonce_list(ls_gate_devices_t *devlist, ls_addr_t addr) {
 
 	ls_gate_node_t *node = &devlist->nodes[addr];
     
-    memset((void *)node->nonce, 0, sizeof(ls_nonce_t) * LS_GATE_NONCES_PER_DEVICE);
-	node->num_nonces = 0;
+    memset((void *)node->nonces, 0, sizeof(node->nonces));
+	node->nonces_head = 0;
+	node->dev_nonce = 0;
     
     DEBUG("ls-gate-device-list: nonce list cleared\n");
 }
 
+/**
+ * @brief Makes nonce current for the node and remembers it, the oldest remembered nonce is forgotten
+ */
+static void push_nonce(ls_gate_node_t *node, uint32_t nonce) {
+	node->nonces[node->nonces_head] = nonce_fingerprint(nonce);
+	node->nonces_head = (node->nonces_head + 1) % LS_GATE_NONCES_PER_DEVICE;
+
+	node->dev_nonce = nonce;
+
+	DEBUG("ls-gate-device-list: nonce successfully added\n");
+}
+
 ls_gate_node_t *add_nonce(ls_gate_devices_t *devlist, uint64_t node_id, uint32_t nonce) {
     DEBUG("ls-gate-device-list: adding nonce\n");
-	/* Look for a free cell (and address) to insert */
-	for (uint32_t i = 0; i < LS_GATE_MAX_NODES; i++) {
-		if (!devlist->nodes_free_list[i]) {
-			ls_gate_node_t *node = &devlist->nodes[i];
-
-			if (node->node_id == node_id) {
-				/* Clear nonces list if it's full */
-				if (node->num_nonces == LS_GATE_NONCES_PER_DEVICE) {
-					clear_nonce_list(devlist, i);
-				}
-
-				/* Add current nonce to nonce list */
-                for (uint32_t j = 0; j < LS_GATE_NONCES_PER_DEVICE; j++) {
-                    if (node->nonce[j] == 0) {
-                        node->nonce[j] = nonce;
-                        node->num_nonces++;
-                        DEBUG("ls-gate-device-list: nonce successfully added\n");
-                        break;
-                    }
-                }
-                return node;
+	ls_gate_node_t *node = ls_devlist_get_by_nodeid(devlist, node_id);
+	if (node == NULL) {
+		DEBUG("ls-gate-device-list: error adding nonce\n");
+		return NULL;
+	}
+
+	/* Add current nonce to nonce list */
+	push_nonce(node, nonce);
+
+	/* Keys are derived from the last nonce */
+	ls_devlist_invalidate_session(devlist, node->addr);
+
+	return node;
+}
+
+/**
+ * @brief Returns the downlink entry to the pool
+ */
+static void dl_release(ls_gate_devices_t *devlist, uint8_t i) {
+	devlist->downlinks[i].owner = LS_GATE_DL_NO_OWNER;
+	devlist->downlinks[i].next = devlist->dl_free;
+	devlist->dl_free = i;
+}
+
+/**
+ * @brief Removes the first frame of the node's downlink queue
+ */
+static void dl_pop(ls_gate_devices_t *devlist, ls_gate_node_t *node) {
+	uint8_t i = node->dl_head;
+
+	node->dl_head = devlist->downlinks[i].next;
+	if (node->dl_head == LS_GATE_DL_NONE) {
+		node->dl_tail = LS_GATE_DL_NONE;
+	}
+
+	dl_release(devlist, i);
+}
+
+static void dl_flush(ls_gate_devices_t *devlist, ls_gate_node_t *node) {
+	while (node->dl_head != LS_GATE_DL_NONE) {
+		dl_pop(devlist, node);
+	}
+}
+
+static inline bool dl_expired(ls_gate_dl_entry_t *e, uint32_t now) {
+	return (int32_t) (now - e->expires) >= 0;
+}
+
+/**
+ * @brief Removes expired frames from the node's downlink queue keeping the order of the rest
+ */
+static void dl_drop_expired(ls_gate_devices_t *devlist, ls_gate_node_t *node, uint32_t now) {
+	uint8_t i = node->dl_head;
+
+	node->dl_head = node->dl_tail = LS_GATE_DL_NONE;
+
+	while (i != LS_GATE_DL_NONE) {
+		ls_gate_dl_entry_t *e = &devlist->downlinks[i];
+		uint8_t next = e->next;
+
+		if (dl_expired(e, now)) {
+			DEBUG("ls-gate-device-list: downlink to 0x%08X expired\n", (unsigned) node->addr);
+			dl_release(devlist, i);
+		}
+		else {
+			e->next = LS_GATE_DL_NONE;
+			if (node->dl_head == LS_GATE_DL_NONE) {
+				node->dl_head = i;
+			}
+			else {
+				devlist->downlinks[node->dl_tail].next = i;
 			}
+			node->dl_tail = i;
 		}
+
+		i = next;
 	}
-    DEBUG("ls-gate-device-list: error adding nonce\n");
-	return NULL;
 }
 
 static void init_node(ls_gate_devices_t *devlist, ls_gate_node_t *node, ls_addr_t addr, uint64_t node_id, uint64_t app_id, uint32_t nonce, void *ch) {
@@ -115,21 +351,21 @@ static void init_node(ls_gate_devices_t *devlist, ls_gate_node_t *node, ls_addr_
 	node->addr = addr;
 	node->is_static = false;
 
-	/* Clear nonces list if it's full */
-	if (node->num_nonces >= LS_GATE_NONCES_PER_DEVICE) {
-		DEBUG("ls-gate-device-list: clear nonce list");
-		clear_nonce_list(devlist, addr);
-	}
+	/* Keys of the previous record owner are no longer valid */
+	invalidate_session(devlist, addr);
+
+	/* New session, no frames received yet */
+	ls_devlist_reset_fid(node);
+
+	/* Nothing to send, record was free */
+	node->dl_head = node->dl_tail = LS_GATE_DL_NONE;
+	node->rx_deadline = 0;
+
+	/* Link of the previous record owner tells nothing about this node */
+	memset(&node->adr, 0, sizeof(node->adr));
 
 	/* Append nonce to the nonce list */
-    for (uint32_t j = 0; j < LS_GATE_NONCES_PER_DEVICE; j++) {
-        if (node->nonce[j] == 0) {
-            node->nonce[j] = nonce;
-            node->num_nonces++;
-            DEBUG("ls-gate-device-list: nonce successfully added\n");
-            break;
-        }
-    }
+	push_nonce(node, nonce);
     
     DEBUG("ls-gate-device-list: node initialized\n");
 }
@@ -154,31 +390,29 @@ ls_gate_node_t *ls_devlist_add_by_addr(ls_gate_devices_t *devlist, ls_addr_t add
     }
 
 	/* This network address is occupied */
-	if (!devlist->nodes_free_list[addr]) {
+	if (bf_isset(devlist->nodes_used, addr)) {
         DEBUG("ls-gate-device-list: network address already occupied\n");
 		return NULL;
     }
 
-	mutex_lock(&devlist->mutex);
+	mutex_pi_lock(&devlist->mutex);
 
 	/* Occupy node record */
-	devlist->nodes_free_list[addr] = false;
+	bf_set(devlist->nodes_used, addr);
 
 	/* Fill node record */
 	ls_gate_node_t *node = &devlist->nodes[addr];
+	clear_nonce_list(devlist, addr);
 	init_node(devlist, node, addr, node_id, app_id, nonce, ch);
+	index_insert(devlist, addr);
 
-	node->last_fid = 255;
 	node->app_nonce = 0;
 	node->is_static = true;
 
-	node->num_nonces = 1;
-	node->nonce[0] = nonce;
-
 	/* Increase number of connected devices */
 	devlist->num_nodes++;
 
-	mutex_unlock(&devlist->mutex);
+	mutex_pi_unlock(&devlist->mutex);
     DEBUG("ls-gate-device-list: device successfully added\n");
 	return node;
 }
@@ -197,57 +431,45 @@ ls_gate_node_t *ls_devlist_add(ls_gate_devices_t *devlist, uint64_t node_id, uin
 		return NULL;
     }
 
-	mutex_lock(&devlist->mutex);
+	mutex_pi_lock(&devlist->mutex);
 
-	/* Look for a free cell (and address) to insert */
-	for (uint32_t i = 0; i < LS_GATE_MAX_NODES; i++) {
-		if (devlist->nodes_free_list[i]) {
-			/* Occupy node record */
-			devlist->nodes_free_list[i] = false;
-
-			/* Fill node record */
-			ls_gate_node_t *node = &devlist->nodes[i];
-			init_node(devlist, node, i, node_id, app_id, nonce, ch);
+	/* Look for a free cell (and address) to insert, occupying it */
+	int i = bf_get_unset(devlist->nodes_used, LS_GATE_MAX_NODES);
+	if (i < 0) {
+		mutex_pi_unlock(&devlist->mutex);
+		DEBUG("ls-gate-device-list: error adding device\n");
+		return NULL;
+	}
 
-			/* Increase number of connected devices */
-			devlist->num_nodes++;
+	/* Fill node record */
+	ls_gate_node_t *node = &devlist->nodes[i];
+	init_node(devlist, node, i, node_id, app_id, nonce, ch);
+	index_insert(devlist, i);
 
-			/* Free lock */
-			mutex_unlock(&devlist->mutex);
+	/* Increase number of connected devices */
+	devlist->num_nodes++;
 
-			/* Return pointer to the node in the list */
-            DEBUG("ls-gate-device-list: device successfully added\n");
-			return node;
-		}
-	}
+	/* Free lock */
+	mutex_pi_unlock(&devlist->mutex);
 
-	mutex_unlock(&devlist->mutex);
-    DEBUG("ls-gate-device-list: error adding device\n");
-	return NULL;
+	/* Return pointer to the node in the list */
+	DEBUG("ls-gate-device-list: device successfully added\n");
+	return node;
 }
 
 bool ls_devlist_check_nonce(ls_gate_devices_t *devlist, uint64_t node_id, uint32_t nonce) {
     DEBUG("ls-gate-device-list: checking nonce for the device\n");
-	for (uint32_t i = 0; i < LS_GATE_MAX_NODES; i++) {
-		if (devlist->nodes_free_list[i])
-			continue;
-
-		ls_gate_node_t *node = &devlist->nodes[i];
-
-		if (node->node_id == node_id) {
-			/* Iterate through remembered nonce list */
-            for (uint32_t k = 0; k < LS_GATE_NONCES_PER_DEVICE; k++) {
-                if (node->nonce[k] == 0) {
-                    DEBUG("ls-gate-device-list: end of nonce list\n");
-                    break;
-                }
-                
-                if (node->nonce[k] == nonce) {
-                    DEBUG("ls-gate-device-list: nonce value was used before\n");
-					return false;
-                }
-            }
-            break;
+	ls_gate_node_t *node = ls_devlist_get_by_nodeid(devlist, node_id);
+
+	if (node != NULL) {
+		uint16_t fp = nonce_fingerprint(nonce);
+
+		/* Iterate through remembered nonce fingerprints */
+		for (uint32_t k = 0; k < LS_GATE_NONCES_PER_DEVICE; k++) {
+			if (node->nonces[k] == fp) {
+				DEBUG("ls-gate-device-list: nonce value was used before\n");
+				return false;
+			}
 		}
 	}
     DEBUG("ls-gate-device-list: nonce checked, is ok\n");
@@ -256,17 +478,9 @@ bool ls_devlist_check_nonce(ls_gate_devices_t *devlist, uint64_t node_id, uint32
 
 bool ls_devlist_is_added(ls_gate_devices_t *devlist, uint64_t node_id) {
     DEBUG("ls-gate-device-list: check if device is in the list\n");
-	for (uint32_t i = 0; i < LS_GATE_MAX_NODES; i++) {
-		/* Skip free cells */
-		if (devlist->nodes_free_list[i])
-			continue;
-
-		ls_gate_node_t *node = &devlist->nodes[i];
-
-		if (node->node_id == node_id) {
-            DEBUG("ls-gate-device-list: device found\n");
-			return true;
-        }
+	if (index_find(devlist, node_id) >= 0) {
+		DEBUG("ls-gate-device-list: device found\n");
+		return true;
 	}
     DEBUG("ls-gate-device-list: device not found\n");
 	return false;
@@ -280,14 +494,14 @@ bool ls_devlist_is_in_network(ls_gate_devices_t *devlist, ls_addr_t addr) {
     }
     
 #if ENABLE_DEBUG
-    if (!devlist->nodes_free_list[addr]) {
+    if (bf_isset(devlist->nodes_used, addr)) {
         DEBUG("ls-gate-device-list: device is in the list\n");
     } else {
         DEBUG("ls-gate-device-list: device is not in the list\n");
     }
 #endif
 
-	return !devlist->nodes_free_list[addr];
+	return bf_isset(devlist->nodes_used, addr);
 }
 
 bool ls_devlist_remove_device(ls_gate_devices_t *devlist, ls_addr_t addr) {
@@ -297,23 +511,29 @@ bool ls_devlist_remove_device(ls_gate_devices_t *devlist, ls_addr_t addr) {
 		return false;
     }
 
-	if (devlist->nodes_free_list[addr]) {
+	if (!bf_isset(devlist->nodes_used, addr)) {
         DEBUG("ls-gate-device-list: device already removed\n");
 		return false;
     }
 
-	mutex_lock(&devlist->mutex);
+	mutex_pi_lock(&devlist->mutex);
 
 	/* Remove all tracked nonces from memory */
 	clear_nonce_list(devlist, addr);
 
-	/* Mark cell as free */
-	devlist->nodes_free_list[addr] = true;
+	/* Frames queued for the node won't be delivered */
+	dl_flush(devlist, &devlist->nodes[addr]);
+
+	/* Drop node ID from the index and mark cell as free */
+	lru_unlink(devlist, addr);
+	index_remove(devlist, addr);
+	bf_unset(devlist->nodes_used, addr);
+	invalidate_session(devlist, addr);
 
 	/* Decrease counter */
 	devlist->num_nodes--;
 
-	mutex_unlock(&devlist->mutex);
+	mutex_pi_unlock(&devlist->mutex);
     
     DEBUG("ls-gate-device-list: device removed\n");
 
@@ -324,19 +544,46 @@ bool ls_devlist_is_full(ls_gate_devices_t *devlist) {
 	return (devlist->num_nodes >= LS_GATE_MAX_NODES);
 }
 
-ls_gate_node_t *ls_devlist_get_by_nodeid(ls_gate_devices_t *devlist, uint64_t nodeid) {
-	for (uint32_t i = 0; i < LS_GATE_MAX_NODES; i++) {
-		/* Skip free cells */
-		if (devlist->nodes_free_list[i])
-			continue;
+/**
+ * @brief Updates node's last activity time and moves it to the end of the activity list.
+ *
+ * Static nodes are never kicked for idle, so they're kept out of the list.
+ * Time must not decrease between calls, so the list stays ordered by the last activity.
+ */
+void ls_devlist_touch(ls_gate_devices_t *devlist, ls_gate_node_t *node, uint32_t now) {
+	mutex_pi_lock(&devlist->mutex);
 
-		ls_gate_node_t *node = &devlist->nodes[i];
+	node->last_seen = now;
 
-		if (node->node_id == nodeid)
-			return &devlist->nodes[i];
+	if (!node->is_static) {
+		lru_unlink(devlist, node->addr);
+		lru_append(devlist, node->addr);
 	}
 
-	return NULL;
+	mutex_pi_unlock(&devlist->mutex);
+}
+
+/**
+ * @brief Returns the non-static node with the oldest activity time, NULL if there's none
+ */
+ls_gate_node_t *ls_devlist_least_recent(ls_gate_devices_t *devlist) {
+	mutex_pi_lock(&devlist->mutex);
+	uint16_t head = devlist->lru_head;
+	mutex_pi_unlock(&devlist->mutex);
+
+	if (head == LS_GATE_LRU_NONE) {
+		return NULL;
+	}
+
+	return &devlist->nodes[head];
+}
+
+ls_gate_node_t *ls_devlist_get_by_nodeid(ls_gate_devices_t *devlist, uint64_t nodeid) {
+	int pos = index_find(devlist, nodeid);
+	if (pos < 0)
+		return NULL;
+
+	return &devlist->nodes[devlist->nodes_index[pos] - 1];
 }
 
 ls_gate_node_t *ls_devlist_get(ls_gate_devices_t *devlist, ls_addr_t addr) {
@@ -349,6 +596,181 @@ ls_gate_node_t *ls_devlist_get(ls_gate_devices_t *devlist, ls_addr_t addr) {
 	return &devlist->nodes[addr];
 }
 
+/**
+ * @brief Forgets all received frame IDs of the node
+ */
+void ls_devlist_reset_fid(ls_gate_node_t *node) {
+	node->fids.top = 0;
+	node->fids.bitmap = 0;
+}
+
+/**
+ * @brief Checks frame ID against the node's anti-replay window and marks it as received.
+ *
+ * Frame IDs are compared modulo 2^16, so the window keeps working when the counter wraps around.
+ *
+ * @return true if frame ID wasn't received before and isn't too old, false otherwise
+ */
+bool ls_devlist_accept_fid(ls_gate_node_t *node, ls_frame_id_t fid) {
+	ls_gate_fid_window_t *w = &node->fids;
+
+	/* First frame in the session */
+	if (w->bitmap == 0) {
+		w->top = fid;
+		w->bitmap = 1;
+		return true;
+	}
+
+	ls_frame_id_t ahead = (ls_frame_id_t) (fid - w->top);
+
+	/* Frame ID is newer than everything received, slide the window */
+	if (ahead != 0 && ahead < (1 << (8 * sizeof(ls_frame_id_t) - 1))) {
+		w->bitmap = (ahead < LS_GATE_FID_WINDOW_SIZE) ? ((w->bitmap << ahead) | 1) : 1;
+		w->top = fid;
+		return true;
+	}
+
+	ls_frame_id_t behind = (ls_frame_id_t) (w->top - fid);
+
+	if (behind >= LS_GATE_FID_WINDOW_SIZE) {
+		DEBUG("ls-gate-device-list: frame ID is too old\n");
+		return false;
+	}
+
+	if (w->bitmap & (1UL << behind)) {
+		DEBUG("ls-gate-device-list: frame ID duplicated\n");
+		return false;
+	}
+
+	w->bitmap |= (1UL << behind);
+	return true;
+}
+
+/**
+ * @brief Copies session keys of the node, deriving them if they aren't cached yet
+ */
+void ls_devlist_get_session(ls_gate_devices_t *devlist, ls_gate_node_t *node, ls_gate_session_t *session) {
+	mutex_pi_lock(&devlist->mutex);
+
+	ls_gate_session_t *cached = session_slot(devlist, node->addr);
+
+	if (cached->addr != node->addr) {
+		DEBUG("ls-gate-device-list: deriving session keys\n");
+		uint8_t mic_key[AES_BLOCK_SIZE];
+
+		ls_derive_keys(node->dev_nonce, node->app_nonce, node->addr, mic_key, cached->aes_key);
+		ls_mic_ctx_init(&cached->mic_ctx, mic_key);
+
+		cached->addr = node->addr;
+	}
+
+	memcpy(session, cached, sizeof(ls_gate_session_t));
+
+	mutex_pi_unlock(&devlist->mutex);
+}
+
+/**
+ * @brief Drops cached session keys of the node, must be called whenever nonces the keys are derived from change
+ */
+void ls_devlist_invalidate_session(ls_gate_devices_t *devlist, ls_addr_t addr) {
+	mutex_pi_lock(&devlist->mutex);
+	invalidate_session(devlist, addr);
+	mutex_pi_unlock(&devlist->mutex);
+}
+
+/**
+ * @brief Appends the frame to the node's downlink queue, it's sent in reply to the node's uplinks.
+ *
+ * Expired frames of all nodes are reclaimed if the pool is exhausted.
+ */
+bool ls_devlist_dl_push(ls_gate_devices_t *devlist, ls_gate_node_t *node, const uint8_t *buf, size_t len, uint32_t now, uint32_t expires) {
+	if (len > LS_GATE_DL_DATA_SIZE) {
+		DEBUG("ls-gate-device-list: downlink is too long\n");
+		return false;
+	}
+
+	mutex_pi_lock(&devlist->mutex);
+
+	if (devlist->dl_free == LS_GATE_DL_NONE) {
+		for (int i = 0; i < LS_GATE_DL_POOL_SIZE; i++) {
+			ls_gate_dl_entry_t *e = &devlist->downlinks[i];
+			if (e->owner != LS_GATE_DL_NO_OWNER && dl_expired(e, now)) {
+				dl_drop_expired(devlist, &devlist->nodes[e->owner], now);
+			}
+		}
+	}
+
+	uint8_t i = devlist->dl_free;
+	if (i == LS_GATE_DL_NONE) {
+		mutex_pi_unlock(&devlist->mutex);
+		DEBUG("ls-gate-device-list: downlink pool is exhausted\n");
+		return false;
+	}
+
+	ls_gate_dl_entry_t *e = &devlist->downlinks[i];
+	devlist->dl_free = e->next;
+
+	e->owner = node->addr;
+	e->expires = expires;
+	e->next = LS_GATE_DL_NONE;
+	e->len = len;
+	memcpy(e->data, buf, len);
+
+	if (node->dl_head == LS_GATE_DL_NONE) {
+		node->dl_head = i;
+	}
+	else {
+		devlist->downlinks[node->dl_tail].next = i;
+	}
+	node->dl_tail = i;
+
+	mutex_pi_unlock(&devlist->mutex);
+
+	return true;
+}
+
+/**
+ * @brief Copies the frame to send in the node's receive window.
+ *
+ * The frame stays in the queue until ls_devlist_dl_sent() is called, expired frames are dropped.
+ *
+ * @return false if there's nothing to send
+ */
+bool ls_devlist_dl_next(ls_gate_devices_t *devlist, ls_gate_node_t *node, uint32_t now, uint8_t *buf, size_t *len) {
+	mutex_pi_lock(&devlist->mutex);
+
+	dl_drop_expired(devlist, node, now);
+
+	if (node->dl_head == LS_GATE_DL_NONE) {
+		mutex_pi_unlock(&devlist->mutex);
+		return false;
+	}
+
+	ls_gate_dl_entry_t *e = &devlist->downlinks[node->dl_head];
+
+	memcpy(buf, e->data, e->len);
+	*len = e->len;
+
+	mutex_pi_unlock(&devlist->mutex);
+
+	return true;
+}
+
+/**
+ * @brief Removes the frame taken by ls_devlist_dl_next() once it's handed to the node's receive window.
+ *
+ * Node acknowledges the data only if its application asks to, so the frame is never sent twice.
+ */
+void ls_devlist_dl_sent(ls_gate_devices_t *devlist, ls_gate_node_t *node) {
+	mutex_pi_lock(&devlist->mutex);
+
+	if (node->dl_head != LS_GATE_DL_NONE) {
+		dl_pop(devlist, node);
+	}
+
+	mutex_pi_unlock(&devlist->mutex);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -44,22 +44,26 @@ extern "C" {
 #include "ls-mac-types.h"
 #include "ls-mac.h"
 #include "ls-gate.h"
+#include "ls-gate-adr.h"
 
 #include "rtctimers-millis.h"
 
 #include <stdint.h>
 
+#ifndef LS_GATE_EVENT_LOOP
 #define SX127X_LORA_MSG_QUEUE   (16U)
 #define SX127X_STACKSIZE        (2*THREAD_STACKSIZE_DEFAULT)
 #define MSG_TYPE_ISR            (0x3456)
 static char isr_stack[SX127X_STACKSIZE];
 static kernel_pid_t isr_pid;
+#endif
 
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
+#ifndef LS_GATE_EVENT_LOOP
 static msg_t msg_ping;
-static msg_t msg_rx1_expired;
+#endif
 
 static void schedule_tx(ls_gate_channel_t *ch) {
 	/* Can send next frame only if channel is doing nothing */
@@ -68,10 +72,14 @@ static void schedule_tx(ls_gate_channel_t *ch) {
 		return;
 	}
 
+#ifdef LS_GATE_EVENT_LOOP
+	event_post(&((ls_gate_t *)ch->_internal.gate)->_internal.queue, &ch->_internal.ev_tx.super);
+#else
 	msg_t msg;
 	msg.content.ptr = (void *) ch;
 
 	msg_try_send(&msg, ((ls_gate_t *)ch->_internal.gate)->_internal.uq_thread_pid);
+#endif
 }
 
 static void prepare_sx127x(ls_gate_channel_t *ch)
@@ -93,9 +101,7 @@ static int send_frame_f(ls_gate_channel_t *ch, ls_frame_t *frame)
 
     /* The JOIN_ACK frame must be encrypted with the special join key */
     ls_gate_node_t *node;
-
-    uint8_t mic_key[AES_BLOCK_SIZE];
-    uint8_t aes_key[AES_BLOCK_SIZE];
+    ls_gate_session_t session;
 
     switch (frame->header.type) {
         case LS_DL_JOIN_ACK:
@@ -104,18 +110,18 @@ static int send_frame_f(ls_gate_channel_t *ch, ls_frame_t *frame)
             ls_encrypt_frame(ls->settings.join_key, ls->settings.join_key, frame, &payload_size);
             break;
 
-        case LS_DL_ACK:
-            node = ls_devlist_get(&ls->devices, frame->header.dev_addr);
-
-            ls_derive_keys(node->nonce[node->num_nonces - 1], node->app_nonce, node->addr, mic_key, NULL);
-            ls_encrypt_frame(mic_key, mic_key, frame, &payload_size);
-            break;
-
         default:
             node = ls_devlist_get(&ls->devices, frame->header.dev_addr);
+            if (node == NULL) {
+                DEBUG("ls-gate: node left the network, frame dropped\n");
+                return -LS_GATE_E_NODEV;
+            }
 
-            ls_derive_keys(node->nonce[node->num_nonces - 1], node->app_nonce, node->addr, mic_key, aes_key);
-            ls_encrypt_frame(mic_key, aes_key, frame, &payload_size);
+            /* Pending ADR command goes with any frame to the node, status byte is covered by MIC */
+            frame->header.status = ls_gate_adr_command(ls, node);
+
+            ls_devlist_get_session(&ls->devices, node, &session);
+            ls_encrypt_frame_ctx(&session.mic_ctx, session.aes_key, frame, &payload_size);
     }
     
     /* REG_LR_MODEMSTAT doesn't seems to work properly
@@ -158,8 +164,38 @@ static int send_frame_f(ls_gate_channel_t *ch, ls_frame_t *frame)
     return LS_GATE_OK;
 }
 
+/**
+ * @brief Checks if frame is a reply to the node's uplink.
+ *
+ * Node listens for the reply only for a short time after the uplink, so
+ * replies are sent ahead of the bulk downlink.
+ */
+static inline bool is_reply(ls_type_t type) {
+    switch (type) {
+        case LS_DL_ACK:
+        case LS_DL_ACK_W_DATA:
+        case LS_DL_JOIN_ACK:
+        case LS_DL_TIME_ACK:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Enqueues the assembled frame for transmission on the channel.
+ *
+ * @return false if the channel queue is full
+ */
 static bool enqueue_frame_f(ls_gate_channel_t *ch, ls_frame_t *frame) {
-	bool res = !ls_frame_fifo_push(&ch->_internal.ul_fifo, frame);
+	/* The latest reply goes first as its node's receive window is the one still open */
+	bool res;
+	if (is_reply(frame->header.type)) {
+		res = ls_frame_fifo_push_front(&ch->_internal.ul_fifo, frame);
+	} else {
+		res = ls_frame_fifo_push(&ch->_internal.ul_fifo, frame);
+	}
 
 	schedule_tx(ch);
     
@@ -168,6 +204,11 @@ static bool enqueue_frame_f(ls_gate_channel_t *ch, ls_frame_t *frame) {
 	return res;
 }
 
+/**
+ * @brief Assembles the frame and enqueues it for transmission on the channel.
+ *
+ * @return false if the channel queue is full
+ */
 static bool enqueue_frame(ls_gate_channel_t *ch, ls_addr_t to, ls_type_t type, uint8_t *buf, size_t buflen) {
     ls_frame_t *frame = &ch->_internal.current_frame;
     ls_assemble_frame(to, type, buf, buflen, frame);
@@ -175,10 +216,47 @@ static bool enqueue_frame(ls_gate_channel_t *ch, ls_addr_t to, ls_type_t type, u
     return enqueue_frame_f(ch, frame);
 }
 
+/**
+ * @brief Enqueues the frame of any type into the receive window the node's uplink has just opened.
+ *
+ * @return false if the channel queue is full
+ */
+static bool enqueue_reply(ls_gate_channel_t *ch, ls_addr_t to, ls_type_t type, uint8_t *buf, size_t buflen) {
+    ls_frame_t *frame = &ch->_internal.current_frame;
+    ls_assemble_frame(to, type, buf, buflen, frame);
+
+    bool res = ls_frame_fifo_push_front(&ch->_internal.ul_fifo, frame);
+    schedule_tx(ch);
+
+    return res;
+}
+
+/**
+ * @brief Checks if the class A node stopped listening for the frame.
+ */
+static bool rx_window_closed(ls_gate_t *ls, ls_frame_t *frame) {
+    if (frame->header.dev_addr == LS_ADDR_UNDEFINED) {
+        return false;
+    }
+
+    ls_gate_node_t *node = ls_devlist_get(&ls->devices, frame->header.dev_addr);
+    if (node == NULL || node->node_class != LS_ED_CLASS_A) {
+        return false;
+    }
+
+    return xtimer_now_usec64() > node->rx_deadline;
+}
+
 static inline void close_rx_windows(ls_gate_channel_t *ch) {
+#ifdef LS_GATE_EVENT_LOOP
+	event_timeout_clear(&ch->_internal.rx_window1);
+	event_cancel(&((ls_gate_t *)ch->_internal.gate)->_internal.queue, &ch->_internal.ev_rx1.super);
+#else
 	xtimer_remove(&ch->_internal.rx_window1);
+#endif
     DEBUG("ls-gate: state = IDLE");
 	ch->state = LS_GATE_CHANNEL_STATE_IDLE;
+	ch->_internal.rx_window_addr = LS_ADDR_UNDEFINED;
     
     DEBUG("ls-gate: RX window closed\n");
 
@@ -188,8 +266,11 @@ static inline void close_rx_windows(ls_gate_channel_t *ch) {
 
 static inline void open_rx_windows(ls_gate_channel_t *ch) {
 	/* Launch RX window timeout timer */
-	msg_rx1_expired.content.ptr = (void *) ch;
-	xtimer_set_msg(&ch->_internal.rx_window1, LS_GATE_RX1_LENGTH, &msg_rx1_expired, ((ls_gate_t *)ch->_internal.gate)->_internal.tim_thread_pid);
+#ifdef LS_GATE_EVENT_LOOP
+	event_timeout_set(&ch->_internal.rx_window1, LS_GATE_RX1_LENGTH);
+#else
+	xtimer_set_msg(&ch->_internal.rx_window1, LS_GATE_RX1_LENGTH, &ch->_internal.rx1_msg, ((ls_gate_t *)ch->_internal.gate)->_internal.tim_thread_pid);
+#endif
 
 	/* Switch transceiver to RX mode */
 	prepare_sx127x(ch);
@@ -200,10 +281,23 @@ static inline void open_rx_windows(ls_gate_channel_t *ch) {
     //mutex_lock(&ch->_internal.channel_mutex);
     DEBUG("ls-gate: state = RX");
     ch->state = LS_GATE_CHANNEL_STATE_RX;
+    ch->_internal.rx_window_addr = ch->_internal.tx_addr;
 
 	DEBUG("ls-gate: rx1 window opened\n");
 }
 
+/**
+ * @brief Returns channel to IDLE state and sends frames that were waiting for it.
+ */
+static inline void release_channel(ls_gate_channel_t *ch) {
+    DEBUG("ls-gate: state = IDLE\n");
+    ch->state = LS_GATE_CHANNEL_STATE_IDLE;
+
+    if (!ls_frame_fifo_empty(&ch->_internal.ul_fifo)) {
+        schedule_tx(ch);
+    }
+}
+
 static inline void send_join_ack(ls_gate_t *ls, ls_gate_channel_t *ch, uint64_t dev_id, ls_addr_t addr, uint32_t app_nonce)
 {
     (void)ls;
@@ -220,6 +314,73 @@ static inline void send_ack(ls_gate_t *ls, ls_gate_channel_t *ch, ls_addr_t addr
 	enqueue_frame(ch, addr, LS_DL_ACK, NULL, 0);
 }
 
+/**
+ * @brief Sends an empty downlink to deliver the ADR command after the unconfirmed uplink.
+ */
+static inline void send_adr_command(ls_gate_t *ls, ls_gate_channel_t *ch, ls_addr_t addr)
+{
+    (void)ls;
+
+    enqueue_reply(ch, addr, LS_DL, NULL, 0);
+}
+
+/**
+ * @brief Sends the next frame of the node's downlink queue into the receive window opened by the uplink.
+ *
+ * @return true if there was a frame to send
+ */
+static bool send_queued(ls_gate_t *ls, ls_gate_channel_t *ch, ls_gate_node_t *node, ls_type_t type)
+{
+    uint8_t buf[LS_GATE_DL_DATA_SIZE];
+    size_t len;
+
+    if (!ls_devlist_dl_next(&ls->devices, node, ls->_internal.ping_count, buf, &len)) {
+        return false;
+    }
+
+    /* Frame stays queued for the next uplink if the channel can't take it now */
+    if (!enqueue_reply(ch, node->addr, type, buf, len)) {
+        DEBUG("ls-gate: channel queue is full, downlink to 0x%08X requeued\n", (unsigned) node->addr);
+        return false;
+    }
+
+    DEBUG("ls-gate: queued downlink sent to 0x%08X\n", (unsigned) node->addr);
+    ls_devlist_dl_sent(&ls->devices, node);
+
+    return true;
+}
+
+/**
+ * @brief Takes the node's channel, receive window and link quality from the uplink with the new frame ID.
+ *
+ * Replayed frames are left out, so a recorded frame can't move the node's
+ * channel or feed its old link quality into ADR.
+ */
+static void node_uplink(ls_gate_t *ls, ls_gate_channel_t *ch, ls_gate_node_t *node, ls_frame_t *frame)
+{
+    /* Replies go to the channel the node is heard on */
+    node->node_ch = ch;
+    node->rx_deadline = xtimer_now_usec64() + LS_GATE_RX_DEADLINE;
+
+    /* Track the link quality to adapt node's data rate and TX power */
+    ls_gate_adr_uplink(ls, ch, node, ch->last_snr, frame->header.status);
+}
+
+/**
+ * @brief Replies to the unconfirmed uplink with queued data or the ADR command, if any.
+ */
+static void reply_unconfirmed(ls_gate_t *ls, ls_gate_channel_t *ch, ls_gate_node_t *node)
+{
+    if (send_queued(ls, ch, node, LS_DL)) {
+        return;
+    }
+
+    /* Nothing is sent in reply to the unconfirmed data, ADR command needs its own frame */
+    if (ls_gate_adr_pending(node)) {
+        send_adr_command(ls, ch, node->addr);
+    }
+}
+
 static void device_join_req(ls_gate_t *ls, ls_gate_channel_t *ch, uint64_t dev_id, uint64_t app_id, uint32_t dev_nonce, ls_node_class_t node_class)
 {
     DEBUG("ls-gate: join request from %08x%08x\n", (unsigned int) (dev_id >> 32), (unsigned int) (dev_id & 0xFFFFFFFF));
@@ -259,17 +420,26 @@ static void device_join_req(ls_gate_t *ls, ls_gate_channel_t *ch, uint64_t dev_i
     /* Set node's class */
     node->node_class = node_class;
 
+    /* Node is waiting for the join ACK */
+    node->rx_deadline = xtimer_now_usec64() + LS_GATE_RX_DEADLINE;
+
     /* Update node's channel */
     node->node_ch = ch;
 
     /* Update node's last seen time */
-    node->last_seen = ls->_internal.ping_count;
+    ls_devlist_touch(devlist, node, ls->_internal.ping_count);
 
     /* Call join handler which returns an app nonce from the application side */
     node->app_nonce = ls->node_joined_cb(node);
 
-    /* Reset last frame ID counter */
-    node->last_fid = 0;
+    /* Session keys depend on the new app nonce */
+    ls_devlist_invalidate_session(devlist, node->addr);
+
+    /* Forget frame IDs of the previous session */
+    ls_devlist_reset_fid(node);
+
+    /* Node starts the session with its own data rate and TX power */
+    ls_gate_adr_reset(node);
 
     /* Send join ACK */
     DEBUG("ls-gate: send join ack\n");
@@ -286,7 +456,8 @@ static void app_data_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_gate_node_t *
 
     /* Call handler callback */
     DEBUG("ls-gate: call handler callback\n");
-    ls->app_data_received_cb(node, ch, frame->payload.data, frame->payload.len, frame->header.status);
+    ls->app_data_received_cb(node, ch, frame->payload.data, frame->payload.len,
+                             LS_NODE_STATUS(frame->header.status));
 }
 
 static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
@@ -304,21 +475,28 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
     	}
     }
 
-    /* Derive cryptographic keys */
-    uint8_t mic_key[AES_BLOCK_SIZE];
-    uint8_t aes_key[AES_BLOCK_SIZE];
+    /* Get cached session keys */
+    ls_gate_session_t session;
+    uint8_t *aes_key = session.aes_key;
+    bool fresh = false;
 
     if (node) {
         /* Update node's last seen time */
-        node->last_seen = ls->_internal.ping_count;
+        ls_devlist_touch(&ls->devices, node, ls->_internal.ping_count);
         
-        ls_derive_keys(node->nonce[node->num_nonces - 1], node->app_nonce, node->addr, mic_key, aes_key);
+        ls_devlist_get_session(&ls->devices, node, &session);
 
         /* Validate frame MIC */
-        if (!ls_validate_frame_mic(mic_key, frame)) {
+        if (!ls_validate_frame_mic_ctx(&session.mic_ctx, frame)) {
             DEBUG("ls-gate: MIC validation failed\n");
             return false;
         }
+
+        /* Frame ID is checked once, replayed frames don't update the node */
+        fresh = ls_devlist_accept_fid(node, frame->header.fid);
+        if (fresh) {
+            node_uplink(ls, ch, node, frame);
+        }
     }
 
     switch (frame->header.type) {
@@ -331,11 +509,7 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
 
             DEBUG("ls-gate: unconfirmed data with ack for previous data\n");
 
-            if (frame->header.fid >= (uint8_t) (node->last_fid + 1)) {
-            	/* Update frame ID */
-                DEBUG("ls-gate: update frame ID\n");
-            	node->last_fid = frame->header.fid;
-
+            if (fresh) {
                 /*
                  * Process as acknowledge frame
                  */
@@ -357,10 +531,12 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
     			app_data_recv(ls, ch, node, frame, aes_key);
                 DEBUG("ls-gate: data processed\n");
             } else {
-            	DEBUG("ls-gate: frame dropped: %d != %d\n", frame->header.fid, (uint8_t) (node->last_fid + 1));
+            	DEBUG("ls-gate: frame dropped: %d is replayed\n", frame->header.fid);
             	return false;
             }
 
+            reply_unconfirmed(ls, ch, node);
+
 			return true;
     	}
 
@@ -376,11 +552,7 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
             /*
              * Process acknowledge frame only if it haven't sent twice (frame ID duplicated).
              */
-            if (frame->header.fid >= (uint8_t) (node->last_fid + 1)) {
-            	/* Update frame ID */
-                DEBUG("ls-gate: update frame ID\n");
-            	node->last_fid = frame->header.fid;
-
+            if (fresh) {
                 if (ls->app_data_ack_cb != NULL) {
                     ls->app_data_ack_cb(node, ch);
                 }
@@ -393,10 +565,13 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
     				}
                 }
             } else {
-            	DEBUG("ls-gate: frame dropped: %d != %d\n", frame->header.fid, (uint8_t) (node->last_fid + 1));
+            	DEBUG("ls-gate: frame dropped: %d is replayed\n", frame->header.fid);
             	return false;
             }
 
+            /* Node listens after the ACK as well, next queued frame goes there */
+            reply_unconfirmed(ls, ch, node);
+
             return true;
         }
 
@@ -413,22 +588,24 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
              * Process received application data frame only if it wasn't sent twice (frame ID duplicated).
              * Confirmation of data reception will be sent in any case
              */
-            if ((uint8_t) frame->header.fid >= (uint8_t) (node->last_fid + 1)) {
+            if (fresh) {
             	app_data_recv(ls, ch, node, frame, aes_key);
-
-            	/* Update frame ID */
-            	node->last_fid = frame->header.fid;
             } else {
-            	DEBUG("ls-gate: frame dropped: %d != %d\n", (uint8_t) frame->header.fid, (uint8_t) (node->last_fid + 1));
+            	DEBUG("ls-gate: frame dropped: %d is replayed\n", frame->header.fid);
             	/* As intended, send confirmation of reception even if frame is dropped */
             	/*return false;*/
+
+            	/* Node retransmits when the ACK is lost, it listens for this one */
+            	node->rx_deadline = xtimer_now_usec64() + LS_GATE_RX_DEADLINE;
             }
 
             /*
-             * Plain ACK if there's no data pending for this node
+             * Queued data goes as acknowledge, plain ACK if there's no data pending for this node
              * Otherwise, ask upper level to give us a frame to send as acknowledge to the node
              */
-            if (node->num_pending == 0) {
+            if (send_queued(ls, ch, node, LS_DL_ACK_W_DATA)) {
+                DEBUG("ls-gate: ack with queued data sent to node\n");
+            } else if (node->num_pending == 0) {
                 DEBUG("ls-gate: ack sent to node\n");
             	send_ack(ls, ch, frame->header.dev_addr);
             } else {
@@ -449,6 +626,8 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
 
             app_data_recv(ls, ch, node, frame, aes_key);
 
+            reply_unconfirmed(ls, ch, node);
+
             return true;
 
         case LS_UL_JOIN_REQ: /* Join request */
@@ -515,19 +694,24 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
 
 static void sx127x_handler(netdev_t *dev, netdev_event_t event, void *arg)
 {
+    assert(arg != NULL);
+    ls_gate_channel_t *ch = (ls_gate_channel_t *)arg;
+
     if (event == NETDEV_EVENT_ISR) {
+#ifdef LS_GATE_EVENT_LOOP
+        /* Interrupt is serviced right in the gate event loop */
+        event_post(&((ls_gate_t *)ch->_internal.gate)->_internal.queue, &ch->_internal.ev_isr.super);
+#else
         msg_t msg;
         msg.type = MSG_TYPE_ISR;
         msg.content.ptr = dev;
         if (msg_send(&msg, isr_pid) <= 0) {
             puts("gnrc_netdev: possibly lost interrupt.");
         }
+#endif
         return;
     }
     
-    assert(arg != NULL);
-    ls_gate_channel_t *ch = (ls_gate_channel_t *)arg;
-    
     switch (event) {
         case NETDEV_EVENT_RX_COMPLETE: {
             int len;
@@ -554,16 +738,24 @@ static void sx127x_handler(netdev_t *dev, netdev_event_t event, void *arg)
             printf("\n");
 #endif
 
-            DEBUG("ls-gate: state = IDLE\n");
-            ch->state = LS_GATE_CHANNEL_STATE_IDLE;
-            
             ch->last_rssi = packet_info.rssi;
+            ch->last_snr = packet_info.snr;
 
             /* Copy packet's data as a frame to our stack */
             ls_frame_t *frame = (ls_frame_t *) message;
+            bool valid = ls_validate_frame(message, len);
+
+            /* RX window (if any) is served only by the node it was opened for */
+            if ((ch->_internal.rx_window_addr == LS_ADDR_UNDEFINED) ||
+                (valid && (frame->header.dev_addr == ch->_internal.rx_window_addr))) {
+                close_rx_windows(ch);
+            }
+            else {
+                DEBUG("ls-gate: frame from another node, RX window stays open\n");
+            }
 
             /* Check frame format */
-            if (ls_validate_frame(message, len)) {
+            if (valid) {
                 if (!frame_recv(ls, ch, frame)) {
                     DEBUG("ls-gate: ls-gate: well-formed frame discarded\n");
                 }
@@ -571,13 +763,17 @@ static void sx127x_handler(netdev_t *dev, netdev_event_t event, void *arg)
             else {
                 DEBUG("ls-gate: ls-gate: malformed data discarded\n");
             }
+
+            /* Send frames queued while the channel was busy */
+            if (ch->state == LS_GATE_CHANNEL_STATE_IDLE && !ls_frame_fifo_empty(&ch->_internal.ul_fifo)) {
+                schedule_tx(ch);
+            }
         }
         break;
 
         case NETDEV_EVENT_CRC_ERROR:
             DEBUG("ls-gate: CRC error\n");
-            DEBUG("ls-gate: state = IDLE\n");
-            ch->state = LS_GATE_CHANNEL_STATE_IDLE;
+            release_channel(ch);
             break;
 
         case NETDEV_EVENT_TX_COMPLETE:
@@ -588,8 +784,7 @@ static void sx127x_handler(netdev_t *dev, netdev_event_t event, void *arg)
 
         case NETDEV_EVENT_RX_TIMEOUT:
             DEBUG("ls-gate: RX timeout\n");
-            DEBUG("ls-gate: state = IDLE\n");
-            ch->state = LS_GATE_CHANNEL_STATE_IDLE;
+            release_channel(ch);
             break;
 
         case NETDEV_EVENT_TX_TIMEOUT:
@@ -598,6 +793,9 @@ static void sx127x_handler(netdev_t *dev, netdev_event_t event, void *arg)
             prepare_sx127x(ch);
             uint8_t state = NETOPT_STATE_RX;
             ch->_internal.device->driver->set(ch->_internal.device, NETOPT_STATE, &state, sizeof(uint8_t));
+
+            /* Frame is lost, don't leave the channel in TX state forever */
+            release_channel(ch);
             break;
             
         case NETDEV_EVENT_VALID_HEADER:
@@ -611,6 +809,189 @@ static void sx127x_handler(netdev_t *dev, netdev_event_t event, void *arg)
     }
 }
 
+/**
+ * @brief Sends next frame from the channel's uplink queue.
+ */
+static void send_next_frame(ls_gate_channel_t *ch)
+{
+    ls_frame_fifo_t *fifo = &ch->_internal.ul_fifo;
+
+    /* Channel may be captured since the request, frame will wait for it to be released */
+    if (ch->state != LS_GATE_CHANNEL_STATE_IDLE) {
+        return;
+    }
+
+    if (ls_frame_fifo_empty(fifo)) {
+        return;
+    }
+
+    /* Get frame from queue top */
+    ls_frame_t *f;
+    ls_frame_t frame;
+    ls_gate_t *ls = (ls_gate_t *) ch->_internal.gate;
+
+    do {
+        if (!ls_frame_fifo_pop(fifo, &frame)) {
+            return;
+        }
+
+        /* Don't waste airtime on the node which is not listening any more */
+        if (rx_window_closed(ls, &frame)) {
+            DEBUG("ls-gate: receive window of the node is closed, frame dropped\n");
+            continue;
+        }
+
+        break;
+    } while (1);
+
+    f = &frame;
+
+    /* Receive window opened after this frame waits for its node */
+    ch->_internal.tx_addr = f->header.dev_addr;
+
+	/* Update frame's FID to the last one and advance it */
+	f->header.fid = 0;
+
+    DEBUG("ls-gate: >mhdr=0x%02X, mic=0x%04X, addr=0x%02X, type=0x%02X, fid=0x%02X [%d left]\n",
+            (unsigned int) f->header.mhdr,
+            (unsigned int) f->header.mic, (unsigned int) f->header.dev_addr,
+            (unsigned int) f->header.type,
+            (unsigned int) f->header.fid,
+            ls_frame_fifo_size(fifo));
+
+    /* Send frame into LoRa PHY */
+    send_frame_f(ch, f);
+}
+
+/**
+ * @brief Increments ping counter and kicks inactive devices.
+ *
+ * Devices are ordered by the last activity, so only the expired ones are visited.
+ */
+static void ping_tick(ls_gate_t *ls)
+{
+    ls->_internal.ping_count++;
+
+	/* Kick inactive devices */
+	ls_gate_node_t *node;
+	while ((node = ls_devlist_least_recent(&ls->devices)) != NULL) {
+		uint32_t diff = ls->_internal.ping_count - node->last_seen;
+
+		if (diff < LS_MAX_PING_DIFFERENCE) {
+			break;
+		}
+
+		/* Kick node */
+        DEBUG("ls-gate: remove node from devlist");
+		ls_devlist_remove_device(&ls->devices, node->addr);
+
+		/* Notify application code about kicked node */
+		if (ls->node_kicked_cb != NULL) {
+			ls->node_kicked_cb(node);
+		}
+	}
+}
+
+/**
+ * @brief Handles expiration of the first receive window.
+ */
+static void rx1_expired(ls_gate_channel_t *ch)
+{
+	/* Window may be closed by the frame received in the meantime */
+	if (ch->state != LS_GATE_CHANNEL_STATE_RX) {
+		return;
+	}
+
+	/* RX window expired, if there are frames awaiting in queue, schedule TX operation */
+	if (!ls_frame_fifo_empty(&ch->_internal.ul_fifo)) {
+		puts("ls-gate: rx1 window expired, sending next frame from queue");
+
+		close_rx_windows(ch);
+		schedule_tx(ch);
+	} else {
+		ch->state = LS_GATE_CHANNEL_STATE_IDLE;
+		ch->_internal.rx_window_addr = LS_ADDR_UNDEFINED;
+		puts("ls-gate: rx1 window expired, staying in RX, but IDLE");
+	}
+}
+
+#ifdef LS_GATE_EVENT_LOOP
+static void init_event(ls_gate_event_t *ev, event_handler_t handler, void *arg)
+{
+    ev->super.list_node.next = NULL;
+    ev->super.handler = handler;
+    ev->arg = arg;
+}
+
+static void isr_event(event_t *event)
+{
+    ls_gate_channel_t *ch = (ls_gate_channel_t *) ((ls_gate_event_t *) event)->arg;
+    netdev_t *dev = ch->_internal.device;
+
+    dev->driver->isr(dev);
+}
+
+static void tx_event(event_t *event)
+{
+    send_next_frame((ls_gate_channel_t *) ((ls_gate_event_t *) event)->arg);
+}
+
+static void rx1_event(event_t *event)
+{
+    rx1_expired((ls_gate_channel_t *) ((ls_gate_event_t *) event)->arg);
+}
+
+static void ping_event(event_t *event)
+{
+    ls_gate_t *ls = (ls_gate_t *) ((ls_gate_event_t *) event)->arg;
+
+    ping_tick(ls);
+
+    /* Restart timer */
+    event_timeout_set(&ls->_internal.ping_timer, LS_PING_TIMEOUT);
+}
+
+/**
+ * Gate event loop thread body, handles radio interrupts, timeouts and uplink queues.
+ */
+static void *event_handler(void *arg)
+{
+    assert(arg != NULL);
+
+    ls_gate_t *ls = (ls_gate_t *) arg;
+
+    /* Queue belongs to the thread which initializes it */
+    event_queue_init(&ls->_internal.queue);
+
+    puts("ls-gate: event loop started");
+
+    event_loop(&ls->_internal.queue);
+
+    return NULL;
+}
+
+/**
+ * @brief Creates gate event loop thread.
+ */
+static bool create_event_thread(ls_gate_t *ls)
+{
+    puts("ls-gate: creating event loop thread...");
+
+    kernel_pid_t pid = thread_create(ls->_internal.event_thread_stack, sizeof(ls->_internal.event_thread_stack),
+                                     THREAD_PRIORITY_MAIN - 2,
+                                     THREAD_CREATE_STACKTEST, event_handler, ls,
+                                     "ls-gate events");
+
+    if (pid <= KERNEL_PID_UNDEF) {
+        puts("ls-gate: creation of event loop thread failed");
+        return false;
+    }
+
+    ls->_internal.event_thread_pid = pid;
+
+    return true;
+}
+#else
 void *isr_thread(void *arg)
 {
     (void)arg;
@@ -649,34 +1030,7 @@ static void *uq_handler(void *arg)
     while (1) {
         msg_receive(&msg);
 
-        ls_gate_channel_t *ch = (ls_gate_channel_t *) msg.content.ptr;
-        ls_frame_fifo_t *fifo = &ch->_internal.ul_fifo;
-
-        if (ls_frame_fifo_empty(fifo)) {
-            continue;
-        }
-
-        /* Get frame from queue top */
-        ls_frame_t *f;
-        ls_frame_t frame;
-        if (!ls_frame_fifo_pop(fifo, &frame)) {
-            continue;
-        }
-
-        f = &frame;
-
-		/* Update frame's FID to the last one and advance it */
-		f->header.fid = 0;
-
-        DEBUG("ls-gate: >mhdr=0x%02X, mic=0x%04X, addr=0x%02X, type=0x%02X, fid=0x%02X [%d left]\n",
-                (unsigned int) f->header.mhdr,
-                (unsigned int) f->header.mic, (unsigned int) f->header.dev_addr,
-                (unsigned int) f->header.type,
-                (unsigned int) f->header.fid,
-                ls_frame_fifo_size(fifo));
-
-        /* Send frame into LoRa PHY */
-        send_frame_f(ch, f);
+        send_next_frame((ls_gate_channel_t *) msg.content.ptr);
     }
 
     return NULL;
@@ -702,31 +1056,7 @@ static void *tim_handler(void *arg)
 
         switch (cmd) {
             case LS_GATE_PING:
-                ls->_internal.ping_count++;
-
-				/* Kick inactive devices */
-				for (int i = 0; i < LS_GATE_MAX_NODES; i++) {
-					if (!ls->devices.nodes_free_list[i]) {
-						ls_gate_node_t *node = &ls->devices.nodes[i];
-
-						/* Don't kick static nodes */
-						if (node->is_static)
-							continue;
-
-						int diff = ls->_internal.ping_count - node->last_seen;
-
-						if (diff >= LS_MAX_PING_DIFFERENCE) {
-							/* Kick node */
-                            DEBUG("ls-gate: remove node from devlist");
-							ls_devlist_remove_device(&ls->devices, i);
-
-							/* Notify application code about kicked node */
-							if (ls->node_kicked_cb != NULL) {
-								ls->node_kicked_cb(node);
-							}
-						}
-					}
-				}
+                ping_tick(ls);
 
                 /* Restart timer */
                 xtimer_set_msg(&ls->_internal.ping_timer, LS_PING_TIMEOUT, &msg_ping, ls->_internal.tim_thread_pid);
@@ -737,17 +1067,7 @@ static void *tim_handler(void *arg)
             	if (!ch)
             		break;
 
-
-            	/* RX window expired, if there are frames awaiting in queue, schedule TX operation */
-            	if (!ls_frame_fifo_empty(&ch->_internal.ul_fifo)) {
-            		puts("ls-gate: rx1 window expired, sending next frame from queue");
-
-            		close_rx_windows(ch);
-            		schedule_tx(ch);
-            	} else {
-            		ch->state = LS_GATE_CHANNEL_STATE_IDLE;
-            		puts("ls-gate: rx1 window expired, staying in RX, but IDLE");
-            	}
+            	rx1_expired(ch);
             }
             break;
 
@@ -809,6 +1129,8 @@ static bool create_uq_handler_thread(ls_gate_t *ls)
     return true;
 }
 
+#endif
+
 static bool open_channel(ls_gate_channel_t *ch)
 {
     assert(ch != NULL);
@@ -816,6 +1138,8 @@ static bool open_channel(ls_gate_channel_t *ch)
 
     /* Initialize uplink queue */
     ls_frame_fifo_init(&ch->_internal.ul_fifo);
+    ch->_internal.tx_addr = LS_ADDR_UNDEFINED;
+    ch->_internal.rx_window_addr = LS_ADDR_UNDEFINED;
     
     DEBUG("[LoRa] open_channel: init SX127X\n");
     /* Initialize the transceiver */
@@ -849,6 +1173,18 @@ static bool initialize_channels(ls_gate_t *ls)
 
         ch->_internal.gate = ls;
         mutex_init(&ch->_internal.channel_mutex);
+        ch->state = LS_GATE_CHANNEL_STATE_IDLE;
+
+#ifdef LS_GATE_EVENT_LOOP
+        init_event(&ch->_internal.ev_isr, isr_event, ch);
+        init_event(&ch->_internal.ev_tx, tx_event, ch);
+        init_event(&ch->_internal.ev_rx1, rx1_event, ch);
+        event_timeout_init(&ch->_internal.rx_window1, &ls->_internal.queue, &ch->_internal.ev_rx1.super);
+#else
+        /* Each channel has its own RX window expiration message */
+        ch->_internal.rx1_msg.type = LS_GATE_RX1_EXPIRED;
+        ch->_internal.rx1_msg.content.ptr = (void *) ch;
+#endif
 
         if (!open_channel(ch)) {
             return false;
@@ -867,8 +1203,17 @@ int ls_gate_init(ls_gate_t *ls)
     assert(ls->channels != NULL);
     assert(ls->num_channels > 0);
 
+#ifdef LS_GATE_EVENT_LOOP
+    if (!create_event_thread(ls)) {
+        return -LS_INIT_E_TIM_THREAD;
+    }
+
+    /* Start ping timer */
+    init_event(&ls->_internal.ev_ping, ping_event, ls);
+    event_timeout_init(&ls->_internal.ping_timer, &ls->_internal.queue, &ls->_internal.ev_ping.super);
+    event_timeout_set(&ls->_internal.ping_timer, LS_PING_TIMEOUT);
+#else
     msg_ping.type = LS_GATE_PING;
-    msg_rx1_expired.type = LS_GATE_RX1_EXPIRED;
     
     if (!create_tim_handler_thread(ls)) {
         return -LS_INIT_E_TIM_THREAD;
@@ -880,6 +1225,7 @@ int ls_gate_init(ls_gate_t *ls)
 
     /* Start ping timer */
     xtimer_set_msg(&ls->_internal.ping_timer, LS_PING_TIMEOUT, &msg_ping, ls->_internal.tim_thread_pid);
+#endif
     
     ls_devlist_init(&ls->devices);
     if (!initialize_channels(ls)) {
@@ -903,7 +1249,25 @@ int ls_gate_send_to(ls_gate_t *ls, ls_addr_t addr, uint8_t *buf, size_t bufsize)
         return -LS_GATE_E_NODEV;
     }  
 
-    /* Send next data frame as ack to the previous if number of pending frames is > 0 (class A) */
+    if (node->node_class == LS_ED_CLASS_A) {
+        /* Host replies to the pending frames request while the node is still listening */
+        if (node->num_pending > 0 && node->rx_deadline > xtimer_now_usec64()) {
+            enqueue_frame((ls_gate_channel_t *) node->node_ch, addr, LS_DL_ACK_W_DATA, buf, bufsize);
+            return LS_GATE_OK;
+        }
+
+        /* Otherwise frame waits for the node's next uplink */
+        if (!ls_devlist_dl_push(&ls->devices, node, buf, bufsize, ls->_internal.ping_count,
+                                ls->_internal.ping_count + LS_GATE_DL_LIFETIME)) {
+            DEBUG("ls-gate: downlink queue is full\n");
+            return -LS_E_PQ_OVERFLOW;
+        }
+
+        DEBUG("ls-gate: data queued until the node's uplink\n");
+        return LS_GATE_OK;
+    }
+
+    /* Send next data frame as ack to the previous if number of pending frames is > 0 */
     bool send_ack_with_data = node->num_pending > 0;
     enqueue_frame((ls_gate_channel_t *) node->node_ch, addr, (send_ack_with_data) ? LS_DL_ACK_W_DATA : LS_DL, buf, bufsize);
     
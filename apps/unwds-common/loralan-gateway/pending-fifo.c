@@ -36,65 +36,181 @@
 
 #include "pending-fifo.h"
 #include "mutex.h"
-#include "irq.h"
+#include "sema.h"
+#include "msg.h"
+#include "tsrb.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 void gc_pending_fifo_init(gc_pending_fifo_t *fifo) {
+	tsrb_init(&fifo->rb, fifo->buf, sizeof(fifo->buf));
+	fifo->left = 0;
+
 	mutex_init(&fifo->mutex);
-	fifo->front = fifo->rear = -1;
+
+	/* Nothing to wait for until the consumer frees some space */
+	sema_create(&fifo->space, 0);
+	fifo->waiting = false;
 }
 
-bool gc_pending_fifo_pop(gc_pending_fifo_t *fifo, char *buf) {
-	if (gc_pending_fifo_empty(fifo)) {
-		return false;
+size_t gc_pending_fifo_peek(gc_pending_fifo_t *fifo, const uint8_t **data) {
+	tsrb_t *rb = &fifo->rb;
+
+	if (fifo->left == 0) {
+		uint8_t hdr[GC_PENDING_HDR_LEN];
+
+		/* Records are published whole, so the header is followed by the reply */
+		if (tsrb_get(rb, (char *) hdr, sizeof(hdr)) != sizeof(hdr)) {
+			return 0;
+		}
+
+		fifo->left = hdr[0] | (hdr[1] << 8);
 	}
 
-	mutex_lock(&fifo->mutex);
+	size_t len = tsrb_peek_chunk(rb, (const char **) data);
 
-	memcpy(buf, fifo->fifo[fifo->front], GC_MAX_REPLY_LEN);
+	if (len > fifo->left) {
+		len = fifo->left;
+	}
 
-	if (fifo->front == fifo->rear) {
-		fifo->front = fifo->rear = -1;
+	return len;
+}
+
+void gc_pending_fifo_consume(gc_pending_fifo_t *fifo, size_t len) {
+	if (len > fifo->left) {
+		len = fifo->left;
+	}
+
+	fifo->left -= len;
+	tsrb_skip(&fifo->rb, len);
+
+	/* Wake up the producer waiting for space */
+	if (fifo->waiting) {
+		fifo->waiting = false;
+		sema_post(&fifo->space);
+	}
+}
 
+size_t gc_pending_fifo_pop(gc_pending_fifo_t *fifo, char *buf) {
+	const uint8_t *data;
+	size_t len = 0;
+
+	size_t n = gc_pending_fifo_peek(fifo, &data);
+	while (n) {
+		memcpy(buf + len, data, n);
+		len += n;
+
+		gc_pending_fifo_consume(fifo, n);
+
+		/* Record may wrap around the end of the ring */
+		n = fifo->left ? gc_pending_fifo_peek(fifo, &data) : 0;
+	}
+
+	return len;
+}
+
+bool gc_pending_fifo_push(gc_pending_fifo_t *fifo, const char *buf) {
+	return gc_pending_fifo_push_len(fifo, buf, strlen(buf));
+}
+
+/* Locks the producers' mutex if the record fits, keeps it locked until gc_pending_fifo_end() */
+static bool reserve(gc_pending_fifo_t *fifo, size_t len) {
+	mutex_lock(&fifo->mutex);
+
+	if (tsrb_free(&fifo->rb) < GC_PENDING_HDR_LEN + len) {
 		mutex_unlock(&fifo->mutex);
-		return true;
+		return false;
 	}
 
-	fifo->front = (fifo->front + 1) % GC_MAX_PENDING;
+	fifo->reserved = len;
+	fifo->written = 0;
+
+	return true;
+}
+
+bool gc_pending_fifo_begin(gc_pending_fifo_t *fifo, size_t max_len, kernel_pid_t writer) {
+	if (max_len == 0 || max_len > GC_MAX_RECORD_LEN) {
+		return false;
+	}
+
+	if (writer == KERNEL_PID_UNDEF) {
+		return reserve(fifo, max_len);
+	}
+
+	/* Set before the attempt, so space freed right after it is not missed */
+	fifo->waiting = true;
+
+	while (!reserve(fifo, max_len)) {
+		/* Ask the writer to flush the queue and wait until it frees some space */
+		msg_t msg = { .type = GC_PENDING_MSG_FLUSH };
+		msg_try_send(&msg, writer);
+
+		sema_wait(&fifo->space);
+		fifo->waiting = true;
+	}
+
+	fifo->waiting = false;
 
-	mutex_unlock(&fifo->mutex);
 	return true;
 }
 
-bool gc_pending_fifo_push(gc_pending_fifo_t *fifo, char buf[GC_MAX_REPLY_LEN]) {
-	if (gc_pending_fifo_full(fifo)) {
+bool gc_pending_fifo_write(gc_pending_fifo_t *fifo, const void *data, size_t len) {
+	if (fifo->written + len > fifo->reserved) {
 		return false;
 	}
 
-	int c = irq_disable();
+	/* Room is reserved already, so it can't fail */
+	tsrb_poke(&fifo->rb, GC_PENDING_HDR_LEN + fifo->written, data, len);
+	fifo->written += len;
+
+	return true;
+}
 
-	if (gc_pending_fifo_empty(fifo)) {
-		fifo->front = fifo->rear = 0;
-	} else {
-		fifo->rear = (fifo->rear + 1) % GC_MAX_PENDING;
+void gc_pending_fifo_end(gc_pending_fifo_t *fifo) {
+	size_t len = fifo->written;
+
+	if (len) {
+		uint8_t hdr[GC_PENDING_HDR_LEN] = { len & 0xFF, len >> 8 };
+		tsrb_poke(&fifo->rb, 0, (const char *) hdr, sizeof(hdr));
+
+		/* Publish the whole record at once */
+		tsrb_commit(&fifo->rb, sizeof(hdr) + len);
+	}
+
+	mutex_unlock(&fifo->mutex);
+}
+
+static bool push(gc_pending_fifo_t *fifo, const void *buf, size_t len, kernel_pid_t writer) {
+	if (len == 0 || len > GC_MAX_REPLY_LEN) {
+		return false;
 	}
 
-	memcpy(fifo->fifo[fifo->rear], buf, GC_MAX_REPLY_LEN);
+	if (!gc_pending_fifo_begin(fifo, len, writer)) {
+		return false;
+	}
 
-	irq_restore(c);
+	gc_pending_fifo_write(fifo, buf, len);
+	gc_pending_fifo_end(fifo);
 
 	return true;
 }
 
+bool gc_pending_fifo_push_len(gc_pending_fifo_t *fifo, const void *buf, size_t len) {
+	return push(fifo, buf, len, KERNEL_PID_UNDEF);
+}
+
+bool gc_pending_fifo_push_wait(gc_pending_fifo_t *fifo, const void *buf, size_t len, kernel_pid_t writer) {
+	return push(fifo, buf, len, writer);
+}
+
 bool gc_pending_fifo_full(gc_pending_fifo_t *fifo) {
-	return ((fifo->rear + 1) % GC_MAX_PENDING) == fifo->front;
+	return tsrb_free(&fifo->rb) <= GC_PENDING_HDR_LEN;
 }
 
 bool gc_pending_fifo_empty(gc_pending_fifo_t *fifo) {
-	return (fifo->front == -1 && fifo->rear == -1);
+	return tsrb_empty(&fifo->rb) && fifo->left == 0;
 }
 
 #ifdef __cplusplus
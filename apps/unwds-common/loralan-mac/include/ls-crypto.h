@@ -45,6 +45,17 @@ typedef struct {
 	uint8_t join_key[AES_KEY_SIZE];
 } ls_crypto_t;
 
+/**
+ * @brief Precomputed HMAC-SHA256 state of the MIC key.
+ *
+ * Holds SHA-256 states right after the inner and outer key pads were hashed,
+ * so MIC calculation only has to hash the frame bytes.
+ */
+typedef struct {
+	uint32_t inner[8];	/**< Inner hash state after (key ^ ipad) block */
+	uint32_t outer[8];	/**< Outer hash state after (key ^ opad) block */
+} ls_mic_ctx_t;
+
 /**
  * @brief Calculates Message Integrity Code for the specified frame
  *
@@ -55,6 +66,34 @@ typedef struct {
  */
 ls_mic_t ls_calculate_mic(uint8_t *key, ls_frame_t *frame, uint8_t payload_size);
 
+/**
+ * @brief Precomputes HMAC pads state for the specified MIC key
+ *
+ * @param	[OUT]	ctx		MIC context to initialize
+ * @param	[IN]	key		key for the MIC calculation
+ */
+void ls_mic_ctx_init(ls_mic_ctx_t *ctx, uint8_t *key);
+
+/**
+ * @brief Calculates Message Integrity Code for the specified frame using precomputed MIC context
+ *
+ * @param	[IN]	ctx		precomputed MIC context
+ * @param	[IN]	frame	frame for which the MIC will be calculated
+ *
+ * @return MIC for the specified frame
+ */
+ls_mic_t ls_calculate_mic_ctx(const ls_mic_ctx_t *ctx, ls_frame_t *frame, uint8_t payload_size);
+
+/**
+ * @brief Validates Message Integrity Code for the specified frame using precomputed MIC context
+ *
+ * @param	[IN]	ctx		precomputed MIC context
+ * @param	[IN]	frame	frame for which the MIC will be validated
+ *
+ * @return true if MIC is valid, false otherwise
+ */
+bool ls_validate_frame_mic_ctx(const ls_mic_ctx_t *ctx, ls_frame_t *frame);
+
 /**
  * @brief Validates Message Integrity Code for the specified frame
  *
@@ -92,6 +131,16 @@ void ls_decrypt_frame_payload(uint8_t *key, ls_frame_t *frame);
  */
 void ls_encrypt_frame(uint8_t *key_mic, uint8_t *key_aes, ls_frame_t *frame, size_t *newsize);
 
+/**
+ * @brief Encrypts frame payload and calculates frame's MIC using precomputed MIC context
+ *
+ * @param	[IN]	*mic_ctx	precomputed MIC context
+ * @param	[IN]	*key_aes	key for the AES encryption
+ * @param	[IN]	*frame		the frame to work with
+ * @param	[OUT]	*newsize	new size of payload (resizes after encryption)
+ */
+void ls_encrypt_frame_ctx(const ls_mic_ctx_t *mic_ctx, uint8_t *key_aes, ls_frame_t *frame, size_t *newsize);
+
 /**
  * @brief Derives keys from the nonce numbers
  *
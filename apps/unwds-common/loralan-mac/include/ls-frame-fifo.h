@@ -90,6 +90,16 @@ bool ls_frame_fifo_peek(ls_frame_fifo_t *fifo, ls_frame_t *frame);
  */
 bool ls_frame_fifo_push(ls_frame_fifo_t *fifo, ls_frame_t *frame);
 
+/**
+ * @brief inserts element at the front of the queue, so it will be evicted first.
+ *
+ * @param	*fifo	pointer to the FIFO structure
+ * @param	*frame	pointer to the frame to insert
+ *
+ * @return 	false if frame is full
+ */
+bool ls_frame_fifo_push_front(ls_frame_fifo_t *fifo, ls_frame_t *frame);
+
 /**
  * @biref checks that queue is empty or not.
  *
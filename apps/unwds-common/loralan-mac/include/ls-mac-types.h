@@ -149,6 +149,42 @@ typedef uint8_t ls_payload_len_t;
 #define LS_PAYLOAD_SIZE_MAX (LS_FRAME_SIZE - LS_FRAME_MINIMUM_SIZE - AES_BLOCK_SIZE)
 #define LS_PAYLOAD_BUF_SIZE (LS_FRAME_SIZE - LS_FRAME_MINIMUM_SIZE)
 
+/**
+ * @brief RSSI of the channel considered free.
+ */
+#define LS_CHANNEL_FREE_RSSI -100
+
+/**
+ * @brief ADR command carried in the status byte of the downlink frames.
+ *
+ * Bit 7 marks the command, bits 0..2 hold the data rate, bits 3..6 the TX power step.
+ * Status byte of the uplink frames reports the node's current settings the same way,
+ * it's 0 if the node has ADR disabled.
+ */
+#define LS_ADR_CMD_FLAG (1 << 7)
+#define LS_ADR_CMD(dr, power) (LS_ADR_CMD_FLAG | (((power) & 0x0F) << 3) | ((dr) & 0x07))
+#define LS_ADR_CMD_DR(status) ((ls_datarate_t) ((status) & 0x07))
+#define LS_ADR_CMD_POWER(status) (((status) >> 3) & 0x0F)
+
+/**
+ * @brief Node status of the uplink status byte as the host protocol defines it.
+ *
+ * Host keeps getting the battery and temperature status byte, the ADR report
+ * is for the gate only and goes to the host as 0, as the nodes not measuring
+ * battery and temperature sent before.
+ */
+#define LS_NODE_STATUS(status) (((status) & LS_ADR_CMD_FLAG) ? 0 : (status))
+
+/**
+ * @brief TX power step of the ADR command [dB], step 0 is the maximum power
+ */
+#define LS_ADR_POWER_STEP_DB 2
+
+/**
+ * @brief Lowest TX power step the ADR command may ask for
+ */
+#define LS_ADR_POWER_MAX_STEP 7
+
 /**
  * LS frame payload.
  */
@@ -56,7 +56,28 @@ typedef struct  __attribute__((packed)) {
 extern "C" {
 #endif
 
-ls_mic_t ls_calculate_mic(uint8_t *key, ls_frame_t *frame, uint8_t payload_size)
+void ls_mic_ctx_init(ls_mic_ctx_t *ctx, uint8_t *key)
+{
+    hmac_context_t hmac;
+
+    /* Hash key pads once, only resulting states are kept */
+    hmac_sha256_init(&hmac, key, LS_MIC_KEY_LEN);
+
+    memcpy(ctx->inner, hmac.c_in.state, sizeof(ctx->inner));
+    memcpy(ctx->outer, hmac.c_out.state, sizeof(ctx->outer));
+}
+
+/**
+ * @brief Restores SHA-256 context as it was right after hashing one key pad block
+ */
+static void mic_ctx_restore(sha256_context_t *sha, const uint32_t *state)
+{
+    memcpy(sha->state, state, sizeof(sha->state));
+    sha->count[0] = 0;
+    sha->count[1] = SHA256_INTERNAL_BLOCK_SIZE << 3;
+}
+
+ls_mic_t ls_calculate_mic_ctx(const ls_mic_ctx_t *ctx, ls_frame_t *frame, uint8_t payload_size)
 {
     /* Get pointer to the frame data after MIC field */
     uint8_t *ptr = ((uint8_t *) frame) + 4; /* Skip 1 byte of MHDR and 3 bytes of MIC */
@@ -66,9 +87,17 @@ ls_mic_t ls_calculate_mic(uint8_t *key, ls_frame_t *frame, uint8_t payload_size)
 
     /* SHA-256 HMAC result */
     unsigned char hmac[SHA256_DIGEST_LENGTH];
+    sha256_context_t sha;
+
+    /* Inner hash over the frame data */
+    mic_ctx_restore(&sha, ctx->inner);
+    sha256_update(&sha, ptr, size);
+    sha256_final(&sha, hmac);
 
-    /* Calculate HMAC */
-    hmac_sha256(key, LS_MIC_KEY_LEN, (unsigned *) ptr, size, hmac);
+    /* Outer hash over the inner one */
+    mic_ctx_restore(&sha, ctx->outer);
+    sha256_update(&sha, hmac, SHA256_DIGEST_LENGTH);
+    sha256_final(&sha, hmac);
 
     /* Take first 3 bytes of hash as a MIC */
     ls_mic_t mic = (hmac[0] << 16)
@@ -78,6 +107,26 @@ ls_mic_t ls_calculate_mic(uint8_t *key, ls_frame_t *frame, uint8_t payload_size)
     return mic;
 }
 
+ls_mic_t ls_calculate_mic(uint8_t *key, ls_frame_t *frame, uint8_t payload_size)
+{
+    ls_mic_ctx_t ctx;
+    ls_mic_ctx_init(&ctx, key);
+
+    return ls_calculate_mic_ctx(&ctx, frame, payload_size);
+}
+
+bool ls_validate_frame_mic_ctx(const ls_mic_ctx_t *ctx, ls_frame_t *frame)
+{
+    /* Payload size is zero or matched to the AES block size + AES-CBC IV length */
+    uint8_t payload_size = frame->payload.len;
+
+    /* Compare MIC from header and actual */
+    ls_mic_t expected_mic = ls_calculate_mic_ctx(ctx, frame, payload_size);
+    ls_mic_t actual_mic = frame->header.mic;
+
+    return actual_mic == expected_mic;
+}
+
 bool ls_validate_frame_mic(uint8_t *key, ls_frame_t *frame)
 {
     /* Payload size is zero or matched to the AES block size + AES-CBC IV length */
@@ -104,6 +153,20 @@ void ls_encrypt_frame(uint8_t *key_mic, uint8_t *key_aes, ls_frame_t *frame, siz
     frame->header.mic = ls_calculate_mic(key_mic, frame, *newsize);
 }
 
+void ls_encrypt_frame_ctx(const ls_mic_ctx_t *mic_ctx, uint8_t *key_aes, ls_frame_t *frame, size_t *newsize)
+{
+    *newsize = frame->payload.len;
+
+    if (frame->payload.len > 0) {
+        ls_encrypt_frame_payload(key_aes, frame);
+    }
+    else {
+        *newsize = 0;
+    }
+
+    frame->header.mic = ls_calculate_mic_ctx(mic_ctx, frame, *newsize);
+}
+
 void ls_encrypt_frame_payload(uint8_t *key, ls_frame_t *frame)
 {
 	uint16_t size = frame->payload.len;
@@ -103,6 +103,26 @@ bool ls_frame_fifo_push(ls_frame_fifo_t *fifo, ls_frame_t *frame) {
 	return true;
 }
 
+bool ls_frame_fifo_push_front(ls_frame_fifo_t *fifo, ls_frame_t *frame) {
+	if (ls_frame_fifo_full(fifo)) {
+		return false;
+	}
+
+	int c = irq_disable();
+
+	if (ls_frame_fifo_empty(fifo)) {
+		fifo->front = fifo->rear = 0;
+	} else {
+		fifo->front = (fifo->front + LS_MAX_FRAME_FIFO_SIZE - 1) % LS_MAX_FRAME_FIFO_SIZE;
+	}
+
+	fifo->fifo[fifo->front] = *frame;
+
+	irq_restore(c);
+
+	return true;
+}
+
 bool ls_frame_fifo_full(ls_frame_fifo_t *fifo) {
 	return ((fifo->rear + 1) % LS_MAX_FRAME_FIFO_SIZE) == fifo->front;
 }
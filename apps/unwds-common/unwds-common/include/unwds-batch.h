@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup    
+ * @ingroup     
+ * @brief       
+ * @{
+ * @file        unwds-batch.h
+ * @brief       Aggregation of the modules' readings into packed uplinks
+ *
+ * Readings published by the modules within the latency bound are coalesced
+ * into a single uplink of the following format:
+ *
+ *     UNWDS_BATCH_MODULE_ID | length_1 | reading_1 | ... | length_N | reading_N
+ *
+ * where each reading is the module data as it would be sent alone, starting
+ * with the module ID. Batch holding a single reading is sent as is.
+ */
+#ifndef UNWDS_BATCH_H_
+#define UNWDS_BATCH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "unwds-common.h"
+
+/**
+ * @brief Default maximum time the reading may wait in the batch [ms], 0 disables batching
+ */
+#ifndef UNWDS_BATCH_LATENCY_MS
+#define UNWDS_BATCH_LATENCY_MS 0
+#endif
+
+#define UNWDS_BATCH_STACK_SIZE 1024
+
+/**
+ * @brief Returns maximum application payload at the current data rate
+ */
+typedef size_t (unwds_batch_max_payload_t)(void);
+
+/**
+ * @brief Initializes the batching stage.
+ *
+ * @param   [in]    send_cb         Callback sending the uplink to the network
+ * @param   [in]    max_payload_cb  Callback returning current maximum payload, NULL for UNWDS_MAX_DATA_LEN
+ * @param   [in]    latency_ms      Maximum time the reading may wait in the batch, 0 disables batching
+ */
+void unwds_batch_init(uwnds_cb_t *send_cb, unwds_batch_max_payload_t *max_payload_cb, uint32_t latency_ms);
+
+/**
+ * @brief Modules' event callback, queues the reading into the current batch.
+ *
+ * Replies sent as ACK for the downlink commands bypass the batch.
+ */
+void unwds_batch_push(module_data_t *data);
+
+/**
+ * @brief Sends current batch right away.
+ */
+void unwds_batch_flush(void);
+
+#endif /* UNWDS_BATCH_H_ */
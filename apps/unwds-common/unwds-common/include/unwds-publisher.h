@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup    
+ * @ingroup     
+ * @brief       
+ * @{
+ * @file        unwds-publisher.h
+ * @brief       Shared periodic publisher service for the modules
+ *
+ * Modules register a publishing period and a sampling callback instead of
+ * running their own timer threads. All the sampling is done on the single
+ * publisher thread, publishers due within UNWDS_PUBLISHER_SLACK_MS, but no
+ * more than a quarter of their period, of each other are served in one wakeup.
+ *
+ * In the change-of-value mode the publisher samples module's values on its
+ * own, faster period and publishes the reading only when any of the values
+ * moves away from the published one by the delta or more. Publishing period
+ * then serves as the heartbeat: reading is published anyway if nothing was
+ * published for that long.
+ */
+#ifndef UNWDS_PUBLISHER_H_
+#define UNWDS_PUBLISHER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "unwds-common.h"
+
+/**
+ * @brief Publisher thread stack size, must fit the largest module's sampling callback
+ */
+#ifndef UNWDS_PUBLISHER_STACK_SIZE
+#define UNWDS_PUBLISHER_STACK_SIZE 1024
+#endif
+
+/**
+ * @brief Publisher may be served that much earlier to share the wakeup with another one [ms]
+ *
+ * Publisher timer is also allowed to fire that much later, so the wakeup is
+ * shared with other rtctimers-millis timers due about the same time.
+ */
+#ifndef UNWDS_PUBLISHER_SLACK_MS
+#define UNWDS_PUBLISHER_SLACK_MS 2000
+#endif
+
+/**
+ * @brief Fills in module's reading, data->as_ack is set by the caller
+ */
+typedef void (unwds_publisher_prepare_t)(module_data_t *data);
+
+/**
+ * @brief Maximum number of values watched in the change-of-value mode
+ */
+#ifndef UNWDS_PUBLISHER_COV_VALUES
+#define UNWDS_PUBLISHER_COV_VALUES 10
+#endif
+
+/**
+ * @brief Reads module's values watched in the change-of-value mode
+ *
+ * @param   [out]   values      Current values, up to UNWDS_PUBLISHER_COV_VALUES
+ *
+ * @return  number of values
+ */
+typedef size_t (unwds_publisher_sample_t)(int32_t *values);
+
+/**
+ * @brief Fills in module's reading from the values sampled in the change-of-value mode
+ *
+ * Sensors are then read once per publication, published reading is exactly
+ * the one the following samples are compared with.
+ *
+ * @param   [out]   data        Module's reading, data->as_ack is set by the caller
+ * @param   [in]    values      Values read by the sampling callback
+ * @param   [in]    num         Number of values
+ */
+typedef void (unwds_publisher_format_t)(module_data_t *data, const int32_t *values, size_t num);
+
+/**
+ * @brief Change-of-value mode settings, kept in the modules' NVRAM config
+ */
+typedef struct __attribute__((__packed__)) {
+    uint16_t sample_sec;                    /**< Sampling period [s], 0 disables the mode */
+    uint16_t delta;                         /**< Change of any value to be published, in module's units */
+} unwds_publisher_cov_t;
+
+/**
+ * @brief Periodic publisher, owned by the module
+ */
+typedef struct unwds_publisher {
+    struct unwds_publisher *next;           /**< Next registered publisher */
+    unwds_publisher_prepare_t *prepare;     /**< Sampling callback */
+    uwnds_cb_t *callback;                   /**< Module's event callback */
+    uint32_t period_ms;                     /**< Publishing period, 0 if not published periodically */
+    uint32_t left_ms;                       /**< Time left until the next publication */
+    bool pending;                           /**< Publication requested */
+    bool as_ack;                            /**< Requested publication is the reply to the poll */
+
+    unwds_publisher_sample_t *sample;       /**< Reads the values watched in the change-of-value mode */
+    unwds_publisher_format_t *format;       /**< Fills in the reading from the sampled values */
+    unwds_publisher_cov_t *cov;             /**< Mode settings in the module's config */
+    uint32_t sample_ms;                     /**< Sampling period, 0 if the change-of-value mode is off */
+    uint32_t sample_left_ms;                /**< Time left until the next sampling */
+    uint16_t delta;                         /**< Change of any value to be published */
+    uint8_t num_published;                  /**< Number of values published last, 0 if nothing yet */
+    int32_t published[UNWDS_PUBLISHER_COV_VALUES]; /**< Values published last */
+} unwds_publisher_t;
+
+/**
+ * @brief Registers the module's publisher and starts the publisher thread if needed.
+ *
+ * @param   [in]    pub         Publisher, must stay valid forever
+ * @param   [in]    prepare     Sampling callback
+ * @param   [in]    callback    Module's event callback the readings are passed to
+ * @param   [in]    period_ms   Publishing period, 0 to publish on request only
+ *
+ * @return  true on success
+ */
+bool unwds_publisher_add(unwds_publisher_t *pub, unwds_publisher_prepare_t *prepare,
+                         uwnds_cb_t *callback, uint32_t period_ms);
+
+/**
+ * @brief Changes the publishing period and restarts the countdown, 0 stops publishing.
+ */
+void unwds_publisher_set_period(unwds_publisher_t *pub, uint32_t period_ms);
+
+/**
+ * @brief Sets up the module's change-of-value mode.
+ *
+ * Mode is switched on or off as the settings say, the commands below change
+ * them later on.
+ *
+ * @param   [in]    pub         Publisher
+ * @param   [in]    sample      Callback reading the values watched
+ * @param   [in]    format      Callback filling in the reading from the values
+ * @param   [in]    cov         Mode settings in the module's config, must stay valid forever
+ */
+void unwds_publisher_set_cov(unwds_publisher_t *pub, unwds_publisher_sample_t *sample,
+                             unwds_publisher_format_t *format, unwds_publisher_cov_t *cov);
+
+/**
+ * @brief Handles the module's change-of-value mode command.
+ *
+ * Command code is followed by the sampling period in seconds and the delta,
+ * 2 bytes each, little-endian. Reply echoes the command code and the settings
+ * now in effect, it is left for the module to fill in if the command is invalid.
+ *
+ * @param   [in]    pub         Publisher
+ * @param   [in]    module_id   Module's ID the reply starts with
+ * @param   [in]    cmd         Command
+ * @param   [out]   reply       Reply
+ *
+ * @return  true if the settings are changed and the module's config is to be saved
+ */
+bool unwds_publisher_cov_cmd(unwds_publisher_t *pub, uint8_t module_id,
+                             const module_data_t *cmd, module_data_t *reply);
+
+/**
+ * @brief Handles the "<module> cov <S> <D>" shell command.
+ *
+ * @return  true if the settings are changed and the module's config is to be saved
+ */
+bool unwds_publisher_cov_shell_cmd(unwds_publisher_t *pub, int argc, char **argv);
+
+/**
+ * @brief Requests the publication right away.
+ *
+ * @param   [in]    pub         Publisher
+ * @param   [in]    as_ack      Reading is the reply to the poll command
+ */
+void unwds_publisher_poll(unwds_publisher_t *pub, bool as_ack);
+
+#endif /* UNWDS_PUBLISHER_H_ */
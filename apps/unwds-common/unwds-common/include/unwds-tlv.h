@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup    
+ * @ingroup     
+ * @brief       
+ * @{
+ * @file        unwds-tlv.h
+ * @brief       Compact encoding of the modules' readings
+ *
+ * Reading is a set of up to UNWDS_TLV_MAX_FIELDS integer fields, the field
+ * number stands for the tag and variable-length integers carry their own
+ * length. Each reading is encoded against the previous one sent by the
+ * same stream:
+ *
+ *     header | present | value_1 | ... | value_N
+ *
+ * header   bit 7 is set for the key reading, bits 0..6 hold the reading sequence number
+ * present  varint, bit N is set if the field N follows
+ * value    zigzag varint, absolute value in the key reading or difference
+ *          from the previous reading otherwise
+ *
+ * Fields missing from the key reading are zero, fields missing from the other
+ * readings are unchanged. Key reading is sent first and every
+ * UNWDS_TLV_KEY_INTERVAL readings, so the decoder that lost the reading
+ * catches up. Node reports the uplinks it failed to send with
+ * unwds_tlv_uplink_lost(), the next reading of every stream is the key one then.
+ *
+ * The module code has no RIOT dependencies, so the host can decode the data
+ * using the same sources.
+ */
+#ifndef UNWDS_TLV_H_
+#define UNWDS_TLV_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @brief Set to 1 to make the modules send their readings encoded
+ */
+#ifndef UNWDS_TLV_REPLIES
+#define UNWDS_TLV_REPLIES 0
+#endif
+
+/**
+ * @brief Maximum number of fields in the reading
+ */
+#define UNWDS_TLV_MAX_FIELDS 16
+
+/**
+ * @brief Key reading is sent every that many readings
+ */
+#ifndef UNWDS_TLV_KEY_INTERVAL
+#define UNWDS_TLV_KEY_INTERVAL 8
+#endif
+
+#define UNWDS_TLV_KEY_FLAG (1 << 7)
+#define UNWDS_TLV_SEQ_MASK 0x7F
+
+/**
+ * @brief Maximum size of the encoded reading with num fields
+ */
+#define UNWDS_TLV_MAX_SIZE(num) (1 + 3 + 5 * (num))
+
+/**
+ * @brief Encoder or decoder state, the last reading sent or received
+ */
+typedef struct {
+	int32_t last[UNWDS_TLV_MAX_FIELDS];	/**< Field values of the last reading */
+	uint8_t num_fields;					/**< Number of fields in the reading */
+	uint8_t seq;						/**< Sequence number of the last reading */
+	uint8_t since_key;					/**< Readings since the last key one, 0 if key reading is due */
+	uint8_t lost;						/**< Lost uplinks counter at the last reading */
+	bool synced;						/**< Decoder has the reading the next one is based on */
+} unwds_tlv_stream_t;
+
+/**
+ * @brief Initializes the stream, the next reading is the key one.
+ *
+ * @param	*stream		pointer to the stream
+ * @param	num_fields	number of fields in the reading, up to UNWDS_TLV_MAX_FIELDS
+ */
+void unwds_tlv_init(unwds_tlv_stream_t *stream, uint8_t num_fields);
+
+/**
+ * @brief Makes the next encoded reading the key one.
+ *
+ * @param	*stream		pointer to the stream
+ */
+void unwds_tlv_reset(unwds_tlv_stream_t *stream);
+
+/**
+ * @brief Reports the uplink which is not going to be delivered.
+ *
+ * Streams can't tell which uplink carried their reading, so the next reading
+ * of every stream is the key one.
+ */
+void unwds_tlv_uplink_lost(void);
+
+/**
+ * @brief Encodes the reading.
+ *
+ * Stream state is updated only if the reading fits into the buffer.
+ *
+ * @param	*stream		pointer to the stream
+ * @param	*values		field values, stream's num_fields of them
+ * @param	*buf		output buffer
+ * @param	size		size of the output buffer
+ *
+ * @return	size of the encoded reading, 0 if it doesn't fit
+ */
+size_t unwds_tlv_encode(unwds_tlv_stream_t *stream, const int32_t *values, uint8_t *buf, size_t size);
+
+/**
+ * @brief Decodes the reading.
+ *
+ * Readings following the lost one are not decoded until the next key reading.
+ *
+ * @param	*stream		pointer to the stream
+ * @param	*buf		encoded reading
+ * @param	len			length of the data in the buffer
+ * @param	*values		field values, stream's num_fields of them
+ *
+ * @return	number of bytes decoded, 0 if reading is malformed or can't be decoded yet
+ */
+size_t unwds_tlv_decode(unwds_tlv_stream_t *stream, const uint8_t *buf, size_t len, int32_t *values);
+
+/**
+ * @brief Writes unsigned variable-length integer, 7 bits per byte, least significant first.
+ *
+ * @return	number of bytes written, 0 if it doesn't fit
+ */
+size_t unwds_tlv_put_varint(uint8_t *buf, size_t size, uint32_t value);
+
+/**
+ * @brief Reads unsigned variable-length integer.
+ *
+ * @return	number of bytes read, 0 if the integer is truncated or too long
+ */
+size_t unwds_tlv_get_varint(const uint8_t *buf, size_t len, uint32_t *value);
+
+/**
+ * @brief Maps signed value to unsigned so that small magnitudes get short varints.
+ */
+static inline uint32_t unwds_tlv_zigzag(int32_t value) {
+	return ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+}
+
+/**
+ * @brief Reverts unwds_tlv_zigzag().
+ */
+static inline int32_t unwds_tlv_unzigzag(uint32_t value) {
+	return (int32_t) ((value >> 1) ^ (0U - (value & 1)));
+}
+
+#endif /* UNWDS_TLV_H_ */
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup    
+ * @ingroup     
+ * @brief       
+ * @{
+ * @file        unwds-batch.c
+ * @brief       Aggregation of the modules' readings into packed uplinks
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "mutex.h"
+#include "msg.h"
+#include "thread.h"
+#include "rtctimers-millis.h"
+
+#include "unwds-common.h"
+#include "unwds-batch.h"
+#include "umdk-ids.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+/* Batch ID and the length of a single reading */
+#define UNWDS_BATCH_HDR_LEN 1U
+#define UNWDS_BATCH_REC_HDR_LEN 1U
+
+static uwnds_cb_t *send_callback;
+static unwds_batch_max_payload_t *max_payload_callback;
+static uint32_t latency;
+
+static kernel_pid_t batch_pid;
+static rtctimers_millis_t batch_timer;
+static msg_t batch_msg;
+
+static mutex_t batch_mutex = MUTEX_INIT;
+static module_data_t batch;
+static int batch_records;
+
+static size_t max_payload(void) {
+    size_t max = UNWDS_MAX_DATA_LEN;
+
+    if (max_payload_callback) {
+        size_t current = max_payload_callback();
+        if (current < max) {
+            max = current;
+        }
+    }
+
+    return max;
+}
+
+/**
+ * @brief Takes the batch out, batch_mutex must be locked
+ */
+static bool take_batch(module_data_t *out) {
+    if (batch_records == 0) {
+        return false;
+    }
+
+    if (batch_records == 1) {
+        /* Single reading is sent as is */
+        out->length = batch.data[UNWDS_BATCH_HDR_LEN];
+        memcpy(out->data, &batch.data[UNWDS_BATCH_HDR_LEN + UNWDS_BATCH_REC_HDR_LEN], out->length);
+    } else {
+        out->length = batch.length;
+        memcpy(out->data, batch.data, batch.length);
+    }
+
+    out->as_ack = false;
+    out->rssi = 0;
+
+    DEBUG("[batch] %d readings, %d bytes\n", batch_records, out->length);
+
+    batch_records = 0;
+    batch.length = UNWDS_BATCH_HDR_LEN;
+
+    return true;
+}
+
+void unwds_batch_flush(void) {
+    module_data_t out;
+
+    mutex_lock(&batch_mutex);
+    rtctimers_millis_remove(&batch_timer);
+    bool ready = take_batch(&out);
+    mutex_unlock(&batch_mutex);
+
+    if (ready) {
+        send_callback(&out);
+    }
+}
+
+void unwds_batch_push(module_data_t *data) {
+    /* Command replies aren't delayed */
+    if (!latency || data->as_ack) {
+        send_callback(data);
+        return;
+    }
+
+    /* Oversized reading is sent alone, after the readings queued before it */
+    if (UNWDS_BATCH_HDR_LEN + UNWDS_BATCH_REC_HDR_LEN + data->length > max_payload()) {
+        unwds_batch_flush();
+        send_callback(data);
+        return;
+    }
+
+    module_data_t out;
+    bool ready = false;
+
+    mutex_lock(&batch_mutex);
+
+    /* Reading doesn't fit into the current batch, it goes into the next one */
+    if (batch.length + UNWDS_BATCH_REC_HDR_LEN + data->length > max_payload()) {
+        rtctimers_millis_remove(&batch_timer);
+        ready = take_batch(&out);
+    }
+
+    batch.data[batch.length] = data->length;
+    memcpy(&batch.data[batch.length + UNWDS_BATCH_REC_HDR_LEN], data->data, data->length);
+    batch.length += UNWDS_BATCH_REC_HDR_LEN + data->length;
+
+    /* First reading in the batch starts the latency countdown */
+    if (batch_records++ == 0) {
+        rtctimers_millis_set_msg(&batch_timer, latency, &batch_msg, batch_pid);
+    }
+
+    mutex_unlock(&batch_mutex);
+
+    if (ready) {
+        send_callback(&out);
+    }
+}
+
+static void *batch_thread(void *arg) {
+    (void)arg;
+
+    msg_t msg;
+    msg_t msg_queue[4];
+    msg_init_queue(msg_queue, 4);
+
+    while (1) {
+        msg_receive(&msg);
+
+        /* Latency bound reached */
+        unwds_batch_flush();
+    }
+
+    return NULL;
+}
+
+void unwds_batch_init(uwnds_cb_t *send_cb, unwds_batch_max_payload_t *max_payload_cb, uint32_t latency_ms) {
+    send_callback = send_cb;
+    max_payload_callback = max_payload_cb;
+
+    batch.data[0] = UNWDS_BATCH_MODULE_ID;
+    batch.length = UNWDS_BATCH_HDR_LEN;
+    batch_records = 0;
+
+    if (!latency_ms) {
+        return;
+    }
+
+    char *stack = (char *) allocate_stack(UNWDS_BATCH_STACK_SIZE);
+    if (!stack) {
+        puts("[unwds-batch] unable to allocate stack, batching disabled");
+        return;
+    }
+
+    batch_pid = thread_create(stack, UNWDS_BATCH_STACK_SIZE, THREAD_PRIORITY_MAIN - 1,
+                              THREAD_CREATE_STACKTEST, batch_thread, NULL, "batch thread");
+
+    /* Enable batching only when there's a thread to flush the batches */
+    latency = latency_ms;
+
+    printf("[unwds-batch] readings are batched for up to %lu ms\n", (unsigned long) latency);
+}
+
+#ifdef __cplusplus
+}
+#endif
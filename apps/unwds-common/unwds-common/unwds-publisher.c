@@ -0,0 +1,445 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup    
+ * @ingroup     
+ * @brief       
+ * @{
+ * @file        unwds-publisher.c
+ * @brief       Shared periodic publisher service for the modules
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include "mutex.h"
+#include "msg.h"
+#include "thread.h"
+#include "rtctimers-millis.h"
+
+#include "unwds-common.h"
+#include "unwds-publisher.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+/* rtctimers-millis time wraps every week */
+#define UNWDS_PUBLISHER_TIMEBASE_MS (7UL * 24 * 60 * 60 * 1000)
+
+typedef enum {
+    UNWDS_PUBLISHER_MSG_TIMER = 0,
+    UNWDS_PUBLISHER_MSG_WAKEUP,
+} unwds_publisher_msg_t;
+
+static mutex_t publisher_mutex = MUTEX_INIT;
+static unwds_publisher_t *publishers = NULL;
+
+static kernel_pid_t publisher_pid = KERNEL_PID_UNDEF;
+static rtctimers_millis_t publisher_timer;
+static msg_t timer_msg = { .type = UNWDS_PUBLISHER_MSG_TIMER };
+static msg_t wakeup_msg = { .type = UNWDS_PUBLISHER_MSG_WAKEUP };
+
+/* Timer generation, tells the stale expiration message from the current one */
+static uint32_t timer_gen = 0;
+
+static uint32_t last_now;       /* Time of the last accounting */
+static uint32_t armed_ms;       /* Time left until the timer window opens */
+static uint32_t armed_slack_ms; /* Timer may expire that much later */
+
+/**
+ * @brief Returns how early the countdown of the period may be served, short periods get less
+ *
+ * Slack must stay below the period: countdown restarted by take_due() is then
+ * never due again in the same pass, otherwise the publisher thread would serve
+ * the same publisher over and over without ever sleeping.
+ */
+static inline uint32_t slack(uint32_t period_ms) {
+    return (period_ms / 4 < UNWDS_PUBLISHER_SLACK_MS) ? (period_ms / 4) : UNWDS_PUBLISHER_SLACK_MS;
+}
+
+static inline uint32_t countdown(uint32_t left_ms, uint32_t elapsed) {
+    return (left_ms > elapsed) ? (left_ms - elapsed) : 0;
+}
+
+/**
+ * @brief Accounts the time passed since the last call, publisher_mutex must be locked
+ */
+static void advance(bool expired) {
+    uint32_t now = rtctimers_millis_now();
+    uint32_t elapsed = (now + UNWDS_PUBLISHER_TIMEBASE_MS - last_now) % UNWDS_PUBLISHER_TIMEBASE_MS;
+    last_now = now;
+
+    /* Clock may be corrected at any time, the timer is the only reliable reference */
+    if (elapsed > armed_ms + armed_slack_ms) {
+        elapsed = armed_ms + armed_slack_ms;
+    }
+    if (expired && (elapsed < armed_ms)) {
+        elapsed = armed_ms;
+    }
+    armed_slack_ms = countdown(armed_slack_ms, countdown(elapsed, armed_ms));
+    armed_ms = countdown(armed_ms, elapsed);
+
+    for (unwds_publisher_t *pub = publishers; pub != NULL; pub = pub->next) {
+        if (pub->period_ms) {
+            pub->left_ms = countdown(pub->left_ms, elapsed);
+        }
+        if (pub->sample_ms) {
+            pub->sample_left_ms = countdown(pub->sample_left_ms, elapsed);
+        }
+    }
+}
+
+/**
+ * @brief Starts the timer for the nearest publication, publisher_mutex must be locked
+ */
+static void rearm(void) {
+    uint32_t next = UINT32_MAX;
+    uint32_t next_slack = 0;
+
+    for (unwds_publisher_t *pub = publishers; pub != NULL; pub = pub->next) {
+        if (pub->period_ms && (pub->left_ms < next)) {
+            next = pub->left_ms;
+            next_slack = slack(pub->period_ms);
+        }
+        if (pub->sample_ms && (pub->sample_left_ms < next)) {
+            next = pub->sample_left_ms;
+            next_slack = slack(pub->sample_ms);
+        }
+    }
+
+    rtctimers_millis_remove(&publisher_timer);
+
+    if (next == UINT32_MAX) {
+        armed_ms = 0;
+        armed_slack_ms = 0;
+        return;
+    }
+
+    /* Wakeup may come up to the slack early to be shared with other timers,
+     * take_due() serves the publisher then, so the period doesn't grow */
+    armed_ms = countdown(next, next_slack);
+    armed_slack_ms = next - armed_ms;
+    timer_msg.content.value = ++timer_gen;
+    rtctimers_millis_set_msg_slack(&publisher_timer, armed_ms, armed_slack_ms, &timer_msg, publisher_pid);
+
+    DEBUG("[publisher] next wakeup in %lu ms, slack %lu ms\n", (unsigned long) armed_ms, (unsigned long) armed_slack_ms);
+}
+
+/**
+ * @brief Takes out the publisher to be served now, publisher_mutex must be locked
+ *
+ * Publisher due for sampling only is returned with *sample_only set, its
+ * reading is published only if the values have changed.
+ */
+static unwds_publisher_t *take_due(bool *as_ack, bool *sample_only) {
+    for (unwds_publisher_t *pub = publishers; pub != NULL; pub = pub->next) {
+        /* Publishers due shortly are served along with the current one */
+        bool due = pub->period_ms && (pub->left_ms <= slack(pub->period_ms));
+        bool sample_due = pub->sample_ms && (pub->sample_left_ms <= slack(pub->sample_ms));
+
+        if (pub->pending || due || sample_due) {
+            *as_ack = pub->as_ack;
+            *sample_only = !(pub->pending || due);
+            pub->as_ack = false;
+            pub->pending = false;
+            if (due) {
+                /* Served early, next one is still counted from the due time */
+                pub->left_ms += pub->period_ms;
+                assert(pub->left_ms > slack(pub->period_ms));
+            }
+            if (pub->sample_ms) {
+                /* Published reading is sampled as well */
+                pub->sample_left_ms = sample_due ? (pub->sample_left_ms + pub->sample_ms) : pub->sample_ms;
+                assert(pub->sample_left_ms > slack(pub->sample_ms));
+            }
+            return pub;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Checks if any of the values moved away from the published ones by the delta
+ */
+static bool values_changed(unwds_publisher_t *pub, const int32_t *values, size_t num) {
+    if (num != pub->num_published) {
+        return true;
+    }
+
+    for (size_t i = 0; i < num; i++) {
+        int64_t diff = (int64_t) values[i] - pub->published[i];
+        if (diff < 0) {
+            diff = -diff;
+        }
+
+        if (diff && (diff >= pub->delta)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Takes the reading and decides if it is to be published
+ *
+ * In the change-of-value mode the reading is made of the sampled values, so
+ * the published values are exactly the ones the next samples are compared with.
+ */
+static bool take_reading(unwds_publisher_t *pub, bool sample_only, module_data_t *data) {
+    int32_t values[UNWDS_PUBLISHER_COV_VALUES];
+
+    mutex_lock(&publisher_mutex);
+    unwds_publisher_sample_t *sample_cb = pub->sample_ms ? pub->sample : NULL;
+    unwds_publisher_format_t *format_cb = pub->format;
+    mutex_unlock(&publisher_mutex);
+
+    if (!sample_cb) {
+        /* Mode is off, nothing to compare with */
+        if (sample_only) {
+            return false;
+        }
+
+        pub->prepare(data);
+        return true;
+    }
+
+    size_t num = sample_cb(values);
+    if (num > UNWDS_PUBLISHER_COV_VALUES) {
+        num = UNWDS_PUBLISHER_COV_VALUES;
+    }
+
+    if (sample_only && !values_changed(pub, values, num)) {
+        return false;
+    }
+
+    mutex_lock(&publisher_mutex);
+    if (sample_only) {
+        /* Heartbeat counts from the last publication */
+        advance(false);
+        pub->left_ms = pub->period_ms;
+    }
+    memcpy(pub->published, values, num * sizeof(int32_t));
+    pub->num_published = num;
+    mutex_unlock(&publisher_mutex);
+
+    format_cb(data, values, num);
+    return true;
+}
+
+static void wakeup(void) {
+    if (publisher_pid != KERNEL_PID_UNDEF) {
+        /* Pending wakeup message already covers this request */
+        msg_try_send(&wakeup_msg, publisher_pid);
+    }
+}
+
+static void *publisher_thread(void *arg) {
+    (void)arg;
+
+    msg_t msg;
+    msg_t msg_queue[4];
+    msg_init_queue(msg_queue, 4);
+
+    puts("[unwds-publisher] Periodic publisher thread started");
+
+    while (1) {
+        msg_receive(&msg);
+
+        bool expired = (msg.type == UNWDS_PUBLISHER_MSG_TIMER) && (msg.content.value == timer_gen);
+
+        while (1) {
+            bool as_ack = false;
+            bool sample_only = false;
+
+            mutex_lock(&publisher_mutex);
+            advance(expired);
+            expired = false;
+
+            unwds_publisher_t *pub = take_due(&as_ack, &sample_only);
+            if (!pub) {
+                rearm();
+                mutex_unlock(&publisher_mutex);
+                break;
+            }
+            mutex_unlock(&publisher_mutex);
+
+            module_data_t data = {};
+            data.as_ack = as_ack;
+
+            if (!take_reading(pub, sample_only, &data)) {
+                DEBUG("[publisher] values unchanged\n");
+                continue;
+            }
+
+            /* Notify the application */
+            pub->callback(&data);
+        }
+    }
+
+    return NULL;
+}
+
+bool unwds_publisher_add(unwds_publisher_t *pub, unwds_publisher_prepare_t *prepare,
+                         uwnds_cb_t *callback, uint32_t period_ms) {
+    if (publisher_pid == KERNEL_PID_UNDEF) {
+        char *stack = (char *) allocate_stack(UNWDS_PUBLISHER_STACK_SIZE);
+        if (!stack) {
+            puts("[unwds-publisher] Unable to allocate stack");
+            return false;
+        }
+
+        last_now = rtctimers_millis_now();
+        publisher_pid = thread_create(stack, UNWDS_PUBLISHER_STACK_SIZE, THREAD_PRIORITY_MAIN - 1,
+                                      THREAD_CREATE_STACKTEST, publisher_thread, NULL, "publisher thread");
+    }
+
+    pub->prepare = prepare;
+    pub->callback = callback;
+    pub->period_ms = period_ms;
+    pub->left_ms = period_ms;
+    pub->pending = false;
+    pub->as_ack = false;
+    pub->sample = NULL;
+    pub->format = NULL;
+    pub->cov = NULL;
+    pub->sample_ms = 0;
+    pub->num_published = 0;
+
+    mutex_lock(&publisher_mutex);
+    advance(false);
+    pub->next = publishers;
+    publishers = pub;
+    mutex_unlock(&publisher_mutex);
+
+    wakeup();
+
+    return true;
+}
+
+void unwds_publisher_set_period(unwds_publisher_t *pub, uint32_t period_ms) {
+    mutex_lock(&publisher_mutex);
+    advance(false);
+    pub->period_ms = period_ms;
+    pub->left_ms = period_ms;
+    mutex_unlock(&publisher_mutex);
+
+    wakeup();
+}
+
+/**
+ * @brief Applies the change-of-value mode settings, publisher_mutex must be locked
+ */
+static void apply_cov(unwds_publisher_t *pub) {
+    advance(false);
+    pub->sample_ms = (pub->sample != NULL) ? 1000UL * pub->cov->sample_sec : 0;
+    pub->sample_left_ms = pub->sample_ms;
+    pub->delta = pub->cov->delta;
+
+    /* First sampled reading is published */
+    pub->num_published = 0;
+}
+
+static void change_cov(unwds_publisher_t *pub, const unwds_publisher_cov_t *cov) {
+    mutex_lock(&publisher_mutex);
+    *pub->cov = *cov;
+    apply_cov(pub);
+    mutex_unlock(&publisher_mutex);
+
+    wakeup();
+
+    if (cov->sample_sec) {
+        printf("[unwds-publisher] Sampling every %u s, publishing on change by %u\n",
+               cov->sample_sec, cov->delta);
+    } else {
+        puts("[unwds-publisher] Change-of-value mode off");
+    }
+}
+
+void unwds_publisher_set_cov(unwds_publisher_t *pub, unwds_publisher_sample_t *sample,
+                             unwds_publisher_format_t *format, unwds_publisher_cov_t *cov) {
+    mutex_lock(&publisher_mutex);
+    pub->sample = sample;
+    pub->format = format;
+    pub->cov = cov;
+    apply_cov(pub);
+    mutex_unlock(&publisher_mutex);
+
+    wakeup();
+}
+
+bool unwds_publisher_cov_cmd(unwds_publisher_t *pub, uint8_t module_id,
+                             const module_data_t *cmd, module_data_t *reply) {
+    /* Sampling period and delta, 2 bytes each */
+    if ((pub->cov == NULL) || (cmd->length != 5)) {
+        return false;
+    }
+
+    unwds_publisher_cov_t cov;
+    cov.sample_sec = cmd->data[1] | cmd->data[2] << 8;
+    cov.delta = cmd->data[3] | cmd->data[4] << 8;
+
+    change_cov(pub, &cov);
+
+    reply->length = 6;
+    reply->data[0] = module_id;
+    reply->data[1] = cmd->data[0];
+    reply->data[2] = cov.sample_sec & 0xFF;
+    reply->data[3] = cov.sample_sec >> 8;
+    reply->data[4] = cov.delta & 0xFF;
+    reply->data[5] = cov.delta >> 8;
+
+    return true;
+}
+
+bool unwds_publisher_cov_shell_cmd(unwds_publisher_t *pub, int argc, char **argv) {
+    if ((pub->cov == NULL) || (argc != 4) || (strcmp(argv[1], "cov") != 0)) {
+        return false;
+    }
+
+    unwds_publisher_cov_t cov = { .sample_sec = atoi(argv[2]), .delta = atoi(argv[3]) };
+    change_cov(pub, &cov);
+
+    return true;
+}
+
+void unwds_publisher_poll(unwds_publisher_t *pub, bool as_ack) {
+    mutex_lock(&publisher_mutex);
+    pub->pending = true;
+    pub->as_ack = as_ack;
+    mutex_unlock(&publisher_mutex);
+
+    wakeup();
+}
+
+#ifdef __cplusplus
+}
+#endif
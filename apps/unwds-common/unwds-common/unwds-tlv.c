@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup    
+ * @ingroup     
+ * @brief       
+ * @{
+ * @file        unwds-tlv.c
+ * @brief       Compact encoding of the modules' readings
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "unwds-tlv.h"
+
+/* Uplinks lost so far, streams compare it with the value at their last reading */
+static volatile uint8_t lost_uplinks;
+
+void unwds_tlv_init(unwds_tlv_stream_t *stream, uint8_t num_fields) {
+	memset(stream, 0, sizeof(unwds_tlv_stream_t));
+
+	if (num_fields > UNWDS_TLV_MAX_FIELDS) {
+		num_fields = UNWDS_TLV_MAX_FIELDS;
+	}
+	stream->num_fields = num_fields;
+	stream->seq = UNWDS_TLV_SEQ_MASK;
+	stream->lost = lost_uplinks;
+}
+
+void unwds_tlv_reset(unwds_tlv_stream_t *stream) {
+	stream->since_key = 0;
+}
+
+void unwds_tlv_uplink_lost(void) {
+	lost_uplinks++;
+}
+
+size_t unwds_tlv_put_varint(uint8_t *buf, size_t size, uint32_t value) {
+	size_t n = 0;
+
+	do {
+		if (n >= size) {
+			return 0;
+		}
+
+		uint8_t b = value & 0x7F;
+		value >>= 7;
+		buf[n++] = value ? (b | 0x80) : b;
+	} while (value);
+
+	return n;
+}
+
+size_t unwds_tlv_get_varint(const uint8_t *buf, size_t len, uint32_t *value) {
+	uint32_t v = 0;
+
+	/* 32-bit value takes 5 bytes at most */
+	for (size_t n = 0; n < len && n < 5; n++) {
+		v |= (uint32_t) (buf[n] & 0x7F) << (7 * n);
+
+		if (!(buf[n] & 0x80)) {
+			*value = v;
+			return n + 1;
+		}
+	}
+
+	return 0;
+}
+
+size_t unwds_tlv_encode(unwds_tlv_stream_t *stream, const int32_t *values, uint8_t *buf, size_t size) {
+	uint8_t lost = lost_uplinks;
+	bool key = (stream->since_key == 0) || (stream->lost != lost);
+	uint8_t seq = (stream->seq + 1) & UNWDS_TLV_SEQ_MASK;
+	uint32_t present = 0;
+
+	/* Key reading skips zeros, the rest skip unchanged fields */
+	for (uint8_t i = 0; i < stream->num_fields; i++) {
+		int32_t base = key ? 0 : stream->last[i];
+		if (values[i] != base) {
+			present |= (1UL << i);
+		}
+	}
+
+	if (size < 1) {
+		return 0;
+	}
+
+	buf[0] = seq | (key ? UNWDS_TLV_KEY_FLAG : 0);
+	size_t len = 1;
+
+	size_t n = unwds_tlv_put_varint(buf + len, size - len, present);
+	if (!n) {
+		return 0;
+	}
+	len += n;
+
+	for (uint8_t i = 0; i < stream->num_fields; i++) {
+		if (!(present & (1UL << i))) {
+			continue;
+		}
+
+		/* Difference wraps around, decoder adds it back the same way */
+		uint32_t diff = (uint32_t) values[i] - (key ? 0 : (uint32_t) stream->last[i]);
+
+		n = unwds_tlv_put_varint(buf + len, size - len, unwds_tlv_zigzag((int32_t) diff));
+		if (!n) {
+			return 0;
+		}
+		len += n;
+	}
+
+	/* Reading is going to be sent, if it's lost the node reports it before the next one */
+	memcpy(stream->last, values, stream->num_fields * sizeof(int32_t));
+	stream->seq = seq;
+	stream->since_key = key ? 1 : stream->since_key + 1;
+	stream->since_key %= UNWDS_TLV_KEY_INTERVAL;
+	stream->lost = lost;
+
+	return len;
+}
+
+size_t unwds_tlv_decode(unwds_tlv_stream_t *stream, const uint8_t *buf, size_t len, int32_t *values) {
+	if (len < 1) {
+		return 0;
+	}
+
+	bool key = (buf[0] & UNWDS_TLV_KEY_FLAG) != 0;
+	uint8_t seq = buf[0] & UNWDS_TLV_SEQ_MASK;
+	size_t pos = 1;
+
+	uint32_t present;
+	size_t n = unwds_tlv_get_varint(buf + pos, len - pos, &present);
+	if (!n || (present >> stream->num_fields) != 0) {
+		return 0;
+	}
+	pos += n;
+
+	int32_t decoded[UNWDS_TLV_MAX_FIELDS];
+
+	for (uint8_t i = 0; i < stream->num_fields; i++) {
+		uint32_t base = key ? 0 : (uint32_t) stream->last[i];
+
+		if (present & (1UL << i)) {
+			uint32_t v;
+			n = unwds_tlv_get_varint(buf + pos, len - pos, &v);
+			if (!n) {
+				return 0;
+			}
+			pos += n;
+
+			decoded[i] = (int32_t) (base + (uint32_t) unwds_tlv_unzigzag(v));
+		}
+		else {
+			decoded[i] = (int32_t) base;
+		}
+	}
+
+	/* Difference from the reading we don't have is useless */
+	if (!key && (!stream->synced || seq != ((stream->seq + 1) & UNWDS_TLV_SEQ_MASK))) {
+		stream->synced = false;
+		return 0;
+	}
+
+	memcpy(stream->last, decoded, stream->num_fields * sizeof(int32_t));
+	memcpy(values, decoded, stream->num_fields * sizeof(int32_t));
+	stream->seq = seq;
+	stream->synced = true;
+
+	return pos;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    core_msg_buf Pooled message buffers
+ * @ingroup     core_msg
+ * @brief       Zero-copy passing of large payloads between threads
+ *
+ * A message carries only a 32-bit value or a pointer, so large payloads are
+ * usually kept in static buffers shared by the sender and the receiver, and
+ * nothing stops the sender from overwriting the buffer the receiver still
+ * reads.
+ *
+ * Pool holds fixed-size blocks. The thread allocating a block owns it, sending
+ * the block with msg_buf_send() passes the ownership to the receiver along
+ * with the message, so only the pointer is copied. The receiver takes the block
+ * with msg_buf_get() and returns it to its pool with msg_buf_free() when done.
+ * Blocks may be allocated, sent and freed in the interrupt context too.
+ *
+ * With DEVELHELP each block keeps its owner: sending or freeing a block
+ * owned by another thread triggers an assertion, and msg_buf_pool_leaks()
+ * counts blocks left by the threads that don't exist anymore.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Pooled message buffers API
+ *
+ * @author      Oleg Artamonov
+ */
+
+#ifndef MSG_BUF_H
+#define MSG_BUF_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "msg.h"
+#include "memarray.h"
+#include "kernel_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Pool of message buffers
+ */
+typedef struct {
+    memarray_t mem;         /**< Free blocks */
+    void *data;             /**< Pool storage */
+    size_t size;            /**< Size of a block including its header */
+    size_t num;             /**< Number of blocks */
+    size_t used;            /**< Number of allocated blocks */
+    size_t used_max;        /**< Maximum number of blocks allocated at once */
+} msg_buf_pool_t;
+
+/**
+ * @brief Header kept in front of each block
+ * @internal
+ */
+typedef struct {
+    msg_buf_pool_t *pool;   /**< Pool the block belongs to */
+#ifdef DEVELHELP
+    kernel_pid_t owner;     /**< Thread owning the block, KERNEL_PID_UNDEF if free */
+    uint16_t magic;         /**< Marks allocated block */
+#endif
+} msg_buf_hdr_t;
+
+/**
+ * @brief Size of the block for the payload of the given size, payload is word aligned
+ */
+#define MSG_BUF_BLOCK_SIZE(size) \
+    ((sizeof(msg_buf_hdr_t) + (size) + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1))
+
+/**
+ * @brief Declares storage for the pool of @p num blocks of @p size bytes each
+ */
+#define MSG_BUF_POOL_DATA(name, size, num) \
+    uintptr_t name[(MSG_BUF_BLOCK_SIZE(size) / sizeof(uintptr_t)) * (num)]
+
+/**
+ * @brief Initializes the pool.
+ *
+ * @param[out] pool     pool to initialize
+ * @param[in]  data     storage declared with MSG_BUF_POOL_DATA()
+ * @param[in]  size     size of the payload of a block, same as in MSG_BUF_POOL_DATA()
+ * @param[in]  num      number of blocks, same as in MSG_BUF_POOL_DATA()
+ */
+void msg_buf_pool_init(msg_buf_pool_t *pool, void *data, size_t size, size_t num);
+
+/**
+ * @brief Allocates a block, the calling thread becomes its owner.
+ *
+ * @param[in]  pool     pool to allocate the block from
+ *
+ * @return pointer to the block payload
+ * @return NULL if the pool is exhausted
+ */
+void *msg_buf_alloc(msg_buf_pool_t *pool);
+
+/**
+ * @brief Returns the block to its pool.
+ *
+ * @param[in]  buf      block payload, NULL is ignored
+ */
+void msg_buf_free(void *buf);
+
+/**
+ * @brief Sends the block to the thread, blocking.
+ *
+ * Block pointer is placed into content.ptr of the message, the target
+ * thread becomes the owner of the block if the message was delivered.
+ *
+ * @param[in]  m        message to send, type is set by the caller
+ * @param[in]  target_pid   PID of the target thread
+ * @param[in]  buf      block payload owned by the calling thread
+ *
+ * @return 1 if the message was sent, the block is not ours anymore
+ * @return 0 if the message could not be delivered, the block is still ours
+ * @return -1 on error (invalid PID)
+ */
+int msg_buf_send(msg_t *m, kernel_pid_t target_pid, void *buf);
+
+/**
+ * @brief Sends the block to the thread, non-blocking.
+ *
+ * Same as msg_buf_send(), but never blocks. Could be used in the interrupt context.
+ *
+ * @param[in]  m        message to send, type is set by the caller
+ * @param[in]  target_pid   PID of the target thread
+ * @param[in]  buf      block payload owned by the calling thread
+ *
+ * @return 1 if the message was sent, the block is not ours anymore
+ * @return 0 if the receiver's queue is full, the block is still ours
+ * @return -1 on error (invalid PID)
+ */
+int msg_buf_try_send(msg_t *m, kernel_pid_t target_pid, void *buf);
+
+/**
+ * @brief Takes the block from the received message.
+ *
+ * @param[in]  m        message received with the block
+ *
+ * @return pointer to the block payload, now owned by the calling thread
+ */
+void *msg_buf_get(msg_t *m);
+
+/**
+ * @brief Returns the size of the block payload.
+ *
+ * @param[in]  pool     pool of the blocks
+ */
+static inline size_t msg_buf_size(const msg_buf_pool_t *pool)
+{
+    return pool->size - sizeof(msg_buf_hdr_t);
+}
+
+#if defined(DEVELHELP) || defined(DOXYGEN)
+/**
+ * @brief Counts leaked blocks.
+ *
+ * Block is leaked if its owner thread doesn't exist anymore.
+ *
+ * @param[in]  pool     pool to check
+ *
+ * @return number of leaked blocks
+ */
+unsigned msg_buf_pool_leaks(msg_buf_pool_t *pool);
+
+/**
+ * @brief Prints allocated blocks and their owners.
+ *
+ * @param[in]  pool     pool to print
+ */
+void msg_buf_pool_print(msg_buf_pool_t *pool);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MSG_BUF_H */
+/** @} */
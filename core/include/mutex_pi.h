@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     core_sync
+ * @brief       Priority inheritance mutex for thread synchronization
+ * @{
+ *
+ * @file
+ * @brief       RIOT synchronization API
+ *
+ * Plain mutex_t queues the waiters by priority, but the holder keeps its own
+ * priority, so a low priority holder can be preempted by any medium priority
+ * thread while a high priority thread waits for the mutex.
+ *
+ * While mutex_pi_t is held, the holder runs at the priority of the highest
+ * priority waiter. Boosting is transitive: if the holder itself waits for
+ * another mutex_pi_t, the holder of that one is boosted too. On unlock the
+ * thread drops back to the highest priority still required by the
+ * priority inheritance mutexes it holds, or to its own priority.
+ *
+ * Only waiting on mutex_pi_t is tracked. A holder blocked on the plain mutex
+ * or on a message still gets its priority raised, but it stays at its place
+ * in that waiting queue.
+ *
+ * @author      Oleg Artamonov
+ */
+
+#ifndef MUTEX_PI_H
+#define MUTEX_PI_H
+
+#include "mutex.h"
+#include "kernel_types.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/**
+ * @brief Priority inheritance mutex structure. Must never be modified by the user.
+ */
+typedef struct mutex_pi {
+    /**
+     * @brief   The mutex used for locking, waiters are kept in its queue.
+     * @internal
+     */
+    mutex_t mutex;
+
+    /**
+     * @brief   Owner thread of the mutex.
+     * @internal
+     */
+    volatile kernel_pid_t owner;
+
+    /**
+     * @brief   Next mutex held by the same owner.
+     * @internal
+     */
+    struct mutex_pi *next_held;
+} mutex_pi_t;
+
+/**
+ * @brief Static initializer for mutex_pi_t.
+ * @details This initializer is preferable to mutex_pi_init().
+ */
+#define MUTEX_PI_INIT { MUTEX_INIT, KERNEL_PID_UNDEF, NULL }
+
+/**
+ * @brief Initializes a priority inheritance mutex object.
+ * @details For initialization of variables use MUTEX_PI_INIT instead.
+ *          Only use the function call for dynamically allocated mutexes.
+ * @param[out] mutex    pre-allocated mutex structure, must not be NULL.
+ */
+static inline void mutex_pi_init(mutex_pi_t *mutex)
+{
+    mutex_pi_t empty_mutex = MUTEX_PI_INIT;
+    *mutex = empty_mutex;
+}
+
+/**
+ * @brief Lock a priority inheritance mutex, blocking or non-blocking.
+ *
+ * @details For commit purposes you should probably use mutex_pi_trylock() and
+ *          mutex_pi_lock() instead.
+ *
+ * @param[in] mutex         Mutex object to lock. Has to be initialized first.
+ *                          Must not be NULL.
+ * @param[in] blocking      if true, block until mutex is available.
+ *
+ * @return 1 if mutex was unlocked, now it is locked.
+ * @return 0 if the mutex was locked.
+ */
+int _mutex_pi_lock(mutex_pi_t *mutex, int blocking);
+
+/**
+ * @brief Tries to get a priority inheritance mutex, non-blocking.
+ *
+ * @param[in] mutex Mutex object to lock. Has to be initialized first. Must not
+ *                  be NULL.
+ *
+ * @return 1 if mutex was unlocked, now it is locked.
+ * @return 0 if the mutex was locked.
+ */
+static inline int mutex_pi_trylock(mutex_pi_t *mutex)
+{
+    return _mutex_pi_lock(mutex, 0);
+}
+
+/**
+ * @brief Locks a priority inheritance mutex, blocking.
+ *
+ * Raises the priority of the holder (and of the holders it waits for) up to
+ * the priority of the calling thread while the calling thread waits.
+ *
+ * @param[in] mutex Mutex object to lock. Has to be initialized first. Must not be NULL.
+ */
+static inline void mutex_pi_lock(mutex_pi_t *mutex)
+{
+    _mutex_pi_lock(mutex, 1);
+}
+
+/**
+ * @brief Unlocks the priority inheritance mutex.
+ *
+ * Must be called by the thread holding the mutex. Ownership is passed to
+ * the highest priority waiter, the calling thread drops the priority it
+ * inherited through this mutex.
+ *
+ * @param[in] mutex Mutex object to unlock, must not be NULL.
+ */
+void mutex_pi_unlock(mutex_pi_t *mutex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MUTEX_PI_H */
+/** @} */
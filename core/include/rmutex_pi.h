@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     core_sync
+ * @brief       Recursive priority inheritance mutex for thread synchronization
+ * @{
+ *
+ * @file
+ * @brief       RIOT synchronization API
+ *
+ * Same as @ref rmutex_t, built on top of @ref mutex_pi_t.
+ *
+ * @author      Oleg Artamonov
+ */
+
+#ifndef RMUTEX_PI_H
+#define RMUTEX_PI_H
+
+#include <stdint.h>
+
+#include "mutex_pi.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/**
+ * @brief Recursive priority inheritance mutex structure. Must never be modified by the user.
+ */
+typedef struct rmutex_pi {
+    /**
+     * @brief   The mutex used for locking, keeps the owner.
+     * @internal
+     */
+    mutex_pi_t mutex;
+
+    /**
+     * @brief   Number of locks owned by the thread owner
+     * @internal
+     */
+    uint16_t refcount;
+} rmutex_pi_t;
+
+/**
+ * @brief Static initializer for rmutex_pi_t.
+ * @details This initializer is preferable to rmutex_pi_init().
+ */
+#define RMUTEX_PI_INIT { MUTEX_PI_INIT, 0 }
+
+/**
+ * @brief Initializes a recursive priority inheritance mutex object.
+ * @details For initialization of variables use RMUTEX_PI_INIT instead.
+ *          Only use the function call for dynamically allocated mutexes.
+ * @param[out] rmutex    pre-allocated mutex structure, must not be NULL.
+ */
+static inline void rmutex_pi_init(rmutex_pi_t *rmutex)
+{
+    rmutex_pi_t empty_rmutex = RMUTEX_PI_INIT;
+    *rmutex = empty_rmutex;
+}
+
+/**
+ * @brief Tries to get a recursive priority inheritance mutex, non-blocking.
+ *
+ * @param[in] rmutex Recursive mutex object to lock. Has to be
+ *                  initialized first. Must not be NULL.
+ *
+ * @return 1 if mutex was unlocked, now it is locked.
+ * @return 0 if the mutex was locked.
+ */
+int rmutex_pi_trylock(rmutex_pi_t *rmutex);
+
+/**
+ * @brief Locks a recursive priority inheritance mutex, blocking.
+ *
+ * @param[in] rmutex Recursive mutex object to lock. Has to be
+ *                 initialized first. Must not be NULL.
+ */
+void rmutex_pi_lock(rmutex_pi_t *rmutex);
+
+/**
+ * @brief Unlocks the recursive priority inheritance mutex.
+ *
+ * @param[in] rmutex Recursive mutex object to unlock, must not be NULL.
+ */
+void rmutex_pi_unlock(rmutex_pi_t *rmutex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RMUTEX_PI_H */
+/** @} */
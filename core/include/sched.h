@@ -119,6 +119,20 @@ int sched_run(void);
  */
 void sched_set_status(thread_t *process, unsigned int status);
 
+/**
+ * @brief       Change the priority of the specified process
+ *
+ * @details     Moves the thread to the run queue of the new priority if it is
+ *              on the run queue. Doesn't yield, call sched_switch() or
+ *              thread_yield_higher() afterwards if needed.
+ *              Must be called with interrupts disabled.
+ *
+ * @param[in]   process     Pointer to the thread control block of the
+ *                          targeted process
+ * @param[in]   priority    The new priority of this thread
+ */
+void sched_change_priority(thread_t *process, uint8_t priority);
+
 /**
  * @brief       Yield if approriate.
  *
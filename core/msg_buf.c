@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     core_msg_buf
+ * @{
+ *
+ * @file
+ * @brief       Pooled message buffers implementation
+ *
+ * @author      Oleg Artamonov
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "msg_buf.h"
+#include "sched.h"
+#include "thread.h"
+#include "irq.h"
+#include "assert.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+#define MSG_BUF_MAGIC   (0x6D62)
+
+static inline msg_buf_hdr_t *_hdr(void *buf)
+{
+    return ((msg_buf_hdr_t *)buf) - 1;
+}
+
+#ifdef DEVELHELP
+/* interrupt handlers share the single owner */
+static inline kernel_pid_t _me(void)
+{
+    return irq_is_in() ? KERNEL_PID_ISR : sched_active_pid;
+}
+
+static inline void _check_owner(msg_buf_hdr_t *hdr)
+{
+    assert(hdr->magic == MSG_BUF_MAGIC);
+    assert(hdr->owner == _me());
+    (void)hdr;
+}
+#else
+#define _check_owner(hdr)   (void)(hdr)
+#endif
+
+void msg_buf_pool_init(msg_buf_pool_t *pool, void *data, size_t size, size_t num)
+{
+    pool->data = data;
+    pool->size = MSG_BUF_BLOCK_SIZE(size);
+    pool->num = num;
+    pool->used = 0;
+    pool->used_max = 0;
+
+    memarray_init(&pool->mem, data, pool->size, num);
+
+#ifdef DEVELHELP
+    for (size_t i = 0; i < num; i++) {
+        msg_buf_hdr_t *hdr = (msg_buf_hdr_t *)((char *)data + i * pool->size);
+        hdr->owner = KERNEL_PID_UNDEF;
+        hdr->magic = 0;
+    }
+#endif
+}
+
+void *msg_buf_alloc(msg_buf_pool_t *pool)
+{
+    unsigned state = irq_disable();
+    msg_buf_hdr_t *hdr = memarray_alloc(&pool->mem);
+
+    if (hdr == NULL) {
+        irq_restore(state);
+        DEBUG("msg_buf: pool %p is exhausted\n", (void *)pool);
+        return NULL;
+    }
+
+    if (++pool->used > pool->used_max) {
+        pool->used_max = pool->used;
+    }
+    irq_restore(state);
+
+    hdr->pool = pool;
+#ifdef DEVELHELP
+    hdr->owner = _me();
+    hdr->magic = MSG_BUF_MAGIC;
+#endif
+
+    return hdr + 1;
+}
+
+void msg_buf_free(void *buf)
+{
+    if (buf == NULL) {
+        return;
+    }
+
+    msg_buf_hdr_t *hdr = _hdr(buf);
+    msg_buf_pool_t *pool = hdr->pool;
+
+    _check_owner(hdr);
+
+    unsigned state = irq_disable();
+#ifdef DEVELHELP
+    hdr->owner = KERNEL_PID_UNDEF;
+    hdr->magic = 0;
+#endif
+    pool->used--;
+    /* overwrites the header with the free list link */
+    memarray_free(&pool->mem, hdr);
+    irq_restore(state);
+}
+
+static int _send(msg_t *m, kernel_pid_t target_pid, void *buf, int blocking)
+{
+    msg_buf_hdr_t *hdr = _hdr(buf);
+
+    _check_owner(hdr);
+
+    m->content.ptr = buf;
+
+#ifdef DEVELHELP
+    /* receiver may run and release the block before we return */
+    kernel_pid_t owner = hdr->owner;
+    hdr->owner = target_pid;
+#endif
+
+    int res = blocking ? msg_send(m, target_pid) : msg_try_send(m, target_pid);
+
+#ifdef DEVELHELP
+    if (res != 1) {
+        hdr->owner = owner;
+    }
+#endif
+
+    return res;
+}
+
+int msg_buf_send(msg_t *m, kernel_pid_t target_pid, void *buf)
+{
+    return _send(m, target_pid, buf, 1);
+}
+
+int msg_buf_try_send(msg_t *m, kernel_pid_t target_pid, void *buf)
+{
+    return _send(m, target_pid, buf, 0);
+}
+
+void *msg_buf_get(msg_t *m)
+{
+    void *buf = m->content.ptr;
+
+    _check_owner(_hdr(buf));
+
+    return buf;
+}
+
+#ifdef DEVELHELP
+static msg_buf_hdr_t *_block(msg_buf_pool_t *pool, size_t i)
+{
+    return (msg_buf_hdr_t *)((char *)pool->data + i * pool->size);
+}
+
+static int _allocated(msg_buf_hdr_t *hdr)
+{
+    return (hdr->magic == MSG_BUF_MAGIC) && (hdr->owner != KERNEL_PID_UNDEF);
+}
+
+static int _leaked(msg_buf_hdr_t *hdr)
+{
+    return (hdr->owner != KERNEL_PID_ISR) && (thread_get(hdr->owner) == NULL);
+}
+
+unsigned msg_buf_pool_leaks(msg_buf_pool_t *pool)
+{
+    unsigned leaks = 0;
+    unsigned state = irq_disable();
+
+    for (size_t i = 0; i < pool->num; i++) {
+        msg_buf_hdr_t *hdr = _block(pool, i);
+        if (_allocated(hdr) && _leaked(hdr)) {
+            leaks++;
+        }
+    }
+
+    irq_restore(state);
+    return leaks;
+}
+
+void msg_buf_pool_print(msg_buf_pool_t *pool)
+{
+    printf("msg_buf pool %p: %u of %u blocks of %u bytes used, max %u\n",
+           (void *)pool, (unsigned)pool->used, (unsigned)pool->num,
+           (unsigned)msg_buf_size(pool), (unsigned)pool->used_max);
+
+    for (size_t i = 0; i < pool->num; i++) {
+        msg_buf_hdr_t *hdr = _block(pool, i);
+        if (_allocated(hdr)) {
+            printf("  block %u: owner %" PRIkernel_pid "%s\n", (unsigned)i,
+                   hdr->owner, _leaked(hdr) ? " (leaked)" : "");
+        }
+    }
+}
+#endif
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     core_sync
+ * @{
+ *
+ * @file
+ * @brief       Priority inheritance mutex implementation
+ *
+ * @author      Oleg Artamonov
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "mutex_pi.h"
+#include "thread.h"
+#include "sched.h"
+#include "irq.h"
+#include "list.h"
+#include "assert.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+/**
+ * @brief Per-thread state, valid while the thread holds or waits for a mutex
+ */
+static struct {
+    mutex_pi_t *held;       /**< Mutexes held by the thread */
+    mutex_pi_t *waiting;    /**< Mutex the thread is blocked on */
+    uint8_t base_priority;  /**< Priority of the thread before boosting */
+} _pi_threads[KERNEL_PID_LAST + 1];
+
+static inline thread_t *_thread(list_node_t *node)
+{
+    return container_of((clist_node_t*)node, thread_t, rq_entry);
+}
+
+static void _take(mutex_pi_t *mutex, thread_t *thread)
+{
+    if (_pi_threads[thread->pid].held == NULL) {
+        _pi_threads[thread->pid].base_priority = thread->priority;
+    }
+
+    mutex->owner = thread->pid;
+    mutex->next_held = _pi_threads[thread->pid].held;
+    _pi_threads[thread->pid].held = mutex;
+}
+
+static void _release(mutex_pi_t *mutex, kernel_pid_t pid)
+{
+    mutex_pi_t **m = &_pi_threads[pid].held;
+
+    while (*m && *m != mutex) {
+        m = &(*m)->next_held;
+    }
+
+    if (*m) {
+        *m = mutex->next_held;
+    }
+
+    mutex->owner = KERNEL_PID_UNDEF;
+    mutex->next_held = NULL;
+}
+
+/* Raises owners' priority along the chain of mutexes starting from the one
+ * the thread of the given priority is blocked on */
+static void _boost(mutex_pi_t *mutex, uint8_t priority)
+{
+    /* chain can't be longer than the number of threads, unless it's a deadlock */
+    for (unsigned i = 0; mutex && (i < MAXTHREADS); i++) {
+        thread_t *owner = (thread_t *)sched_threads[mutex->owner];
+
+        if (!owner || (owner->priority <= priority)) {
+            return;
+        }
+
+        DEBUG("mutex_pi: boosting %" PRIkernel_pid " to %" PRIu8 "\n",
+              owner->pid, priority);
+
+        sched_change_priority(owner, priority);
+
+        mutex = _pi_threads[owner->pid].waiting;
+        if (mutex) {
+            /* keep the waiting queue sorted by the new priority */
+            list_remove(&mutex->mutex.queue, (list_node_t*)&owner->rq_entry);
+            thread_add_to_list(&mutex->mutex.queue, owner);
+        }
+    }
+}
+
+/* Drops thread's priority to the one still required by the mutexes it holds */
+static void _unboost(thread_t *thread)
+{
+    uint8_t priority = _pi_threads[thread->pid].base_priority;
+
+    for (mutex_pi_t *m = _pi_threads[thread->pid].held; m; m = m->next_held) {
+        list_node_t *head = m->mutex.queue.next;
+
+        /* waiters are sorted by priority, the first one is the highest */
+        if (head && (head != MUTEX_LOCKED) && (_thread(head)->priority < priority)) {
+            priority = _thread(head)->priority;
+        }
+    }
+
+    sched_change_priority(thread, priority);
+}
+
+int _mutex_pi_lock(mutex_pi_t *mutex, int blocking)
+{
+    unsigned irqstate = irq_disable();
+    thread_t *me = (thread_t*)sched_active_thread;
+
+    if (mutex->mutex.queue.next == NULL) {
+        /* mutex is unlocked. */
+        mutex->mutex.queue.next = MUTEX_LOCKED;
+        _take(mutex, me);
+        irq_restore(irqstate);
+        return 1;
+    }
+    else if (blocking) {
+        assert(mutex->owner != me->pid);
+
+        DEBUG("PID[%" PRIkernel_pid "]: waiting for mutex held by %" PRIkernel_pid
+              "\n", me->pid, mutex->owner);
+        sched_set_status(me, STATUS_MUTEX_BLOCKED);
+        if (mutex->mutex.queue.next == MUTEX_LOCKED) {
+            mutex->mutex.queue.next = (list_node_t*)&me->rq_entry;
+            mutex->mutex.queue.next->next = NULL;
+        }
+        else {
+            thread_add_to_list(&mutex->mutex.queue, me);
+        }
+
+        _pi_threads[me->pid].waiting = mutex;
+        _boost(mutex, me->priority);
+
+        irq_restore(irqstate);
+        thread_yield_higher();
+        /* We were woken up by scheduler. Waker removed us from queue
+         * and made us the owner. */
+        return 1;
+    }
+    else {
+        irq_restore(irqstate);
+        return 0;
+    }
+}
+
+void mutex_pi_unlock(mutex_pi_t *mutex)
+{
+    unsigned irqstate = irq_disable();
+    thread_t *me = (thread_t*)sched_active_thread;
+
+    if (mutex->mutex.queue.next == NULL) {
+        /* the mutex was not locked */
+        irq_restore(irqstate);
+        return;
+    }
+
+    assert(mutex->owner == me->pid);
+
+    uint8_t old_priority = me->priority;
+    _release(mutex, me->pid);
+
+    if (mutex->mutex.queue.next == MUTEX_LOCKED) {
+        /* the mutex was locked and no thread was waiting for it,
+         * still it could be the last one keeping us boosted */
+        mutex->mutex.queue.next = NULL;
+        _unboost(me);
+        irq_restore(irqstate);
+
+        if (me->priority > old_priority) {
+            thread_yield_higher();
+        }
+        return;
+    }
+
+    list_node_t *next = list_remove_head(&mutex->mutex.queue);
+    thread_t *process = _thread(next);
+
+    DEBUG("mutex_pi_unlock: passing mutex to %" PRIkernel_pid "\n", process->pid);
+    _pi_threads[process->pid].waiting = NULL;
+    sched_set_status(process, STATUS_PENDING);
+
+    if (!mutex->mutex.queue.next) {
+        mutex->mutex.queue.next = MUTEX_LOCKED;
+    }
+
+    /* the rest of the waiters have lower priority than the new owner */
+    _take(mutex, process);
+    _unboost(me);
+
+    uint16_t process_priority = process->priority;
+    irq_restore(irqstate);
+
+    if (me->priority > old_priority) {
+        /* any thread could outrank us now */
+        thread_yield_higher();
+    }
+    else {
+        sched_switch(process_priority);
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     core_sync
+ * @{
+ *
+ * @file
+ * @brief       Recursive priority inheritance mutex implementation
+ *
+ * @author      Oleg Artamonov
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "rmutex_pi.h"
+#include "thread.h"
+#include "assert.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+static int _lock(rmutex_pi_t *rmutex, int trylock)
+{
+    if (mutex_pi_trylock(&rmutex->mutex) == 0) {
+        /* Owner is written with interrupts disabled and is never set to our
+         * pid by the other threads, so if it's not us we have to wait */
+        if (rmutex->mutex.owner != thread_getpid()) {
+            if (trylock) {
+                return 0;
+            }
+
+            DEBUG("rmutex_pi %" PRIi16" : locking mutex\n", thread_getpid());
+            mutex_pi_lock(&rmutex->mutex);
+        }
+    }
+
+    /* refcount is protected by the mutex */
+    rmutex->refcount++;
+
+    return 1;
+}
+
+void rmutex_pi_lock(rmutex_pi_t *rmutex)
+{
+    _lock(rmutex, 0);
+}
+
+int rmutex_pi_trylock(rmutex_pi_t *rmutex)
+{
+    return _lock(rmutex, 1);
+}
+
+void rmutex_pi_unlock(rmutex_pi_t *rmutex)
+{
+    assert(rmutex->mutex.owner == thread_getpid());
+    assert(rmutex->refcount > 0);
+
+    rmutex->refcount--;
+
+    if (rmutex->refcount == 0) {
+        DEBUG("rmutex_pi %" PRIi16" : releasing mutex\n", thread_getpid());
+        mutex_pi_unlock(&rmutex->mutex);
+    }
+}
@@ -183,6 +183,29 @@ void sched_set_status(thread_t *process, unsigned int status)
     process->status = status;
 }
 
+void sched_change_priority(thread_t *process, uint8_t priority)
+{
+    if (process->priority == priority) {
+        return;
+    }
+
+    DEBUG("sched_change_priority: thread %" PRIkernel_pid " priority %" PRIu8
+          " -> %" PRIu8 ".\n", process->pid, process->priority, priority);
+
+    if (process->status >= STATUS_ON_RUNQUEUE) {
+        clist_remove(&sched_runqueues[process->priority], &(process->rq_entry));
+
+        if (!sched_runqueues[process->priority].next) {
+            runqueue_bitcache &= ~(1 << process->priority);
+        }
+
+        clist_rpush(&sched_runqueues[priority], &(process->rq_entry));
+        runqueue_bitcache |= 1 << priority;
+    }
+
+    process->priority = priority;
+}
+
 void sched_switch(uint16_t other_prio)
 {
     thread_t *active_thread = (thread_t *) sched_active_thread;
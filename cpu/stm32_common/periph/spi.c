@@ -37,6 +37,15 @@
  */
 #define BR_SHIFT            (3U)
 
+#ifdef MODULE_PERIPH_DMA
+/**
+ * @brief   Shorter transfers are polled, setting up DMA takes longer than them
+ */
+#ifndef SPI_DMA_MIN_LEN
+#define SPI_DMA_MIN_LEN     (8U)
+#endif
+#endif
+
 /**
  * @brief   Allocate one lock per SPI device
  */
@@ -260,7 +269,8 @@ void spi_transfer_bytes(spi_t bus, spi_cs_t cs, bool cont,
 
 #ifdef MODULE_PERIPH_DMA
     if (spi_config[bus].tx_dma != DMA_STREAM_UNDEF
-            && spi_config[bus].rx_dma != DMA_STREAM_UNDEF) {
+            && spi_config[bus].rx_dma != DMA_STREAM_UNDEF
+            && len >= SPI_DMA_MIN_LEN) {
         _transfer_dma(bus, out, in, len);
     }
     else {
@@ -200,6 +200,11 @@ typedef enum {
     SX127X_MODEM_SX1276 = 1,
 } sx127x_modem_chip_t;
 
+/**
+ * @brief   Number of registers (from address 0) covered by the register shadow
+ */
+#define SX127X_REG_CACHE_SIZE                   (0x42)
+
 /**
  * @brief   SX127X internal data.
  */
@@ -210,6 +215,9 @@ typedef struct {
     uint32_t last_channel;                      /**< Last channel in frequency hopping sequence */
     sx127x_modem_chip_t modem_chip;             /**< Modem model */
     bool is_last_cad_success;                 /**< Sign of success of last CAD operation (activity detected) */
+    uint8_t reg_cache[SX127X_REG_CACHE_SIZE];   /**< Shadow of the LoRa configuration registers */
+    uint8_t reg_cache_valid[(SX127X_REG_CACHE_SIZE + 7) / 8]; /**< Shadow registers holding a known value */
+    bool reg_cache_lora;                        /**< LoRa register page is selected */
 } sx127x_internal_t;
 
 /**
@@ -254,7 +262,7 @@ void sx127x_setup(sx127x_t *dev, const sx127x_params_t *params);
  *
  * @param[in] dev                      The sx127x device descriptor
  */
-int sx127x_reset(const sx127x_t *dev);
+int sx127x_reset(sx127x_t *dev);
 
 /**
  * @brief   Initializes the transceiver.
@@ -430,7 +438,7 @@ uint8_t sx127x_get_max_payload_len(const sx127x_t *dev);
  * @param[in] dev                      The sx127x device descriptor
  * @param[in] maxlen                   Maximum payload length in bytes
  */
-void sx127x_set_max_payload_len(const sx127x_t *dev, uint8_t maxlen);
+void sx127x_set_max_payload_len(sx127x_t *dev, uint8_t maxlen);
 
 /**
  * @brief   Gets the SX127X operating mode
@@ -447,7 +455,7 @@ uint8_t sx127x_get_op_mode(const sx127x_t *dev);
  * @param[in] dev                      The sx127x device descriptor
  * @param[in] op_mode                  The new operating mode
  */
-void sx127x_set_op_mode(const sx127x_t *dev, uint8_t op_mode);
+void sx127x_set_op_mode(sx127x_t *dev, uint8_t op_mode);
 
 /**
  * @brief   Gets the SX127X bandwidth
@@ -57,7 +57,7 @@ int sx127x_check_version(sx127x_t *dev);
  * @param[in] addr                     Register address
  * @param[in] data                     New register value
  */
-void sx127x_reg_write(const sx127x_t *dev, uint8_t addr, uint8_t data);
+void sx127x_reg_write(sx127x_t *dev, uint8_t addr, uint8_t data);
 
 /**
  * @brief   Reads the radio register at specified address.
@@ -77,7 +77,7 @@ uint8_t sx127x_reg_read(const sx127x_t *dev, uint8_t addr);
  * @param[in] buffer                   Buffer containing the new register's values
  * @param[in] size                     Number of registers to be written
  */
-void sx127x_reg_write_burst(const sx127x_t *dev, uint8_t addr, uint8_t *buffer,
+void sx127x_reg_write_burst(sx127x_t *dev, uint8_t addr, uint8_t *buffer,
                             uint8_t size);
 
 /**
@@ -91,6 +91,18 @@ void sx127x_reg_write_burst(const sx127x_t *dev, uint8_t addr, uint8_t *buffer,
 void sx127x_reg_read_burst(const sx127x_t *dev, uint8_t addr, uint8_t *buffer,
                            uint8_t size);
 
+/**
+ * @brief   Forgets the register shadow, e.g. after the transceiver reset.
+ *
+ *          Configuration registers of the LoRa page are written through the
+ *          shadow: writes of unchanged values are skipped and reads of the
+ *          registers written before are served from RAM. Status registers are
+ *          always accessed over SPI.
+ *
+ * @param[in] dev                      The sx127x device structure pointer
+ */
+void sx127x_reg_cache_reset(sx127x_t *dev);
+
 /**
  * @brief   Writes the buffer contents to the SX1276 FIFO
  *
@@ -98,7 +110,7 @@ void sx127x_reg_read_burst(const sx127x_t *dev, uint8_t addr, uint8_t *buffer,
  * @param[in] buffer                   Buffer Buffer containing data to be put on the FIFO.
  * @param[in] size                     Size Number of bytes to be written to the FIFO
  */
-void sx127x_write_fifo(const sx127x_t *dev, uint8_t *buffer, uint8_t size);
+void sx127x_write_fifo(sx127x_t *dev, uint8_t *buffer, uint8_t size);
 
 /**
  * @brief   Reads the contents of the SX1276 FIFO
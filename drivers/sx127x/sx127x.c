@@ -57,7 +57,7 @@ void sx127x_setup(sx127x_t *dev, const sx127x_params_t *params)
     memcpy(&dev->params, params, sizeof(sx127x_params_t));
 }
 
-int sx127x_reset(const sx127x_t *dev)
+int sx127x_reset(sx127x_t *dev)
 {
     /*
      * This reset scheme complies with 7.2 chapter of the SX1272/1276 datasheet
@@ -69,6 +69,9 @@ int sx127x_reset(const sx127x_t *dev)
      * 3. Wait at least 5 milliseconds
      */
 
+    /* Registers are back to their defaults (or in unknown state if the reset fails) */
+    sx127x_reg_cache_reset(dev);
+
     /* Check if the reset pin is defined */
     if (dev->params.reset_pin == GPIO_UNDEF) {
         DEBUG("[sx127x] error: No reset pin defined.\n");
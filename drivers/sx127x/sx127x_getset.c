@@ -134,9 +134,12 @@ void sx127x_set_channel(sx127x_t *dev, uint32_t channel)
     channel = (uint32_t)((double) channel / (double)LORA_FREQUENCY_RESOLUTION_DEFAULT);
 
     /* Write frequency settings into chip */
-    sx127x_reg_write(dev, SX127X_REG_FRFMSB, (uint8_t)((channel >> 16) & 0xFF));
-    sx127x_reg_write(dev, SX127X_REG_FRFMID, (uint8_t)((channel >> 8) & 0xFF));
-    sx127x_reg_write(dev, SX127X_REG_FRFLSB, (uint8_t)(channel & 0xFF));
+    uint8_t frf[3] = {
+        (uint8_t)((channel >> 16) & 0xFF),
+        (uint8_t)((channel >> 8) & 0xFF),
+        (uint8_t)(channel & 0xFF),
+    };
+    sx127x_reg_write_burst(dev, SX127X_REG_FRFMSB, frf, sizeof(frf));
 }
 
 uint32_t sx127x_get_time_on_air(const sx127x_t *dev, uint8_t pkt_len)
@@ -404,7 +407,7 @@ uint8_t sx127x_get_max_payload_len(const sx127x_t *dev)
     return 0;
 }
 
-void sx127x_set_max_payload_len(const sx127x_t *dev, uint8_t maxlen)
+void sx127x_set_max_payload_len(sx127x_t *dev, uint8_t maxlen)
 {
     DEBUG("[sx127x] Set max payload len: %d\n", maxlen);
 
@@ -424,7 +427,7 @@ uint8_t sx127x_get_op_mode(const sx127x_t *dev)
     return sx127x_reg_read(dev, SX127X_REG_OPMODE) & ~SX127X_RF_OPMODE_MASK;
 }
 
-void sx127x_set_op_mode(const sx127x_t *dev, uint8_t op_mode)
+void sx127x_set_op_mode(sx127x_t *dev, uint8_t op_mode)
 {
 #if ENABLE_DEBUG
     switch(op_mode) {
@@ -516,7 +519,7 @@ static void _low_datarate_optimize(sx127x_t *dev)
     }
 }
 
-static void _update_bandwidth(const sx127x_t *dev)
+static void _update_bandwidth(sx127x_t *dev)
 {
     uint8_t config1_reg = sx127x_reg_read(dev, SX127X_REG_LR_MODEMCONFIG1);
     if (dev->_internal.modem_chip == SX127X_MODEM_SX1272) {
@@ -555,7 +558,7 @@ static void _update_bandwidth(const sx127x_t *dev)
     sx127x_reg_write(dev, SX127X_REG_LR_MODEMCONFIG1, config1_reg);
 }
 
-static inline void _lna_agc_enable(const sx127x_t *dev) {
+static inline void _lna_agc_enable(sx127x_t *dev) {
     /* Enable LNA HF boost, as recommended in AN1200.23 */
     sx127x_reg_write(dev, SX127X_REG_LR_LNA,
                     (sx127x_reg_read(dev, SX127X_REG_LR_LNA) &
@@ -583,11 +586,11 @@ void sx127x_set_bandwidth(sx127x_t *dev, uint8_t bandwidth)
 
     dev->settings.lora.bandwidth = bandwidth;
 
-    _update_bandwidth((const sx127x_t *)dev);
+    _update_bandwidth(dev);
 
     _low_datarate_optimize(dev);
     
-    _lna_agc_enable((const sx127x_t *)dev);
+    _lna_agc_enable(dev);
 
     /* ERRATA sensitivity tweaks */
     if ((dev->settings.lora.bandwidth == LORA_BW_500_KHZ) &&
@@ -881,10 +884,9 @@ void sx127x_set_preamble_length(sx127x_t *dev, uint16_t preamble)
 
     dev->settings.lora.preamble_len = preamble;
 
-    sx127x_reg_write(dev, SX127X_REG_LR_PREAMBLEMSB,
-                     (preamble >> 8) & 0xFF);
-    sx127x_reg_write(dev, SX127X_REG_LR_PREAMBLELSB,
-                     preamble & 0xFF);
+    uint8_t preamble_regs[2] = { (preamble >> 8) & 0xFF, preamble & 0xFF };
+    sx127x_reg_write_burst(dev, SX127X_REG_LR_PREAMBLEMSB,
+                           preamble_regs, sizeof(preamble_regs));
 }
 
 void sx127x_set_rx_timeout(sx127x_t *dev, uint32_t timeout)
@@ -905,11 +907,13 @@ void sx127x_set_symbol_timeout(sx127x_t *dev, uint16_t timeout)
 {
     DEBUG("[sx127x] Set symbol timeout: %d\n", timeout);
 
-    uint8_t config2_reg = sx127x_reg_read(dev, SX127X_REG_LR_MODEMCONFIG2);
-    config2_reg &= SX127X_RF_LORA_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK;
-    config2_reg |= (timeout >> 8) & ~SX127X_RF_LORA_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK;
-    sx127x_reg_write(dev, SX127X_REG_LR_MODEMCONFIG2, config2_reg);
-    sx127x_reg_write(dev, SX127X_REG_LR_SYMBTIMEOUTLSB,timeout & 0xFF);
+    /* MODEMCONFIG2 is followed by SYMBTIMEOUTLSB */
+    uint8_t regs[2];
+    regs[0] = sx127x_reg_read(dev, SX127X_REG_LR_MODEMCONFIG2);
+    regs[0] &= SX127X_RF_LORA_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK;
+    regs[0] |= (timeout >> 8) & ~SX127X_RF_LORA_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK;
+    regs[1] = timeout & 0xFF;
+    sx127x_reg_write_burst(dev, SX127X_REG_LR_MODEMCONFIG2, regs, sizeof(regs));
 }
 
 bool sx127x_get_iq_invert(const sx127x_t *dev)
@@ -25,8 +25,6 @@
 #include <stdbool.h>
 #include <inttypes.h>
 
-#include "irq.h"
-
 #include "net/lora.h"
 
 #include "sx127x.h"
@@ -65,7 +63,107 @@ int sx127x_check_version(sx127x_t *dev)
     return 0;
 }
 
-void sx127x_reg_write(const sx127x_t *dev, uint8_t addr, uint8_t data)
+/* Configuration registers of the LoRa page, only the driver changes them */
+static bool _reg_cacheable(const sx127x_internal_t *cache, uint8_t addr)
+{
+    if (!cache->reg_cache_lora) {
+        return false;
+    }
+
+    switch (addr) {
+        case SX127X_REG_LR_FRFMSB:
+        case SX127X_REG_LR_FRFMID:
+        case SX127X_REG_LR_FRFLSB:
+        case SX127X_REG_LR_PACONFIG:
+        case SX127X_REG_LR_PARAMP:
+        case SX127X_REG_LR_OCP:
+        case SX127X_REG_LR_LNA:
+        case SX127X_REG_LR_FIFOTXBASEADDR:
+        case SX127X_REG_LR_FIFORXBASEADDR:
+        case SX127X_REG_LR_IRQFLAGSMASK:
+        case SX127X_REG_LR_MODEMCONFIG1:
+        case SX127X_REG_LR_MODEMCONFIG2:
+        case SX127X_REG_LR_SYMBTIMEOUTLSB:
+        case SX127X_REG_LR_PREAMBLEMSB:
+        case SX127X_REG_LR_PREAMBLELSB:
+        case SX127X_REG_LR_PAYLOADLENGTH:
+        case SX127X_REG_LR_PAYLOADMAXLENGTH:
+        case SX127X_REG_LR_HOPPERIOD:
+        case SX127X_REG_LR_MODEMCONFIG3:
+        case SX127X_REG_LR_DETECTOPTIMIZE:
+        case SX127X_REG_LR_INVERTIQ:
+        case SX127X_REG_LR_DETECTIONTHRESHOLD:
+        case SX127X_REG_LR_SYNCWORD:
+        case SX127X_REG_LR_INVERTIQ2:
+        case SX127X_REG_LR_DIOMAPPING1:
+        case SX127X_REG_LR_DIOMAPPING2:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static inline bool _reg_cached(const sx127x_internal_t *cache, uint8_t addr)
+{
+    return _reg_cacheable(cache, addr) &&
+           (cache->reg_cache_valid[addr >> 3] & (1 << (addr & 7)));
+}
+
+/* Must be called with the bus acquired, so the shadow follows the order of SPI transfers */
+static void _reg_cache_update(sx127x_internal_t *cache, uint8_t addr, const uint8_t *buffer,
+                              uint8_t size)
+{
+    for (unsigned i = 0; i < size; i++, addr++) {
+        if (addr == SX127X_REG_OPMODE) {
+            /* Registers are paged by the modem type */
+            bool lora = (buffer[i] & SX127X_RF_LORA_OPMODE_LONGRANGEMODE_ON) != 0;
+            if (lora != cache->reg_cache_lora) {
+                memset(cache->reg_cache_valid, 0, sizeof(cache->reg_cache_valid));
+                cache->reg_cache_lora = lora;
+            }
+        }
+        else if (_reg_cacheable(cache, addr)) {
+            cache->reg_cache[addr] = buffer[i];
+            cache->reg_cache_valid[addr >> 3] |= (1 << (addr & 7));
+        }
+    }
+}
+
+void sx127x_reg_cache_reset(sx127x_t *dev)
+{
+    sx127x_internal_t *cache = &dev->_internal;
+
+    spi_acquire(dev->params.spi, SPI_CS_UNDEF, SX127X_SPI_MODE, SX127X_SPI_SPEED);
+
+    memset(cache->reg_cache_valid, 0, sizeof(cache->reg_cache_valid));
+    cache->reg_cache_lora = false;
+
+    spi_release(dev->params.spi);
+}
+
+/*
+ * The bus lock is enough to keep transfers and the shadow consistent, interrupts
+ * are not masked so their latency doesn't depend on the FIFO burst length.
+ * FIFO bursts use DMA if the board configures it for the SPI bus.
+ * Callers acquire the bus.
+ */
+static void _write_burst(const sx127x_t *dev, uint8_t addr, uint8_t *buffer,
+                         uint8_t size)
+{
+    gpio_clear(dev->params.nss_pin);
+    spi_transfer_regs(dev->params.spi, SPI_CS_UNDEF, addr | 0x80, (char *) buffer, NULL, size);
+    gpio_set(dev->params.nss_pin);
+}
+
+static void _read_burst(const sx127x_t *dev, uint8_t addr, uint8_t *buffer,
+                        uint8_t size)
+{
+    gpio_clear(dev->params.nss_pin);
+    spi_transfer_regs(dev->params.spi, SPI_CS_UNDEF, addr & 0x7F, NULL, (char *) buffer, size);
+    gpio_set(dev->params.nss_pin);
+}
+
+void sx127x_reg_write(sx127x_t *dev, uint8_t addr, uint8_t data)
 {
     sx127x_reg_write_burst(dev, addr, &data, 1);
 }
@@ -79,48 +177,72 @@ uint8_t sx127x_reg_read(const sx127x_t *dev, uint8_t addr)
     return data;
 }
 
-void sx127x_reg_write_burst(const sx127x_t *dev, uint8_t addr, uint8_t *buffer,
+void sx127x_reg_write_burst(sx127x_t *dev, uint8_t addr, uint8_t *buffer,
                             uint8_t size)
 {
-    unsigned int cpsr;
+    sx127x_internal_t *cache = &dev->_internal;
+    uint8_t first = 0;
+    uint8_t last = size;
 
     spi_acquire(dev->params.spi, SPI_CS_UNDEF, SX127X_SPI_MODE, SX127X_SPI_SPEED);
-    cpsr = irq_disable();
 
-    gpio_clear(dev->params.nss_pin);
-    spi_transfer_regs(dev->params.spi, SPI_CS_UNDEF, addr | 0x80, (char *) buffer, NULL, size);
-    gpio_set(dev->params.nss_pin);
+    if (addr != SX127X_REG_FIFO) {
+        /* Only the registers which actually change are sent */
+        while ((first < last) && _reg_cached(cache, addr + first) &&
+               (cache->reg_cache[addr + first] == buffer[first])) {
+            first++;
+        }
+
+        while ((last > first) && _reg_cached(cache, addr + last - 1) &&
+               (cache->reg_cache[addr + last - 1] == buffer[last - 1])) {
+            last--;
+        }
+    }
+
+    if (first < last) {
+        _write_burst(dev, addr + first, buffer + first, last - first);
+
+        if (addr != SX127X_REG_FIFO) {
+            _reg_cache_update(cache, addr + first, buffer + first, last - first);
+        }
+    }
 
-    irq_restore(cpsr);
     spi_release(dev->params.spi);
 }
 
 void sx127x_reg_read_burst(const sx127x_t *dev, uint8_t addr, uint8_t *buffer,
                            uint8_t size)
 {
-    unsigned int cpsr;
-
-    cpsr = irq_disable();
+    const sx127x_internal_t *cache = &dev->_internal;
+    uint8_t i = 0;
 
     spi_acquire(dev->params.spi, SPI_CS_UNDEF, SX127X_SPI_MODE, SX127X_SPI_SPEED);
 
-    gpio_clear(dev->params.nss_pin);
-    spi_transfer_regs(dev->params.spi, SPI_CS_UNDEF, addr & 0x7F, NULL, (char *) buffer, size);
-    gpio_set(dev->params.nss_pin);
+    /* Shadow is filled by writes only, so reads don't change the device descriptor */
+    if (addr != SX127X_REG_FIFO) {
+        while ((i < size) && _reg_cached(cache, addr + i)) {
+            i++;
+        }
+    }
 
-    spi_release(dev->params.spi);
+    if (i < size) {
+        _read_burst(dev, addr, buffer, size);
+    }
+    else {
+        memcpy(buffer, &cache->reg_cache[addr], size);
+    }
 
-    irq_restore(cpsr);
+    spi_release(dev->params.spi);
 }
 
-void sx127x_write_fifo(const sx127x_t *dev, uint8_t *buffer, uint8_t size)
+void sx127x_write_fifo(sx127x_t *dev, uint8_t *buffer, uint8_t size)
 {
-    sx127x_reg_write_burst(dev, 0, buffer, size);
+    sx127x_reg_write_burst(dev, SX127X_REG_FIFO, buffer, size);
 }
 
 void sx127x_read_fifo(const sx127x_t *dev, uint8_t *buffer, uint8_t size)
 {
-    sx127x_reg_read_burst(dev, 0, buffer, size);
+    sx127x_reg_read_burst(dev, SX127X_REG_FIFO, buffer, size);
 }
 
 void sx1276_rx_chain_calibration(sx127x_t *dev)
@@ -26,6 +26,7 @@
  */
 
 #include <string.h>
+#include <stddef.h>
 
 #include "msg.h"
 #include "mutex.h"
@@ -41,6 +42,11 @@
 #include "LoRaMac.h"
 #include "region/Region.h"
 
+#ifdef MODULE_PERIPH_EEPROM
+#include "periph/eeprom.h"
+#include "checksum/fletcher16.h"
+#endif
+
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
@@ -79,6 +85,38 @@ typedef struct {
 
 typedef void (*semtech_loramac_func_t)(semtech_loramac_t *, void *);
 
+#ifdef MODULE_PERIPH_EEPROM
+/* Channels covered by the saved session, default and CFList ones */
+#define SESSION_CHANNELS        (16U)
+
+/**
+ * @brief   MAC session as stored in EEPROM
+ */
+typedef struct {
+    uint16_t owner;                              /**< checksum of the join credentials */
+    uint8_t devaddr[LORAMAC_DEVADDR_LEN];        /**< device address */
+    uint8_t nwkskey[LORAMAC_NWKSKEY_LEN];        /**< network session key */
+    uint8_t appskey[LORAMAC_APPSKEY_LEN];        /**< application session key */
+    uint32_t fcnt_up;                            /**< uplink counter to continue from */
+    uint32_t fcnt_down;                          /**< last downlink counter received */
+    uint32_t rx2_frequency;                      /**< RX2 window frequency */
+    uint32_t rx_delay;                           /**< RX1 window delay, ms */
+    uint32_t channel_freq[SESSION_CHANNELS];     /**< channel frequencies, 0 if not defined */
+    uint8_t channel_dr[SESSION_CHANNELS];        /**< channel datarate ranges */
+    uint16_t channels_mask;                      /**< enabled channels */
+    uint8_t rx1_dr_offset;                       /**< RX1 window datarate offset */
+    uint8_t rx2_dr;                              /**< RX2 window datarate */
+    uint16_t crc;                                /**< checksum of the fields above */
+} semtech_loramac_session_t;
+
+#define SESSION_SLOT_ADDR(slot) (SEMTECH_LORAMAC_SESSION_EEPROM_ADDR + \
+                                 (slot) * sizeof(semtech_loramac_session_t))
+#define SESSION_CRC_LEN         (offsetof(semtech_loramac_session_t, crc))
+
+/* RX1 datarate offset has no MIB attribute in LoRaMAC 4.4.1, it is kept in its parameters */
+extern LoRaMacParams_t LoRaMacParams;
+#endif
+
 /**
  * @brief   Struct containing a semtech loramac function call
  *
@@ -329,6 +367,7 @@ void _init_loramac(semtech_loramac_t *mac,
     semtech_loramac_set_tx_port(mac, LORAMAC_DEFAULT_TX_PORT);
     semtech_loramac_set_tx_mode(mac, LORAMAC_DEFAULT_TX_MODE);
     mac->link_chk.available = false;
+    mac->fcnt_up_reserved = 0;
 }
 
 static void _join_otaa(semtech_loramac_t *mac)
@@ -414,6 +453,236 @@ static void _join_abp(semtech_loramac_t *mac)
     mutex_unlock(&mac->lock);
 }
 
+#ifdef MODULE_PERIPH_EEPROM
+/* Session belongs to the credentials it was joined with */
+static uint16_t _session_owner(const semtech_loramac_t *mac)
+{
+    uint8_t credentials[LORAMAC_DEVEUI_LEN + LORAMAC_APPEUI_LEN + LORAMAC_APPKEY_LEN];
+
+    memcpy(credentials, mac->deveui, LORAMAC_DEVEUI_LEN);
+    memcpy(credentials + LORAMAC_DEVEUI_LEN, mac->appeui, LORAMAC_APPEUI_LEN);
+    memcpy(credentials + LORAMAC_DEVEUI_LEN + LORAMAC_APPEUI_LEN, mac->appkey,
+           LORAMAC_APPKEY_LEN);
+
+    return fletcher16(credentials, sizeof(credentials));
+}
+
+static bool _session_read(const semtech_loramac_t *mac, uint8_t slot,
+                          semtech_loramac_session_t *session)
+{
+    if (eeprom_read(SESSION_SLOT_ADDR(slot), (uint8_t *)session,
+                    sizeof(semtech_loramac_session_t)) != sizeof(semtech_loramac_session_t)) {
+        return false;
+    }
+
+    return (session->crc == fletcher16((uint8_t *)session, SESSION_CRC_LEN)) &&
+           (session->owner == _session_owner(mac));
+}
+
+/* Must be called from the MAC thread */
+static void _session_save(semtech_loramac_t *mac)
+{
+    semtech_loramac_session_t session;
+    memset(&session, 0, sizeof(session));
+
+    session.owner = _session_owner(mac);
+
+    MibRequestConfirm_t mibReq;
+    mibReq.Type = MIB_DEV_ADDR;
+    LoRaMacMibGetRequestConfirm(&mibReq);
+    session.devaddr[0] = (mibReq.Param.DevAddr >> 24) & 0xFF;
+    session.devaddr[1] = (mibReq.Param.DevAddr >> 16) & 0xFF;
+    session.devaddr[2] = (mibReq.Param.DevAddr >> 8) & 0xFF;
+    session.devaddr[3] = mibReq.Param.DevAddr & 0xFF;
+
+    mibReq.Type = MIB_NWK_SKEY;
+    LoRaMacMibGetRequestConfirm(&mibReq);
+    memcpy(session.nwkskey, mibReq.Param.NwkSKey, LORAMAC_NWKSKEY_LEN);
+
+    mibReq.Type = MIB_APP_SKEY;
+    LoRaMacMibGetRequestConfirm(&mibReq);
+    memcpy(session.appskey, mibReq.Param.AppSKey, LORAMAC_APPSKEY_LEN);
+
+    mibReq.Type = MIB_UPLINK_COUNTER;
+    LoRaMacMibGetRequestConfirm(&mibReq);
+    session.fcnt_up = mibReq.Param.UpLinkCounter + SEMTECH_LORAMAC_FCNT_RESERVE;
+
+    /* Stale FCntDown only has to stay below the server's next one, which is accepted
+     * anywhere within MAX_FCNT_GAP, so it is saved along with the FCntUp reservation */
+    mibReq.Type = MIB_DOWNLINK_COUNTER;
+    LoRaMacMibGetRequestConfirm(&mibReq);
+    session.fcnt_down = mibReq.Param.DownLinkCounter;
+
+    /* Parameters set by the join accept and MAC commands */
+    session.rx1_dr_offset = LoRaMacParams.Rx1DrOffset;
+
+    mibReq.Type = MIB_RX2_CHANNEL;
+    LoRaMacMibGetRequestConfirm(&mibReq);
+    session.rx2_frequency = mibReq.Param.Rx2Channel.Frequency;
+    session.rx2_dr = mibReq.Param.Rx2Channel.Datarate;
+
+    mibReq.Type = MIB_RECEIVE_DELAY_1;
+    LoRaMacMibGetRequestConfirm(&mibReq);
+    session.rx_delay = mibReq.Param.ReceiveDelay1;
+
+    mibReq.Type = MIB_CHANNELS;
+    LoRaMacMibGetRequestConfirm(&mibReq);
+    for (unsigned i = 0; i < SESSION_CHANNELS; i++) {
+        session.channel_freq[i] = mibReq.Param.ChannelList[i].Frequency;
+        session.channel_dr[i] = mibReq.Param.ChannelList[i].DrRange.Value;
+    }
+
+    mibReq.Type = MIB_CHANNELS_MASK;
+    LoRaMacMibGetRequestConfirm(&mibReq);
+    session.channels_mask = mibReq.Param.ChannelsMask[0];
+
+    session.crc = fletcher16((uint8_t *)&session, SESSION_CRC_LEN);
+
+    /* Copies are written in turn, so a reset during the write leaves the other one intact */
+    mac->session_slot ^= 1;
+    eeprom_write(SESSION_SLOT_ADDR(mac->session_slot), (uint8_t *)&session, sizeof(session));
+    mac->fcnt_up_reserved = session.fcnt_up;
+
+    DEBUG("[semtech-loramac] session saved, FCntUp reserved up to %" PRIu32
+          ", FCntDown %" PRIu32 "\n", session.fcnt_up, session.fcnt_down);
+}
+
+/* Saves the session when FCntUp reaches the reserved value */
+static void _session_checkpoint(semtech_loramac_t *mac)
+{
+    MibRequestConfirm_t mibReq;
+    mibReq.Type = MIB_NETWORK_JOINED;
+    LoRaMacMibGetRequestConfirm(&mibReq);
+    if (!mibReq.Param.IsNetworkJoined || (mac->fcnt_up_reserved == 0)) {
+        return;
+    }
+
+    mibReq.Type = MIB_UPLINK_COUNTER;
+    LoRaMacMibGetRequestConfirm(&mibReq);
+    if (mibReq.Param.UpLinkCounter >= mac->fcnt_up_reserved) {
+        _session_save(mac);
+    }
+}
+
+static void _session_restore(semtech_loramac_t *mac, void *arg)
+{
+    bool *restored = arg;
+    semtech_loramac_session_t session[2];
+    bool valid[2];
+
+    *restored = false;
+
+    valid[0] = _session_read(mac, 0, &session[0]);
+    valid[1] = _session_read(mac, 1, &session[1]);
+
+    if (!valid[0] && !valid[1]) {
+        DEBUG("[semtech-loramac] no saved session\n");
+        mac->state = SEMTECH_LORAMAC_STATE_IDLE;
+        return;
+    }
+
+    /* Use the most recent copy, each save reserves higher FCntUp */
+    bool newer = (session[0].fcnt_up > session[1].fcnt_up);
+    uint8_t slot = (valid[0] && (!valid[1] || newer)) ? 0 : 1;
+    semtech_loramac_session_t *s = &session[slot];
+    mac->session_slot = slot;
+
+    memcpy(mac->devaddr, s->devaddr, LORAMAC_DEVADDR_LEN);
+    memcpy(mac->nwkskey, s->nwkskey, LORAMAC_NWKSKEY_LEN);
+    memcpy(mac->appskey, s->appskey, LORAMAC_APPSKEY_LEN);
+
+    mutex_lock(&mac->lock);
+    MibRequestConfirm_t mibReq;
+    mibReq.Type = MIB_NETWORK_JOINED;
+    mibReq.Param.IsNetworkJoined = false;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+
+    mibReq.Type = MIB_DEV_ADDR;
+    mibReq.Param.DevAddr = ((uint32_t)mac->devaddr[0] << 24 |
+                            (uint32_t)mac->devaddr[1] << 16 |
+                            (uint32_t)mac->devaddr[2] << 8 |
+                            (uint32_t)mac->devaddr[3]);
+    LoRaMacMibSetRequestConfirm(&mibReq);
+
+    mibReq.Type = MIB_NWK_SKEY;
+    mibReq.Param.NwkSKey = mac->nwkskey;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+
+    mibReq.Type = MIB_APP_SKEY;
+    mibReq.Param.AppSKey = mac->appskey;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+
+    mibReq.Type = MIB_UPLINK_COUNTER;
+    mibReq.Param.UpLinkCounter = s->fcnt_up;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+
+    mibReq.Type = MIB_DOWNLINK_COUNTER;
+    mibReq.Param.DownLinkCounter = s->fcnt_down;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+
+    /* Join accept parameters, CFList channels override the ones added on init */
+    LoRaMacParams.Rx1DrOffset = s->rx1_dr_offset;
+
+    mibReq.Type = MIB_RX2_CHANNEL;
+    mibReq.Param.Rx2Channel.Frequency = s->rx2_frequency;
+    mibReq.Param.Rx2Channel.Datarate = s->rx2_dr;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+
+    mibReq.Type = MIB_RECEIVE_DELAY_1;
+    mibReq.Param.ReceiveDelay1 = s->rx_delay;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+
+    mibReq.Type = MIB_RECEIVE_DELAY_2;
+    mibReq.Param.ReceiveDelay2 = s->rx_delay + 1000;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+
+    for (unsigned i = 0; i < SESSION_CHANNELS; i++) {
+        if (s->channel_freq[i] == 0) {
+            continue;
+        }
+
+        /* Default channels are rejected by the region, they are kept as they are */
+        ChannelParams_t channel;
+        memset(&channel, 0, sizeof(channel));
+        channel.Frequency = s->channel_freq[i];
+        channel.DrRange.Value = s->channel_dr[i];
+        LoRaMacChannelAdd(i, channel);
+    }
+
+    uint16_t channels_mask[6] = { s->channels_mask };
+    mibReq.Type = MIB_CHANNELS_MASK;
+    mibReq.Param.ChannelsMask = channels_mask;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+
+    mibReq.Type = MIB_NETWORK_JOINED;
+    mibReq.Param.IsNetworkJoined = true;
+    LoRaMacMibSetRequestConfirm(&mibReq);
+    mutex_unlock(&mac->lock);
+
+    /* Reserve the next counters before the first uplink */
+    _session_save(mac);
+
+    *restored = true;
+
+    /* switch back to idle state now*/
+    mac->state = SEMTECH_LORAMAC_STATE_IDLE;
+}
+
+static void _session_save_cmd(semtech_loramac_t *mac, void *arg)
+{
+    (void) arg;
+
+    MibRequestConfirm_t mibReq;
+    mibReq.Type = MIB_NETWORK_JOINED;
+    LoRaMacMibGetRequestConfirm(&mibReq);
+    if (mibReq.Param.IsNetworkJoined) {
+        _session_save(mac);
+    }
+
+    mac->state = SEMTECH_LORAMAC_STATE_IDLE;
+}
+#endif
+
 static void _join(semtech_loramac_t *mac, void *arg)
 {
     uint8_t join_type = *(uint8_t *)arg;
@@ -569,6 +838,11 @@ void *_semtech_loramac_event_loop(void *arg)
                     DEBUG("[semtech-loramac] loramac join notification\n");
                     msg_t msg_ret;
                     msg_ret.content.value = msg.content.value;
+#ifdef MODULE_PERIPH_EEPROM
+                    if (msg.content.value == SEMTECH_LORAMAC_JOIN_SUCCEEDED) {
+                        _session_save(mac);
+                    }
+#endif
                     msg_send(&msg_ret, mac->caller_pid);
                     /* switch back to idle state now*/
                     mac->state = SEMTECH_LORAMAC_STATE_IDLE;
@@ -590,6 +864,9 @@ void *_semtech_loramac_event_loop(void *arg)
                 case MSG_TYPE_LORAMAC_TX_DONE:
                 {
                     DEBUG("[semtech-loramac] loramac TX done\n");
+#ifdef MODULE_PERIPH_EEPROM
+                    _session_checkpoint(mac);
+#endif
                     msg_t msg_ret;
                     msg_ret.type = MSG_TYPE_LORAMAC_TX_DONE;
                     msg_send(&msg_ret, mac->caller_pid);
@@ -608,6 +885,9 @@ void *_semtech_loramac_event_loop(void *arg)
                 }
                 case MSG_TYPE_LORAMAC_TX_CNF_FAILED:
                     DEBUG("[semtech-loramac] loramac TX failed\n");
+#ifdef MODULE_PERIPH_EEPROM
+                    _session_checkpoint(mac);
+#endif
                     msg_t msg_ret;
                     msg_ret.type = MSG_TYPE_LORAMAC_TX_CNF_FAILED;
                     msg_send(&msg_ret, mac->caller_pid);
@@ -616,6 +896,9 @@ void *_semtech_loramac_event_loop(void *arg)
                     break;
                 case MSG_TYPE_LORAMAC_RX:
                 {
+#ifdef MODULE_PERIPH_EEPROM
+                    _session_checkpoint(mac);
+#endif
                     msg_t msg_ret;
                     msg_ret.type = MSG_TYPE_LORAMAC_RX;
                     McpsIndication_t *indication = (McpsIndication_t *)msg.content.ptr;
@@ -697,6 +980,48 @@ uint8_t semtech_loramac_join(semtech_loramac_t *mac, uint8_t type)
     return SEMTECH_LORAMAC_JOIN_SUCCEEDED;
 }
 
+bool semtech_loramac_restore_session(semtech_loramac_t *mac)
+{
+#ifdef MODULE_PERIPH_EEPROM
+    if (mac->state != SEMTECH_LORAMAC_STATE_IDLE) {
+        DEBUG("[semtech-loramac] internal mac is busy\n");
+        return false;
+    }
+
+    bool restored = false;
+    _semtech_loramac_call(_session_restore, &restored);
+
+    return restored;
+#else
+    (void) mac;
+    return false;
+#endif
+}
+
+void semtech_loramac_save_session(semtech_loramac_t *mac)
+{
+#ifdef MODULE_PERIPH_EEPROM
+    if (mac->state != SEMTECH_LORAMAC_STATE_IDLE) {
+        DEBUG("[semtech-loramac] internal mac is busy\n");
+        return;
+    }
+
+    _semtech_loramac_call(_session_save_cmd, NULL);
+#else
+    (void) mac;
+#endif
+}
+
+void semtech_loramac_erase_session(semtech_loramac_t *mac)
+{
+#ifdef MODULE_PERIPH_EEPROM
+    eeprom_clear(SESSION_SLOT_ADDR(0), 2 * sizeof(semtech_loramac_session_t));
+    mac->fcnt_up_reserved = 0;
+#else
+    (void) mac;
+#endif
+}
+
 void semtech_loramac_request_link_check(semtech_loramac_t *mac)
 {
     mutex_lock(&mac->lock);
@@ -54,6 +54,24 @@ extern "C" {
  */
 #define LORAWAN_APP_DATA_MAX_SIZE      (242U)
 
+/**
+ * @brief   EEPROM address of the saved MAC session (two copies are kept)
+ */
+#ifndef SEMTECH_LORAMAC_SESSION_EEPROM_ADDR
+#define SEMTECH_LORAMAC_SESSION_EEPROM_ADDR  (3584U)
+#endif
+
+/**
+ * @brief   Number of uplink counter values reserved by each session checkpoint
+ *
+ * The session is written to EEPROM once per this number of uplinks, the
+ * restored node continues from the reserved value so uplink counters are never
+ * reused. The downlink counter is saved as it is on each accepted downlink.
+ */
+#ifndef SEMTECH_LORAMAC_FCNT_RESERVE
+#define SEMTECH_LORAMAC_FCNT_RESERVE         (32U)
+#endif
+
 /**
  * @brief   LoRaMAC return status
  */
@@ -126,6 +144,8 @@ typedef struct {
     uint8_t devaddr[LORAMAC_DEVADDR_LEN];        /**< device address */
     semtech_loramac_rx_data_t rx_data;           /**< struct handling the RX data */
     semtech_loramac_link_check_info_t link_chk;  /**< link check information */
+    uint32_t fcnt_up_reserved;                   /**< uplink counter reserved by the saved session */
+    uint8_t session_slot;                        /**< EEPROM copy of the session written last */
 } semtech_loramac_t;
 
 /**
@@ -187,6 +207,36 @@ uint8_t semtech_loramac_send(semtech_loramac_t *mac, uint8_t *data, uint8_t len)
  */
 uint8_t semtech_loramac_recv(semtech_loramac_t *mac);
 
+/**
+ * @brief   Restores the MAC session saved after the last OTAA join
+ *
+ * The session (device address, session keys, frame counters, RX windows
+ * parameters and the channels from the join accept) is saved automatically
+ * on join and checkpointed every SEMTECH_LORAMAC_FCNT_RESERVE uplinks, so a
+ * restarted node can resume sending without joining again.
+ * Session saved for other DevEUI, AppEUI or AppKey is ignored.
+ *
+ * @param[in] mac          Pointer to the mac
+ *
+ * @return true if the session was restored and the MAC is joined
+ * @return false if there is no valid session saved
+ */
+bool semtech_loramac_restore_session(semtech_loramac_t *mac);
+
+/**
+ * @brief   Saves the current MAC session, e.g. before entering deep sleep
+ *
+ * @param[in] mac          Pointer to the mac
+ */
+void semtech_loramac_save_session(semtech_loramac_t *mac);
+
+/**
+ * @brief   Forgets the saved MAC session, the node will have to join again
+ *
+ * @param[in] mac          Pointer to the mac
+ */
+void semtech_loramac_erase_session(semtech_loramac_t *mac);
+
 /**
  * @brief   Requests a LoRaWAN link check
  *
@@ -32,6 +32,10 @@
 #ifndef RTCTIMERS_MILLIS_ISR_BACKOFF
     #define RTCTIMERS_MILLIS_ISR_BACKOFF 4
 #endif
+/* Number of waiting timers checked for an open slack window on each wakeup, 0 disables */
+#ifndef RTCTIMERS_MILLIS_SCAN_MAX
+    #define RTCTIMERS_MILLIS_SCAN_MAX 4
+#endif
 
 typedef void (*rtctimers_millis_cb_t)(void*);
 
@@ -43,6 +47,8 @@ typedef struct rtctimers_millis {
 
 	rtctimers_millis_cb_t callback;
 	void *arg;
+
+	uint32_t slack;     /**< Timer may fire that much earlier than target [ms] */
 } rtctimers_millis_t;
 
 void rtctimers_millis_init(void);
@@ -52,6 +58,29 @@ void rtctimers_millis_sleep(uint32_t sleep_millis);
 void rtctimers_millis_set_msg(rtctimers_millis_t *timer, uint32_t offset, msg_t *msg, kernel_pid_t target_pid);
 uint32_t rtctimers_millis_now(void);
 
+/**
+ * @brief Sets the timer to fire anywhere from offset to offset + slack milliseconds from now
+ *
+ * Core fires such timers along with the earlier ones whenever their window
+ * has already opened, so the MCU wakes up once for all of them. Only the
+ * first RTCTIMERS_MILLIS_SCAN_MAX waiting timers are checked, the ones
+ * further down wait for their own wakeup. Timer set with no slack keeps
+ * firing at offset exactly.
+ */
+void rtctimers_millis_set_slack(rtctimers_millis_t *timer, uint32_t offset, uint32_t slack);
+void rtctimers_millis_set_msg_slack(rtctimers_millis_t *timer, uint32_t offset, uint32_t slack,
+                                    msg_t *msg, kernel_pid_t target_pid);
+
+/**
+ * @brief Returns number of the timer wakeups since the start
+ */
+uint32_t rtctimers_millis_wakeups(void);
+
+/**
+ * @brief Returns number of the wakeups saved by firing the timers early within their slack
+ */
+uint32_t rtctimers_millis_wakeups_saved(void);
+
 /**
  * @brief Returns time in milliseconds since 00:00:00 Sunday
  */
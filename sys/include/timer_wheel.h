@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_timer_wheel Hierarchical timing wheel
+ * @ingroup     sys
+ * @brief       Ordered set of timers with constant time insertion
+ *
+ * Backend of the xtimer and rtctimers-millis timer lists, enabled by the
+ * xtimer_wheel and rtctimers_millis_wheel modules.
+ *
+ * Timers are keyed by the 64-bit absolute target time. The wheel keeps a
+ * cursor, which is never later than the earliest timer, and puts the timer
+ * on the level given by the highest 4-bit digit its key differs from the
+ * cursor in, into the slot given by that digit. All the timers on a level
+ * are earlier than the timers on the next one, the slots of a level are in
+ * order too, so the earliest timer is in the first occupied slot of the
+ * lowest occupied level. Level 0 slot holds the timers of the same key.
+ *
+ * Insertion is constant time. The earliest timer is found through the
+ * occupied slots bitmaps; when it is on a higher level, the cursor advances
+ * to the start of that slot and its timers are spread over the lower levels,
+ * at most once per level for each timer. Removal walks the single slot the
+ * timer is in, so the timer has no extra links and removing a timer that was
+ * never added is harmless.
+ *
+ * Timers further than 2^32 ticks from the cursor are kept in the unsorted far
+ * list until the wheel runs empty.
+ *
+ * Timers of the same key are returned in the order they were added.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Hierarchical timing wheel API
+ *
+ * @author      Oleg Artamonov
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+
+#include "list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Bits of the key per wheel level
+ */
+#define TIMER_WHEEL_BITS    (4)
+
+/**
+ * @brief Number of slots on a level
+ */
+#define TIMER_WHEEL_SLOTS   (1 << TIMER_WHEEL_BITS)
+
+/**
+ * @brief Number of levels, the wheel covers 2^32 ticks
+ */
+#define TIMER_WHEEL_LEVELS  (32 / TIMER_WHEEL_BITS)
+
+/**
+ * @brief Returns the absolute target time of the timer
+ *
+ * Timer structure has to start with the next pointer, which is used as
+ * the list node by the wheel.
+ */
+typedef uint64_t (*timer_wheel_key_t)(const list_node_t *timer);
+
+/**
+ * @brief Timing wheel
+ */
+typedef struct {
+    list_node_t *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];  /**< Timers */
+    uint16_t occupied[TIMER_WHEEL_LEVELS];  /**< Non-empty slots bitmaps */
+    list_node_t *far;                       /**< Timers beyond the levels */
+    list_node_t *first;                     /**< Earliest timer, NULL if not known yet */
+    uint64_t cursor;                        /**< Levels are relative to this time */
+    timer_wheel_key_t key;                  /**< Key of the timer */
+} timer_wheel_t;
+
+/**
+ * @brief Initializes the wheel.
+ *
+ * @param[out] wheel    wheel to initialize
+ * @param[in]  key      function returning the target time of the timer
+ */
+void timer_wheel_init(timer_wheel_t *wheel, timer_wheel_key_t key);
+
+/**
+ * @brief Adds the timer.
+ *
+ * Timer's key must not change while it is in the wheel. Keys earlier than
+ * the ones already returned by timer_wheel_first() are allowed, such timers
+ * become the earliest ones.
+ *
+ * @param[in]  wheel    wheel to add to
+ * @param[in]  timer    timer to add
+ */
+void timer_wheel_add(timer_wheel_t *wheel, list_node_t *timer);
+
+/**
+ * @brief Removes the timer.
+ *
+ * @param[in]  wheel    wheel to remove from
+ * @param[in]  timer    timer to remove
+ *
+ * @return 1 if the timer was removed
+ * @return 0 if the timer is not in the wheel
+ */
+int timer_wheel_remove(timer_wheel_t *wheel, list_node_t *timer);
+
+/**
+ * @brief Returns the earliest timer, leaves it in the wheel.
+ *
+ * @param[in]  wheel    wheel to look into
+ *
+ * @return earliest timer, NULL if the wheel is empty
+ */
+list_node_t *timer_wheel_first(timer_wheel_t *wheel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMER_WHEEL_H */
+/** @} */
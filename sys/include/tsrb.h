@@ -155,6 +155,50 @@ int tsrb_add_one(tsrb_t *rb, char c);
  */
 int tsrb_add(tsrb_t *rb, const char *src, size_t n);
 
+/**
+ * @brief       Get oldest bytes of ringbuffer without removing them
+ *
+ * Bytes are returned in place, so only the contiguous part of the data is
+ * returned when it wraps around the end of the buffer.
+ *
+ * @param[in]   rb      Ringbuffer to operate on
+ * @param[out]  data    pointer to the first byte
+ * @return      nr of bytes available at @p data, 0 if ringbuffer is empty
+ */
+unsigned int tsrb_peek_chunk(const tsrb_t *rb, const char **data);
+
+/**
+ * @brief       Remove bytes from ringbuffer without reading them
+ * @param[in]   rb  Ringbuffer to operate on
+ * @param[in]   n   max number of bytes to remove
+ * @return      nr of bytes removed
+ */
+int tsrb_skip(tsrb_t *rb, size_t n);
+
+/**
+ * @brief       Write bytes past the end of data without making them readable
+ *
+ * Single writer may build data in place with a number of calls and publish it
+ * at once with @ref tsrb_commit, so the reader never sees it half written.
+ *
+ * @param[in]   rb      Ringbuffer to operate on
+ * @param[in]   offset  offset of the first byte from the end of data
+ * @param[in]   src     buffer to read from
+ * @param[in]   n       number of bytes to write
+ * @return      0   on success
+ * @return      -1  if bytes don't fit into free space
+ */
+int tsrb_poke(tsrb_t *rb, unsigned offset, const char *src, size_t n);
+
+/**
+ * @brief       Make bytes written by @ref tsrb_poke readable
+ * @param[in]   rb  Ringbuffer to operate on
+ * @param[in]   n   number of bytes to publish
+ * @return      0   on success
+ * @return      -1  if @p n exceeds free space
+ */
+int tsrb_commit(tsrb_t *rb, size_t n);
+
 #ifdef __cplusplus
 }
 #endif
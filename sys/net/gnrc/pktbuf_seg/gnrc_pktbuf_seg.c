@@ -0,0 +1,773 @@
+/*
+ * Copyright (C) 2014 Martine Lenders <mlenders@inf.fu-berlin.de>
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup net_gnrc_pktbuf
+ * @{
+ *
+ * @file
+ * @brief   Static packet buffer with segregated size classes
+ *
+ * Packet buffer of GNRC_PKTBUF_SIZE bytes is managed by the same first-fit
+ * arena with coalescing as in gnrc_pktbuf_static. Released chunks of the
+ * common snip sizes don't go back to the arena though: they are kept on the
+ * free list of their size class and handed out again without a search.
+ * New chunks of the classes are cut off the top of the arena, so the cached
+ * ones don't end up between the big snips allocated from the bottom.
+ * Requests down to three quarters of the class size are rounded up to it,
+ * so e.g. the frames of any length from 97 to 128 bytes share the same chunks.
+ *
+ * Cached chunks are returned to the arena, where they are coalesced with
+ * their neighbours, only when the arena runs out of memory.
+ *
+ * @author  Martine Lenders <mlenders@inf.fu-berlin.de>
+ * @author  Oleg Artamonov
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#include "mutex.h"
+#include "od.h"
+#include "utlist.h"
+#include "net/gnrc/pktbuf.h"
+#include "net/gnrc/nettype.h"
+#include "net/gnrc/pkt.h"
+#include "net/gnrc/netif/hdr.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+/**
+ * @brief   Sizes of the snips kept on the free lists, in ascending order
+ */
+#ifndef GNRC_PKTBUF_SEG_CLASSES
+#define GNRC_PKTBUF_SEG_CLASSES { \
+        8,                                  /* UDP header, 6LoWPAN fragment header */ \
+        sizeof(gnrc_pktsnip_t),             /* snip descriptor */ \
+        sizeof(gnrc_netif_hdr_t) + 2 * 8,   /* netif header with EUI-64 addresses */ \
+        40,                                 /* IPv6 header */ \
+        128,                                /* IEEE 802.15.4 frame */ \
+    }
+#endif
+
+#define _ALIGNMENT_MASK    (sizeof(_unused_t) - 1)
+
+typedef struct _unused {
+    struct _unused *next;
+    unsigned int size;
+} _unused_t;
+
+typedef struct {
+    _unused_t *free;        /* cached chunks */
+    uint16_t size;          /* chunk size */
+    uint16_t min;           /* class serves sizes above this one */
+    uint16_t cached;        /* number of cached chunks */
+} _class_t;
+
+static const uint16_t _class_sizes[] = GNRC_PKTBUF_SEG_CLASSES;
+
+#define _CLASS_NUMOF    (sizeof(_class_sizes) / sizeof(_class_sizes[0]))
+
+static mutex_t _mutex = MUTEX_INIT;
+static uint8_t _pktbuf[GNRC_PKTBUF_SIZE];
+static _unused_t *_first_unused;
+static _class_t _classes[_CLASS_NUMOF];
+
+#ifdef DEVELHELP
+/* maximum number of bytes allocated */
+static uint16_t max_byte_count = 0;
+#endif
+
+/* internal gnrc_pktbuf functions */
+static gnrc_pktsnip_t *_create_snip(gnrc_pktsnip_t *next, const void *data, size_t size,
+                                    gnrc_nettype_t type);
+static void *_pktbuf_alloc(size_t size);
+static void _pktbuf_free(void *data, size_t size);
+static void _chunk_free(void *chunk, size_t size);
+static void *_arena_alloc(size_t size, bool top);
+static void _arena_free(void *data, size_t size);
+
+static inline bool _pktbuf_contains(void *ptr)
+{
+    return (unsigned)((uint8_t *)ptr - _pktbuf) < GNRC_PKTBUF_SIZE;
+}
+
+/* fits size to byte alignment */
+static inline size_t _align(size_t size)
+{
+    return (size + _ALIGNMENT_MASK) & ~(_ALIGNMENT_MASK);
+}
+
+/* returns the class of the chunk of exactly that size */
+static _class_t *_class_of(size_t size)
+{
+    for (unsigned i = 0; i < _CLASS_NUMOF; i++) {
+        if ((_classes[i].size == size) && (size > _classes[i].min)) {
+            return &_classes[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* returns size of the chunk holding size bytes */
+static size_t _chunk_size(size_t size)
+{
+    size = _align(size);
+
+    for (unsigned i = 0; i < _CLASS_NUMOF; i++) {
+        if ((size > _classes[i].min) && (size <= _classes[i].size)) {
+            return _classes[i].size;
+        }
+    }
+
+    return size;
+}
+
+static inline void _set_pktsnip(gnrc_pktsnip_t *pkt, gnrc_pktsnip_t *next,
+                                void *data, size_t size, gnrc_nettype_t type)
+{
+    pkt->next = next;
+    pkt->data = data;
+    pkt->size = size;
+    pkt->type = type;
+    pkt->users = 1;
+#ifdef MODULE_GNRC_NETERR
+    pkt->err_sub = KERNEL_PID_UNDEF;
+#endif
+}
+
+void gnrc_pktbuf_init(void)
+{
+    uint16_t prev = 0;
+
+    mutex_lock(&_mutex);
+    _first_unused = (_unused_t *)_pktbuf;
+    _first_unused->next = NULL;
+    _first_unused->size = sizeof(_pktbuf);
+
+    for (unsigned i = 0; i < _CLASS_NUMOF; i++) {
+        _class_t *class = &_classes[i];
+
+        class->free = NULL;
+        class->cached = 0;
+        class->size = _align(_class_sizes[i]);
+
+        if (class->size <= prev) {
+            /* out of order or duplicate, serves nothing */
+            class->min = class->size;
+            continue;
+        }
+
+        /* aligned sizes are compared against it, so it's left unaligned */
+        class->min = (class->size - class->size / 4 > prev) ?
+                     class->size - class->size / 4 : prev;
+        prev = class->size;
+    }
+    mutex_unlock(&_mutex);
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_add(gnrc_pktsnip_t *next, const void *data, size_t size,
+                                gnrc_nettype_t type)
+{
+    gnrc_pktsnip_t *pkt;
+
+    if (size > GNRC_PKTBUF_SIZE) {
+        DEBUG("pktbuf: size (%u) > GNRC_PKTBUF_SIZE (%u)\n",
+              (unsigned)size, GNRC_PKTBUF_SIZE);
+        return NULL;
+    }
+    mutex_lock(&_mutex);
+    pkt = _create_snip(next, data, size, type);
+    mutex_unlock(&_mutex);
+    return pkt;
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_mark(gnrc_pktsnip_t *pkt, size_t size, gnrc_nettype_t type)
+{
+    gnrc_pktsnip_t *marked_snip;
+    void *new_data_marked;
+
+    mutex_lock(&_mutex);
+    if ((size == 0) || (pkt == NULL) || (size > pkt->size) || (pkt->data == NULL)) {
+        DEBUG("pktbuf: size == 0 (was %u) or pkt == NULL (was %p) or "
+              "size > pkt->size (was %u) or pkt->data == NULL (was %p)\n",
+              (unsigned)size, (void *)pkt, (pkt ? (unsigned)pkt->size : 0),
+              (pkt ? pkt->data : NULL));
+        mutex_unlock(&_mutex);
+        return NULL;
+    }
+    /* create new snip descriptor for marked data */
+    marked_snip = _pktbuf_alloc(sizeof(gnrc_pktsnip_t));
+    if (marked_snip == NULL) {
+        DEBUG("pktbuf: could not reallocate marked section.\n");
+        mutex_unlock(&_mutex);
+        return NULL;
+    }
+    /* both parts have to make chunks of their own to be split in place,
+     * otherwise move data around to allow for proper free */
+    if ((pkt->size != size) &&
+        ((_chunk_size(size) != size) ||
+         (_chunk_size(pkt->size - size) > _chunk_size(pkt->size) - size))) {
+        void *new_data_rest;
+        new_data_marked = _pktbuf_alloc(size);
+        if (new_data_marked == NULL) {
+            DEBUG("pktbuf: could not reallocate marked section.\n");
+            _pktbuf_free(marked_snip, sizeof(gnrc_pktsnip_t));
+            mutex_unlock(&_mutex);
+            return NULL;
+        }
+        new_data_rest = _pktbuf_alloc(pkt->size - size);
+        if (new_data_rest == NULL) {
+            DEBUG("pktbuf: could not reallocate remaining section.\n");
+            _pktbuf_free(marked_snip, sizeof(gnrc_pktsnip_t));
+            _pktbuf_free(new_data_marked, size);
+            mutex_unlock(&_mutex);
+            return NULL;
+        }
+        memcpy(new_data_marked, pkt->data, size);
+        memcpy(new_data_rest, ((uint8_t *)pkt->data) + size, pkt->size - size);
+        _pktbuf_free(pkt->data, pkt->size);
+        marked_snip->data = new_data_marked;
+        pkt->data = new_data_rest;
+    }
+    else {
+        new_data_marked = pkt->data;
+        if (pkt->size != size) {
+            size_t chunk = _chunk_size(pkt->size) - size;
+            size_t rest = _chunk_size(pkt->size - size);
+
+            if (rest < chunk) {
+                /* tail not needed by the remainder becomes a chunk of its own */
+                _chunk_free(((uint8_t *)pkt->data) + size + rest, chunk - rest);
+            }
+        }
+        /* if (pkt->size - size) != 0 take remainder of data, otherwise set NULL */
+        pkt->data = (pkt->size != size) ? (((uint8_t *)pkt->data) + size) :
+                                          NULL;
+    }
+    pkt->size -= size;
+    _set_pktsnip(marked_snip, pkt->next, new_data_marked, size, type);
+    pkt->next = marked_snip;
+    mutex_unlock(&_mutex);
+    return marked_snip;
+}
+
+int gnrc_pktbuf_realloc_data(gnrc_pktsnip_t *pkt, size_t size)
+{
+    size_t new_chunk = _chunk_size(size);
+    size_t old_chunk;
+
+    mutex_lock(&_mutex);
+    assert(pkt != NULL);
+    assert(((pkt->size == 0) && (pkt->data == NULL)) ||
+           ((pkt->size > 0) && (pkt->data != NULL) && _pktbuf_contains(pkt->data)));
+    /* new size and old size are equal */
+    if (size == pkt->size) {
+        /* nothing to do */
+        mutex_unlock(&_mutex);
+        return 0;
+    }
+    old_chunk = _chunk_size(pkt->size);
+    /* new size is 0 and data pointer isn't already NULL */
+    if ((size == 0) && (pkt->data != NULL)) {
+        /* set data pointer to NULL */
+        _pktbuf_free(pkt->data, pkt->size);
+        pkt->data = NULL;
+    }
+    /* new size does not fit into the chunk */
+    else if (new_chunk > old_chunk) {
+        void *new_data = _pktbuf_alloc(size);
+        if (new_data == NULL) {
+            DEBUG("pktbuf: error allocating new data section\n");
+            mutex_unlock(&_mutex);
+            return ENOMEM;
+        }
+        if (pkt->data != NULL) {            /* if old data exist */
+            memcpy(new_data, pkt->data, (pkt->size < size) ? pkt->size : size);
+        }
+        _pktbuf_free(pkt->data, pkt->size);
+        pkt->data = new_data;
+    }
+    else if (old_chunk > new_chunk) {
+        /* tail becomes a chunk of its own */
+        _chunk_free(((uint8_t *)pkt->data) + new_chunk, old_chunk - new_chunk);
+    }
+    pkt->size = size;
+    mutex_unlock(&_mutex);
+    return 0;
+}
+
+void gnrc_pktbuf_hold(gnrc_pktsnip_t *pkt, unsigned int num)
+{
+    mutex_lock(&_mutex);
+    while (pkt) {
+        pkt->users += num;
+        pkt = pkt->next;
+    }
+    mutex_unlock(&_mutex);
+}
+
+static void _release_error_locked(gnrc_pktsnip_t *pkt, uint32_t err)
+{
+    while (pkt) {
+        gnrc_pktsnip_t *tmp;
+        assert(_pktbuf_contains(pkt));
+        assert(pkt->users > 0);
+        tmp = pkt->next;
+        if (pkt->users == 1) {
+            pkt->users = 0; /* not necessary but to be on the safe side */
+            _pktbuf_free(pkt->data, pkt->size);
+            _pktbuf_free(pkt, sizeof(gnrc_pktsnip_t));
+        }
+        else {
+            pkt->users--;
+        }
+        DEBUG("pktbuf: report status code %" PRIu32 "\n", err);
+        gnrc_neterr_report(pkt, err);
+        pkt = tmp;
+    }
+}
+
+void gnrc_pktbuf_release_error(gnrc_pktsnip_t *pkt, uint32_t err)
+{
+    mutex_lock(&_mutex);
+    _release_error_locked(pkt, err);
+    mutex_unlock(&_mutex);
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_start_write(gnrc_pktsnip_t *pkt)
+{
+    mutex_lock(&_mutex);
+    if ((pkt == NULL) || (pkt->size == 0)) {
+        mutex_unlock(&_mutex);
+        return NULL;
+    }
+    if (pkt->users > 1) {
+        gnrc_pktsnip_t *new;
+        new = _create_snip(pkt->next, pkt->data, pkt->size, pkt->type);
+        if (new != NULL) {
+            pkt->users--;
+        }
+        mutex_unlock(&_mutex);
+        return new;
+    }
+    mutex_unlock(&_mutex);
+    return pkt;
+}
+
+/**
+ * @brief returns all the cached chunks to the arena
+ *
+ * @return number of chunks returned
+ */
+static unsigned _flush(void)
+{
+    unsigned count = 0;
+
+    for (unsigned i = 0; i < _CLASS_NUMOF; i++) {
+        _class_t *class = &_classes[i];
+
+        while (class->free) {
+            _unused_t *chunk = class->free;
+            class->free = chunk->next;
+            _arena_free(chunk, class->size);
+            count++;
+        }
+        class->cached = 0;
+    }
+
+    return count;
+}
+
+#ifdef DEVELHELP
+#ifdef MODULE_OD
+static inline void _print_chunk(void *chunk, size_t size, int num)
+{
+    printf("=========== chunk %3d (%-10p size: %4u) ===========\n", num, chunk,
+           (unsigned int)size);
+    od_hex_dump(chunk, size, OD_WIDTH_DEFAULT);
+}
+
+static inline void _print_unused(_unused_t *ptr)
+{
+    printf("~ unused: %p (next: %p, size: %4u) ~\n", (void *)ptr,
+           (void *)ptr->next, ptr->size);
+}
+#endif
+
+void gnrc_pktbuf_stats(void)
+{
+    for (unsigned i = 0; i < _CLASS_NUMOF; i++) {
+        if (_classes[i].size > _classes[i].min) {
+            printf("size class %u: %3u < size <= %3u bytes, %u chunks cached\n", i,
+                   _classes[i].min, _classes[i].size, _classes[i].cached);
+        }
+    }
+#ifdef MODULE_OD
+    _unused_t *ptr = _first_unused;
+    uint8_t *chunk = &_pktbuf[0];
+    int count = 0;
+
+    printf("packet buffer: first byte: %p, last byte: %p (size: %u)\n",
+           (void *)&_pktbuf[0], (void *)&_pktbuf[GNRC_PKTBUF_SIZE], GNRC_PKTBUF_SIZE);
+    printf("  position of last byte used: %" PRIu16 "\n", max_byte_count);
+    puts("  cached chunks are shown as used");
+    if (ptr == NULL) {  /* packet buffer is completely full */
+        _print_chunk(chunk, GNRC_PKTBUF_SIZE, count++);
+    }
+
+    if (((void *)ptr) == ((void *)chunk)) { /* _first_unused is at the beginning */
+        _print_unused(ptr);
+        chunk += ptr->size;
+        ptr = ptr->next;
+    }
+
+    while (ptr) {
+        size_t size = ((uint8_t *)ptr) - chunk;
+        if ((size == 0) && (!_pktbuf_contains(ptr)) &&
+            (!_pktbuf_contains(chunk)) && (size > GNRC_PKTBUF_SIZE)) {
+            puts("ERROR");
+            return;
+        }
+        _print_chunk(chunk, size, count++);
+        chunk += (size + ptr->size);
+        _print_unused(ptr);
+        ptr = ptr->next;
+    }
+
+    if (chunk <= &_pktbuf[GNRC_PKTBUF_SIZE - 1]) {
+        _print_chunk(chunk, &_pktbuf[GNRC_PKTBUF_SIZE] - chunk, count);
+    }
+#else
+    DEBUG("pktbuf: needs od module\n");
+#endif
+}
+#endif
+
+#ifdef TEST_SUITES
+bool gnrc_pktbuf_is_empty(void)
+{
+    /* cached chunks are free too */
+    mutex_lock(&_mutex);
+    _flush();
+    mutex_unlock(&_mutex);
+
+    return (_first_unused == (_unused_t *)_pktbuf) &&
+           (_first_unused->size == sizeof(_pktbuf));
+}
+
+bool gnrc_pktbuf_is_sane(void)
+{
+    _unused_t *ptr = _first_unused;
+
+    /* Invariants of the arena are the ones of gnrc_pktbuf_static, except that
+     * the last space may end before the end of the buffer, since chunks of the
+     * classes are cut off the top:
+     *  - the head of _unused_t list is _first_unused
+     *  - if _unused_t list is empty the packet buffer is full and _first_unused is NULL
+     *  - forall ptr_in _unused_t list: &_pktbuf[0] < ptr < &_pktbuf[GNRC_PKTBUF_SIZE]
+     *  - forall ptr in _unused_t list: ptr->next == NULL || ptr < ptr->next
+     *  - forall ptr in _unused_t list: (ptr->next != NULL && ptr->size <= (ptr->next - ptr)) ||
+     *                                  (ptr->next == NULL && ptr->size <= (GNRC_PKTBUF_SIZE - (ptr - &_pktbuf[0])))
+     * Invariants of the size classes:
+     *  - forall chunk in class free list: chunk is aligned and
+     *                                     &_pktbuf[0] <= chunk <= &_pktbuf[GNRC_PKTBUF_SIZE - class size]
+     *  - number of chunks in class free list == class cached counter
+     */
+
+    while (ptr) {
+        if (&_pktbuf[0] >= (uint8_t *)ptr && (uint8_t *)ptr >= &_pktbuf[GNRC_PKTBUF_SIZE]) {
+            return false;
+        }
+        if ((ptr->next != NULL) && (ptr >= ptr->next)) {
+            return false;
+        }
+        if (((ptr->next == NULL) || (ptr->size > (size_t)((uint8_t *)(ptr->next) - (uint8_t *)ptr))) &&
+            ((ptr->next != NULL) ||
+             (ptr->size > (size_t)(GNRC_PKTBUF_SIZE - ((uint8_t *)ptr - &_pktbuf[0]))))) {
+            return false;
+        }
+        ptr = ptr->next;
+    }
+
+    for (unsigned i = 0; i < _CLASS_NUMOF; i++) {
+        unsigned count = 0;
+
+        for (ptr = _classes[i].free; ptr; ptr = ptr->next) {
+            size_t offset = (uint8_t *)ptr - &_pktbuf[0];
+
+            if (!_pktbuf_contains(ptr) || (offset & _ALIGNMENT_MASK) ||
+                (offset + _classes[i].size > GNRC_PKTBUF_SIZE) ||
+                (++count > _classes[i].cached)) {
+                return false;
+            }
+        }
+        if (count != _classes[i].cached) {
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+
+static gnrc_pktsnip_t *_create_snip(gnrc_pktsnip_t *next, const void *data, size_t size,
+                                    gnrc_nettype_t type)
+{
+    gnrc_pktsnip_t *pkt = _pktbuf_alloc(sizeof(gnrc_pktsnip_t));
+    void *_data = NULL;
+
+    if (pkt == NULL) {
+        DEBUG("pktbuf: error allocating new packet snip\n");
+        return NULL;
+    }
+    if (size > 0) {
+        _data = _pktbuf_alloc(size);
+        if (_data == NULL) {
+            DEBUG("pktbuf: error allocating data for new packet snip\n");
+            _pktbuf_free(pkt, sizeof(gnrc_pktsnip_t));
+            return NULL;
+        }
+    }
+    _set_pktsnip(pkt, next, _data, size, type);
+    if (data != NULL) {
+        memcpy(_data, data, size);
+    }
+    return pkt;
+}
+
+static void *_pktbuf_alloc(size_t size)
+{
+    void *ptr;
+
+    size = _chunk_size(size);
+
+    _class_t *class = _class_of(size);
+    if (class && class->free) {
+        ptr = class->free;
+        class->free = class->free->next;
+        class->cached--;
+        return ptr;
+    }
+
+    ptr = _arena_alloc(size, class != NULL);
+    if ((ptr == NULL) && _flush()) {
+        DEBUG("pktbuf: cached chunks returned to the arena\n");
+        ptr = _arena_alloc(size, class != NULL);
+    }
+
+    return ptr;
+}
+
+static void _pktbuf_free(void *data, size_t size)
+{
+    _chunk_free(data, _chunk_size(size));
+}
+
+static void _chunk_free(void *chunk, size_t size)
+{
+    if (!_pktbuf_contains(chunk)) {
+        return;
+    }
+
+    _class_t *class = _class_of(size);
+    if (class) {
+        _unused_t *ptr = (_unused_t *)chunk, **pos = &class->free;
+
+        /* highest address first, so the chunks in use stay packed at the top */
+        while (*pos && ((void *)*pos > chunk)) {
+            pos = &(*pos)->next;
+        }
+        ptr->next = *pos;
+        *pos = ptr;
+        class->cached++;
+        return;
+    }
+
+    _arena_free(chunk, size);
+}
+
+static void *_arena_alloc(size_t size, bool top)
+{
+    _unused_t *prev = NULL, *ptr = _first_unused;
+
+    if (top) {
+        _unused_t *last = NULL, *last_prev = NULL;
+
+        /* last fitting space */
+        for (; ptr; prev = ptr, ptr = ptr->next) {
+            if (size <= ptr->size) {
+                last_prev = prev;
+                last = ptr;
+            }
+        }
+        prev = last_prev;
+        ptr = last;
+
+        if (ptr && (sizeof(_unused_t) <= (ptr->size - size))) {
+            /* cut the chunk off the end of the space */
+            ptr->size -= size;
+#ifdef DEVELHELP
+            uint16_t last_byte = (uint16_t)((((uint8_t *)ptr) + ptr->size + size) - &(_pktbuf[0]));
+            if (last_byte > max_byte_count) {
+                max_byte_count = last_byte;
+            }
+#endif
+            return ((uint8_t *)ptr) + ptr->size;
+        }
+    }
+    else {
+        while (ptr && (size > ptr->size)) {
+            prev = ptr;
+            ptr = ptr->next;
+        }
+    }
+    if (ptr == NULL) {
+        DEBUG("pktbuf: no space left in packet buffer\n");
+        return NULL;
+    }
+    /* _unused_t struct would fit => add new space at ptr */
+    if (sizeof(_unused_t) > (ptr->size - size)) {
+        if (prev == NULL) { /* ptr was _first_unused */
+            _first_unused = ptr->next;
+        }
+        else {
+            prev->next = ptr->next;
+        }
+    }
+    else {
+        _unused_t *new = (_unused_t *)(((uint8_t *)ptr) + size);
+
+        if (((((uint8_t *)new) - &(_pktbuf[0])) + sizeof(_unused_t)) > GNRC_PKTBUF_SIZE) {
+            /* content of new would exceed packet buffer size so set to NULL */
+            _first_unused = NULL;
+        }
+        else if (prev == NULL) { /* ptr was _first_unused */
+            _first_unused = new;
+        }
+        else {
+            prev->next = new;
+        }
+        new->next = ptr->next;
+        new->size = ptr->size - size;
+    }
+#ifdef DEVELHELP
+    uint16_t last_byte = (uint16_t)((((uint8_t *)ptr) + size) - &(_pktbuf[0]));
+    if (last_byte > max_byte_count) {
+        max_byte_count = last_byte;
+    }
+#endif
+    return (void *)ptr;
+}
+
+static inline bool _too_small_hole(_unused_t *a, _unused_t *b)
+{
+    return sizeof(_unused_t) > (size_t)(((uint8_t *)b) - (((uint8_t *)a) + a->size));
+}
+
+static inline _unused_t *_merge(_unused_t *a, _unused_t *b)
+{
+    assert(b != NULL);
+
+    a->next = b->next;
+    a->size = b->size + ((uint8_t *)b - (uint8_t *)a);
+    return a;
+}
+
+static void _arena_free(void *data, size_t size)
+{
+    size_t bytes_at_end;
+    _unused_t *new = (_unused_t *)data, *prev = NULL, *ptr = _first_unused;
+
+    while (ptr && (((void *)ptr) < data)) {
+        prev = ptr;
+        ptr = ptr->next;
+    }
+    new->next = ptr;
+    new->size = size;
+    /* calculate number of bytes between new _unused_t chunk and end of packet
+     * buffer */
+    bytes_at_end = ((&_pktbuf[0] + GNRC_PKTBUF_SIZE) - (((uint8_t *)new) + new->size));
+    if (bytes_at_end < sizeof(_unused_t)) {
+        /* new is very last segment and there is a little bit of memory left
+         * that wouldn't fit _unused_t (cut of in _arena_alloc()) => re-add it */
+        new->size += bytes_at_end;
+    }
+    if (prev == NULL) { /* ptr was _first_unused or data before _first_unused */
+        _first_unused = new;
+    }
+    else {
+        prev->next = new;
+        if (_too_small_hole(prev, new)) {
+            new = _merge(prev, new);
+        }
+    }
+    if ((new->next != NULL) && (_too_small_hole(new, new->next))) {
+        _merge(new, new->next);
+    }
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_duplicate_upto(gnrc_pktsnip_t *pkt, gnrc_nettype_t type)
+{
+    mutex_lock(&_mutex);
+
+    bool is_shared = pkt->users > 1;
+    size_t size = gnrc_pkt_len_upto(pkt, type);
+
+    DEBUG("ipv6_ext: duplicating %d octets\n", (int) size);
+
+    gnrc_pktsnip_t *tmp;
+    gnrc_pktsnip_t *target = gnrc_pktsnip_search_type(pkt, type);
+    gnrc_pktsnip_t *next = (target == NULL) ? NULL : target->next;
+    gnrc_pktsnip_t *new = _create_snip(next, NULL, size, type);
+
+    if (new == NULL) {
+        mutex_unlock(&_mutex);
+
+        return NULL;
+    }
+
+    /* copy payloads */
+    for (tmp = pkt; tmp != NULL; tmp = tmp->next) {
+        uint8_t *dest = ((uint8_t *)new->data) + (size - tmp->size);
+
+        memcpy(dest, tmp->data, tmp->size);
+
+        size -= tmp->size;
+
+        if (tmp->type == type) {
+            break;
+        }
+    }
+
+    /* decrements reference counters */
+
+    if (target != NULL) {
+        target->next = NULL;
+    }
+
+    _release_error_locked(pkt, GNRC_NETERR_SUCCESS);
+
+    if (is_shared && (target != NULL)) {
+        target->next = next;
+    }
+
+    mutex_unlock(&_mutex);
+
+    return new;
+}
+
+/** @} */
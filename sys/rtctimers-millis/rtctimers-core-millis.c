@@ -24,6 +24,9 @@
 
 #include "rtctimers-millis.h"
 #include "irq.h"
+#ifdef MODULE_RTCTIMERS_MILLIS_WHEEL
+#include "timer_wheel.h"
+#endif
 
 /* WARNING! enabling this will have side effects and can lead to timer underflows. */
 #define ENABLE_DEBUG (0)
@@ -35,13 +38,23 @@ static volatile int _in_handler = 0;
 
 static volatile uint32_t _long_cnt = 0;
 
+/* wakeup statistics */
+static uint32_t _wakeups = 0;
+static uint32_t _wakeups_saved = 0;
+
+#ifdef MODULE_RTCTIMERS_MILLIS_WHEEL
+/* all timers, ordered by the 64-bit target */
+static timer_wheel_t _wheel;
+#else
 static rtctimers_millis_t *timer_list_head = NULL;
 static rtctimers_millis_t *overflow_list_head = NULL;
 static rtctimers_millis_t *long_list_head = NULL;
 
-static int _rtctimers_millis_set_absolute(rtctimers_millis_t *timer, uint32_t target);
 static void _add_timer_to_list(rtctimers_millis_t **list_head, rtctimers_millis_t *timer);
 static void _add_timer_to_long_list(rtctimers_millis_t **list_head, rtctimers_millis_t *timer);
+#endif
+
+static int _rtctimers_millis_set_absolute(rtctimers_millis_t *timer, uint32_t target);
 static uint32_t _rtctimers_millis_lltimer_maximum(uint32_t target);
 static void _shoot(rtctimers_millis_t *timer);
 static void _remove(rtctimers_millis_t *timer);
@@ -68,8 +81,60 @@ static inline int _is_set(rtctimers_millis_t *timer)
     return (timer->target || timer->long_target);
 }
 
+/**
+ * @brief returns the earliest time the timer may fire at
+ *
+ * Timers are kept ordered by the latest time, window opened in the
+ * previous period is open from the start of this one.
+ */
+static inline uint32_t _window_start(rtctimers_millis_t *timer)
+{
+    return (timer->target > timer->slack) ? (timer->target - timer->slack) : 0;
+}
+
+#ifdef MODULE_RTCTIMERS_MILLIS_WHEEL
+static uint64_t _key(const list_node_t *node)
+{
+    const rtctimers_millis_t *timer = (const rtctimers_millis_t *)node;
+    return ((uint64_t)timer->long_target << 32) | timer->target;
+}
+
+/**
+ * @brief returns the first timer to expire in the current timer period
+ */
+static rtctimers_millis_t *_first(void)
+{
+    rtctimers_millis_t *timer = (rtctimers_millis_t *)timer_wheel_first(&_wheel);
+
+    if (timer && (timer->long_target <= _long_cnt)) {
+        return timer;
+    }
+
+    return NULL;
+}
+
+static inline void _shift_first(void)
+{
+    timer_wheel_remove(&_wheel, timer_wheel_first(&_wheel));
+}
+#else
+static inline rtctimers_millis_t *_first(void)
+{
+    return timer_list_head;
+}
+
+static inline void _shift_first(void)
+{
+    timer_list_head = timer_list_head->next;
+}
+#endif
+
 void rtctimers_millis_init(void)
 {
+#ifdef MODULE_RTCTIMERS_MILLIS_WHEEL
+    timer_wheel_init(&_wheel, _key);
+#endif
+
     /* initialize low-level timer */
     rtc_init();
 
@@ -79,7 +144,13 @@ void rtctimers_millis_init(void)
 
 void rtctimers_millis_set(rtctimers_millis_t *timer, uint32_t offset)
 {
-    DEBUG("timer_set(): offset=%" PRIu32 " now=%" PRIu32 "\n", offset, rtctimers_millis_now());
+    rtctimers_millis_set_slack(timer, offset, 0);
+}
+
+void rtctimers_millis_set_slack(rtctimers_millis_t *timer, uint32_t offset, uint32_t slack)
+{
+    DEBUG("timer_set(): offset=%" PRIu32 " slack=%" PRIu32 " now=%" PRIu32 "\n",
+          offset, slack, rtctimers_millis_now());
     if (!timer->callback) {
         DEBUG("timer_set(): timer has no callback.\n");
         return;
@@ -87,11 +158,18 @@ void rtctimers_millis_set(rtctimers_millis_t *timer, uint32_t offset)
 
     rtctimers_millis_remove(timer);
 
+    /* keep the window within the timer period */
+    if (slack > RTCTIMERS_MILLIS_OVERFLOW_VALUE / 2) {
+        slack = RTCTIMERS_MILLIS_OVERFLOW_VALUE / 2;
+    }
+    timer->slack = slack;
+
     if (offset < RTCTIMERS_MILLIS_BACKOFF) {
         _shoot(timer);
     }
     else {
-        uint32_t target = rtctimers_millis_now() + offset;
+        /* timer is kept at the end of the window */
+        uint32_t target = rtctimers_millis_now() + offset + slack;
         if (target >= RTCTIMERS_MILLIS_OVERFLOW_VALUE - RTCTIMERS_MILLIS_ISR_BACKOFF) {
             target -= (RTCTIMERS_MILLIS_OVERFLOW_VALUE - RTCTIMERS_MILLIS_ISR_BACKOFF);
         }
@@ -144,6 +222,14 @@ int _rtctimers_millis_set_absolute(rtctimers_millis_t *timer, uint32_t target)
         timer->long_target++;
     }
 
+#ifdef MODULE_RTCTIMERS_MILLIS_WHEEL
+    timer_wheel_add(&_wheel, (list_node_t *)timer);
+
+    if (_first() == timer) {
+        DEBUG("timer_set_absolute(): timer is the first one. updating lltimer.\n");
+        _lltimer_set(target - RTCTIMERS_MILLIS_OVERHEAD);
+    }
+#else
     if ( (timer->long_target > _long_cnt) || !_this_high_period(target) ) {
         DEBUG("rtctimers_millis_set_absolute(): the timer doesn't fit into the low-level timer's mask.\n");
         _add_timer_to_long_list(&long_list_head, timer);
@@ -163,12 +249,14 @@ int _rtctimers_millis_set_absolute(rtctimers_millis_t *timer, uint32_t target)
             }
         }
     }
+#endif
 
     irq_restore(state);
 
     return res;
 }
 
+#ifndef MODULE_RTCTIMERS_MILLIS_WHEEL
 static void _add_timer_to_list(rtctimers_millis_t **list_head, rtctimers_millis_t *timer)
 {
     while (*list_head && (*list_head)->target <= timer->target) {
@@ -203,9 +291,20 @@ static int _remove_timer_from_list(rtctimers_millis_t **list_head, rtctimers_mil
 
     return 0;
 }
+#endif /* MODULE_RTCTIMERS_MILLIS_WHEEL */
 
 static void _remove(rtctimers_millis_t *timer)
 {
+#ifdef MODULE_RTCTIMERS_MILLIS_WHEEL
+    int first = (_first() == timer);
+
+    if (timer_wheel_remove(&_wheel, (list_node_t *)timer) && first) {
+        /* schedule callback on next timer target time */
+        rtctimers_millis_t *next = _first();
+        _lltimer_set(next ? next->target - RTCTIMERS_MILLIS_OVERHEAD
+                          : RTCTIMERS_MILLIS_OVERFLOW_VALUE);
+    }
+#else
     if (timer_list_head == timer) {
         uint32_t next;
         timer_list_head = timer->next;
@@ -225,6 +324,7 @@ static void _remove(rtctimers_millis_t *timer)
             }
         }
     }
+#endif
 }
 
 void rtctimers_millis_remove(rtctimers_millis_t *timer)
@@ -238,6 +338,12 @@ void rtctimers_millis_remove(rtctimers_millis_t *timer)
 
 void rtctimers_millis_remove_all(void)
 {
+#ifdef MODULE_RTCTIMERS_MILLIS_WHEEL
+    list_node_t *timer;
+    while ((timer = timer_wheel_first(&_wheel))) {
+        timer_wheel_remove(&_wheel, timer);
+    }
+#else
     while (timer_list_head) {
         timer_list_head = timer_list_head->next;
     }
@@ -249,6 +355,7 @@ void rtctimers_millis_remove_all(void)
     while (long_list_head) {
         long_list_head = long_list_head->next;
     }
+#endif
 }
 
 static uint32_t _time_left(uint32_t target, uint32_t reference)
@@ -272,6 +379,7 @@ static inline int _this_high_period(uint32_t target) {
     return 1;
 }
 
+#ifndef MODULE_RTCTIMERS_MILLIS_WHEEL
 /**
  * @brief compare two timers' target values, return the one with lower value.
  *
@@ -361,6 +469,7 @@ static void _select_long_timers(void)
         }
     }
 }
+#endif /* MODULE_RTCTIMERS_MILLIS_WHEEL */
 
 /**
  * @brief handle low-level timer overflow, advance to next short timer period
@@ -370,13 +479,95 @@ static void _next_period(void)
     /* advance >32bit counter */
     _long_cnt++;
 
+#ifndef MODULE_RTCTIMERS_MILLIS_WHEEL
     /* swap overflow list to current timer list */
     timer_list_head = overflow_list_head;
     overflow_list_head = NULL;
 
     _select_long_timers();
+#endif
+}
+
+/**
+ * @brief checks if the timer's window is open or opens within the ISR backoff
+ */
+static inline int _window_open(rtctimers_millis_t *timer, uint32_t reference)
+{
+    return _time_left(_rtctimers_millis_lltimer_maximum(_window_start(timer)), reference) < RTCTIMERS_MILLIS_ISR_BACKOFF;
 }
 
+/**
+ * @brief fires the timer already taken out of the timers
+ */
+static void _fire(rtctimers_millis_t *timer, uint32_t reference)
+{
+    /* make sure we don't fire too early */
+    while (_time_left(_rtctimers_millis_lltimer_maximum(_window_start(timer)), reference));
+
+    /* timer would have needed a wakeup of its own */
+    if (_time_left(_rtctimers_millis_lltimer_maximum(timer->target), reference) >= RTCTIMERS_MILLIS_ISR_BACKOFF) {
+        _wakeups_saved++;
+    }
+
+    /* make sure timer is recognized as being already fired */
+    timer->target = 0;
+    timer->long_target = 0;
+
+    /* fire timer */
+    _shoot(timer);
+}
+
+#if RTCTIMERS_MILLIS_SCAN_MAX > 0
+/**
+ * @brief fires the timers past the first one whose windows are open too
+ *
+ * Timers are ordered by the end of the window, so a later timer with a
+ * larger slack may be open while the first one is not. Only
+ * RTCTIMERS_MILLIS_SCAN_MAX timers are looked at to keep the handler short,
+ * the ones with an open window further down wait for their own wakeup.
+ */
+static void _fire_open_windows(uint32_t reference)
+{
+    rtctimers_millis_t *skipped = NULL;
+    rtctimers_millis_t **skipped_tail = &skipped;
+    rtctimers_millis_t *open = NULL;
+    rtctimers_millis_t **open_tail = &open;
+    rtctimers_millis_t *timer;
+
+    for (unsigned i = 0; (i < RTCTIMERS_MILLIS_SCAN_MAX) && (timer = _first()); i++) {
+        _shift_first();
+        timer->next = NULL;
+
+        if (_window_open(timer, reference)) {
+            *open_tail = timer;
+            open_tail = &timer->next;
+        }
+        else {
+            *skipped_tail = timer;
+            skipped_tail = &timer->next;
+        }
+    }
+
+    /* timers left waiting are put back before any callback may set or remove them */
+#ifdef MODULE_RTCTIMERS_MILLIS_WHEEL
+    while (skipped) {
+        timer = skipped;
+        skipped = skipped->next;
+        timer_wheel_add(&_wheel, (list_node_t *)timer);
+    }
+#else
+    *skipped_tail = timer_list_head;
+    timer_list_head = skipped;
+#endif
+
+    while (open) {
+        timer = open;
+        open = open->next;
+        _fire(timer, reference);
+    }
+}
+#endif
+
 /**
  * @brief main rtctimers_millis callback function
  */
@@ -384,13 +575,15 @@ static void _timer_callback(void)
 {
     uint32_t next_target;
     uint32_t reference;
+    rtctimers_millis_t *timer;
 
     _in_handler = 1;
+    _wakeups++;
 
     DEBUG("_timer_callback() now=%" PRIu32 " pleft=%" PRIu32 "\n", 
             rtctimers_millis_now(), RTCTIMERS_MILLIS_OVERFLOW_VALUE - rtctimers_millis_now());
 
-    if (!timer_list_head) {
+    if (!_first()) {
         DEBUG("_timer_callback(): tick\n");
         /* there's no timer for this timer period,
          * so this was a timer overflow callback.
@@ -415,38 +608,32 @@ static void _timer_callback(void)
 
 overflow:
     /* check if next timers are close to expiring */
-    while (timer_list_head && (_time_left(_rtctimers_millis_lltimer_maximum(timer_list_head->target), reference) < RTCTIMERS_MILLIS_ISR_BACKOFF)) {
-        /* make sure we don't fire too early */
-        while (_time_left(_rtctimers_millis_lltimer_maximum(timer_list_head->target), reference));
-
-        /* pick first timer in list */
-        rtctimers_millis_t *timer = timer_list_head;
-
+    while ((timer = _first()) && _window_open(timer, reference)) {
         /* advance list */
-        timer_list_head = timer->next;
-
-        /* make sure timer is recognized as being already fired */
-        timer->target = 0;
-        timer->long_target = 0;
+        _shift_first();
 
-        /* fire timer */
-        _shoot(timer);
+        _fire(timer, reference);
     }
 
+#if RTCTIMERS_MILLIS_SCAN_MAX > 0
+    /* windows of the later timers may be open as well */
+    _fire_open_windows(reference);
+#endif
+
     /* possibly executing all callbacks took enough
      * time to overflow.  In that case we advance to
      * next timer period and check again for expired
      * timers.*/
     if (reference > rtctimers_millis_now()) {
-        DEBUG("_timer_callback: overflowed while executing callbacks. %i\n", timer_list_head != 0);
+        DEBUG("_timer_callback: overflowed while executing callbacks. %i\n", _first() != 0);
         _next_period();
         reference = 0;
         goto overflow;
     }
 
-    if (timer_list_head) {
+    if ((timer = _first())) {
         /* schedule callback on next timer target time */
-        next_target = timer_list_head->target - RTCTIMERS_MILLIS_OVERHEAD;
+        next_target = timer->target - RTCTIMERS_MILLIS_OVERHEAD;
 
         /* make sure we're not setting a time in the past */
         if (next_target < (rtctimers_millis_now() + RTCTIMERS_MILLIS_ISR_BACKOFF)) {
@@ -481,6 +668,16 @@ overflow:
     _lltimer_set(next_target);
 }
 
+uint32_t rtctimers_millis_wakeups(void)
+{
+    return _wakeups;
+}
+
+uint32_t rtctimers_millis_wakeups_saved(void)
+{
+    return _wakeups_saved;
+}
+
 /*
  * Seconds from midnight, need to perform comparison within a day
  */
@@ -543,7 +740,42 @@ void rtctimers_millis_set_timebase(struct tm *new_time) {
     rtc_millis_get_time(&prev_ts);
     
 	rtc_set_time(new_time);
-    
+
+#ifdef MODULE_RTCTIMERS_MILLIS_WHEEL
+    unsigned state = irq_disable();
+
+    /* keys change, so the timers are taken out and added again */
+    rtctimers_millis_t *list = NULL;
+    list_node_t *node;
+    while ((node = timer_wheel_first(&_wheel))) {
+        timer_wheel_remove(&_wheel, node);
+
+        rtctimers_millis_t *timer = (rtctimers_millis_t *)node;
+        if (timer->long_target == _long_cnt) {
+            /* Change timer's absolute target time stamp to the new one in according to the time remaining before shot */
+            int diff = timer->target - prev_ts;
+            timer->target = new_ts + diff;
+        }
+
+        timer->next = list;
+        list = timer;
+    }
+
+    timer_wheel_init(&_wheel, _key);
+    while (list) {
+        rtctimers_millis_t *next = list->next;
+        timer_wheel_add(&_wheel, (list_node_t *)list);
+        list = next;
+    }
+
+    rtctimers_millis_t *timer = _first();
+    if (timer) {
+        DEBUG("[RTC] Head timer is %d seconds far\n", (int)(timer->target - new_ts));
+        _lltimer_set(timer->target);
+    }
+
+    irq_restore(state);
+#else
 	if (timer_list_head) {
 		/* Shift hardware alarm to new time base */
         /* int is ok here as maximum actual target value is 7*24*60*60*1000 = 604 800 000 */
@@ -565,4 +797,5 @@ void rtctimers_millis_set_timebase(struct tm *new_time) {
 			timer = timer->next;
 		}
 	}
+#endif
 }
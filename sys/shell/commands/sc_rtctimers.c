@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_shell_commands
+ * @{
+ *
+ * @file
+ * @brief       Shell command printing the rtctimers-millis wakeup statistics
+ *
+ * @author      Oleg Artamonov
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "rtctimers-millis.h"
+
+int _rtctimers_handler(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    printf("Timer wakeups: %" PRIu32 ", saved by the slack: %" PRIu32 "\n",
+           rtctimers_millis_wakeups(), rtctimers_millis_wakeups_saved());
+
+    return 0;
+}
@@ -61,6 +61,10 @@ extern int _saul(int argc, char **argv);
 extern int _rtc_handler(int argc, char **argv);
 #endif
 
+#ifdef MODULE_RTCTIMERS_MILLIS
+extern int _rtctimers_handler(int argc, char **argv);
+#endif
+
 #ifdef MODULE_MCI
 extern int _get_sectorsize(int argc, char **argv);
 extern int _get_blocksize(int argc, char **argv);
@@ -185,6 +189,9 @@ const shell_command_t _shell_command_list[] = {
 #ifdef MODULE_PERIPH_RTC
     {"rtc", "control RTC peripheral interface",  _rtc_handler},
 #endif
+#ifdef MODULE_RTCTIMERS_MILLIS
+    {"rtctimers", "print RTC timers wakeup statistics", _rtctimers_handler},
+#endif
 #ifdef MODULE_GNRC_IPV6_NIB
     {"nib", "Configure neighbor information base", _gnrc_ipv6_nib},
 #endif
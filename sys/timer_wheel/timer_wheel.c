@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_timer_wheel
+ * @{
+ *
+ * @file
+ * @brief       Hierarchical timing wheel implementation
+ *
+ * @author      Oleg Artamonov
+ *
+ * @}
+ */
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "timer_wheel.h"
+#include "bitarithm.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+/* level index of the far list */
+#define FAR_LEVEL       (TIMER_WHEEL_LEVELS)
+
+/**
+ * @brief returns the list the timer of the given key belongs to
+ */
+static list_node_t **_locate(timer_wheel_t *wheel, uint64_t key,
+                             unsigned *level, unsigned *slot)
+{
+    /* late timers go to the cursor's slot, where they are the earliest */
+    if (key < wheel->cursor) {
+        key = wheel->cursor;
+    }
+
+    uint64_t diff = key ^ wheel->cursor;
+    if (diff >> 32) {
+        *level = FAR_LEVEL;
+        return &wheel->far;
+    }
+
+    /* highest differing digit */
+    unsigned l = TIMER_WHEEL_LEVELS - 1;
+    while (l && !((uint32_t)diff >> (l * TIMER_WHEEL_BITS))) {
+        l--;
+    }
+
+    *level = l;
+    *slot = (key >> (l * TIMER_WHEEL_BITS)) & (TIMER_WHEEL_SLOTS - 1);
+    return &wheel->slots[l][*slot];
+}
+
+static void _place(timer_wheel_t *wheel, list_node_t *timer)
+{
+    unsigned level, slot;
+    list_node_t **head = _locate(wheel, wheel->key(timer), &level, &slot);
+
+    timer->next = *head;
+    *head = timer;
+
+    if (level != FAR_LEVEL) {
+        wheel->occupied[level] |= (1 << slot);
+    }
+}
+
+/**
+ * @brief places the timers of the detached list again
+ *
+ * List is newest first, it is reversed so the order of the timers
+ * of the same key is kept.
+ */
+static void _spread(timer_wheel_t *wheel, list_node_t *list)
+{
+    list_node_t *reversed = NULL;
+
+    while (list) {
+        list_node_t *next = list->next;
+        list->next = reversed;
+        reversed = list;
+        list = next;
+    }
+
+    while (reversed) {
+        list_node_t *next = reversed->next;
+        _place(wheel, reversed);
+        reversed = next;
+    }
+}
+
+void timer_wheel_init(timer_wheel_t *wheel, timer_wheel_key_t key)
+{
+    memset(wheel, 0, sizeof(timer_wheel_t));
+    wheel->key = key;
+}
+
+void timer_wheel_add(timer_wheel_t *wheel, list_node_t *timer)
+{
+    _place(wheel, timer);
+
+    if (wheel->first && (wheel->key(timer) < wheel->key(wheel->first))) {
+        wheel->first = timer;
+    }
+}
+
+int timer_wheel_remove(timer_wheel_t *wheel, list_node_t *timer)
+{
+    unsigned level, slot;
+    list_node_t **head = _locate(wheel, wheel->key(timer), &level, &slot);
+
+    for (list_node_t **node = head; *node; node = &(*node)->next) {
+        if (*node != timer) {
+            continue;
+        }
+
+        *node = timer->next;
+
+        if ((level != FAR_LEVEL) && !*head) {
+            wheel->occupied[level] &= ~(1 << slot);
+        }
+
+        if (wheel->first == timer) {
+            wheel->first = NULL;
+        }
+
+        return 1;
+    }
+
+    return 0;
+}
+
+list_node_t *timer_wheel_first(timer_wheel_t *wheel)
+{
+    while (!wheel->first) {
+        unsigned level = 0;
+        while ((level < TIMER_WHEEL_LEVELS) && !wheel->occupied[level]) {
+            level++;
+        }
+
+        if (level == TIMER_WHEEL_LEVELS) {
+            if (!wheel->far) {
+                return NULL;
+            }
+
+            /* move the cursor to the 2^32 ticks period of the earliest far timer */
+            uint64_t min = UINT64_MAX;
+            for (list_node_t *node = wheel->far; node; node = node->next) {
+                uint64_t key = wheel->key(node);
+                if (key < min) {
+                    min = key;
+                }
+            }
+
+            DEBUG("timer_wheel: far list, new period %" PRIu32 "\n", (uint32_t)(min >> 32));
+
+            wheel->cursor = min & ~(uint64_t)UINT32_MAX;
+
+            list_node_t *far = wheel->far;
+            wheel->far = NULL;
+            _spread(wheel, far);
+            continue;
+        }
+
+        unsigned slot = bitarithm_lsb(wheel->occupied[level]);
+        list_node_t *list = wheel->slots[level][slot];
+
+        if (level == 0) {
+            /* same key, unless there are late timers; oldest one goes first */
+            list_node_t *first = list;
+            for (list_node_t *node = list->next; node; node = node->next) {
+                if (wheel->key(node) <= wheel->key(first)) {
+                    first = node;
+                }
+            }
+
+            wheel->first = first;
+            break;
+        }
+
+        /* advance the cursor to the slot start and spread its timers lower */
+        unsigned shift = level * TIMER_WHEEL_BITS;
+        uint64_t mask = ((uint64_t)1 << (shift + TIMER_WHEEL_BITS)) - 1;
+        wheel->cursor = (wheel->cursor & ~mask) | ((uint64_t)slot << shift);
+
+        wheel->slots[level][slot] = NULL;
+        wheel->occupied[level] &= ~(1 << slot);
+        _spread(wheel, list);
+    }
+
+    return wheel->first;
+}
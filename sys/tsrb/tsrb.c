@@ -69,3 +69,46 @@ int tsrb_add(tsrb_t *rb, const char *src, size_t n)
     }
     return (n - tmp);
 }
+
+unsigned int tsrb_peek_chunk(const tsrb_t *rb, const char **data)
+{
+    unsigned start = rb->reads & (rb->size - 1);
+    unsigned avail = tsrb_avail(rb);
+
+    *data = &rb->buf[start];
+    return (avail < rb->size - start) ? avail : rb->size - start;
+}
+
+int tsrb_skip(tsrb_t *rb, size_t n)
+{
+    unsigned avail = tsrb_avail(rb);
+
+    if (n > avail) {
+        n = avail;
+    }
+    rb->reads += n;
+    return n;
+}
+
+int tsrb_poke(tsrb_t *rb, unsigned offset, const char *src, size_t n)
+{
+    if (offset + n > tsrb_free(rb)) {
+        return -1;
+    }
+
+    unsigned pos = rb->writes + offset;
+    while (n--) {
+        rb->buf[pos++ & (rb->size - 1)] = *src++;
+    }
+    return 0;
+}
+
+int tsrb_commit(tsrb_t *rb, size_t n)
+{
+    if (n > tsrb_free(rb)) {
+        return -1;
+    }
+
+    rb->writes += n;
+    return 0;
+}
@@ -26,6 +26,9 @@
 
 #include "xtimer.h"
 #include "irq.h"
+#ifdef MODULE_XTIMER_WHEEL
+#include "timer_wheel.h"
+#endif
 
 /* WARNING! enabling this will have side effects and can lead to timer underflows. */
 #define ENABLE_DEBUG 0
@@ -40,12 +43,17 @@ volatile uint32_t _xtimer_high_cnt = 0;
 
 static inline void xtimer_spin_until(uint32_t value);
 
+#ifdef MODULE_XTIMER_WHEEL
+/* all timers, ordered by the 64-bit target */
+static timer_wheel_t _wheel;
+#else
 static xtimer_t *timer_list_head = NULL;
 static xtimer_t *overflow_list_head = NULL;
 static xtimer_t *long_list_head = NULL;
 
 static void _add_timer_to_list(xtimer_t **list_head, xtimer_t *timer);
 static void _add_timer_to_long_list(xtimer_t **list_head, xtimer_t *timer);
+#endif
 static void _shoot(xtimer_t *timer);
 static void _remove(xtimer_t *timer);
 static inline void _lltimer_set(uint32_t target);
@@ -61,6 +69,55 @@ static inline int _is_set(xtimer_t *timer)
     return (timer->target || timer->long_target);
 }
 
+#ifdef MODULE_XTIMER_WHEEL
+static uint64_t _key(const list_node_t *node)
+{
+    const xtimer_t *timer = (const xtimer_t *)node;
+    return ((uint64_t)timer->long_target << 32) | timer->target;
+}
+
+/**
+ * @brief returns start of the next short timer period
+ */
+static inline uint64_t _period_end(void)
+{
+#if XTIMER_MASK
+    return (((uint64_t)_long_cnt << 32) | _xtimer_high_cnt) + (uint32_t)(~XTIMER_MASK + 1);
+#else
+    return ((uint64_t)_long_cnt + 1) << 32;
+#endif
+}
+
+/**
+ * @brief returns the first timer to expire in the current short timer period
+ */
+static xtimer_t *_first(void)
+{
+    xtimer_t *timer = (xtimer_t *)timer_wheel_first(&_wheel);
+
+    if (timer && (_key((list_node_t *)timer) < _period_end())) {
+        return timer;
+    }
+
+    return NULL;
+}
+
+static inline void _shift_first(void)
+{
+    timer_wheel_remove(&_wheel, timer_wheel_first(&_wheel));
+}
+#else
+static inline xtimer_t *_first(void)
+{
+    return timer_list_head;
+}
+
+static inline void _shift_first(void)
+{
+    timer_list_head = timer_list_head->next;
+}
+#endif
+
 static inline void xtimer_spin_until(uint32_t target) {
 #if XTIMER_MASK
     target = _xtimer_lltimer_mask(target);
@@ -71,6 +128,10 @@ static inline void xtimer_spin_until(uint32_t target) {
 
 void xtimer_init(void)
 {
+#ifdef MODULE_XTIMER_WHEEL
+    timer_wheel_init(&_wheel, _key);
+#endif
+
     /* initialize low-level timer */
     timer_init(XTIMER_DEV, XTIMER_HZ, _periph_timer_callback, NULL);
 
@@ -122,7 +183,11 @@ void _xtimer_set64(xtimer_t *timer, uint32_t offset, uint32_t long_offset)
             timer->long_target++;
         }
 
+#ifdef MODULE_XTIMER_WHEEL
+        timer_wheel_add(&_wheel, (list_node_t *)timer);
+#else
         _add_timer_to_long_list(&long_list_head, timer);
+#endif
         irq_restore(state);
         DEBUG("xtimer_set64(): added longterm timer (long_target=%" PRIu32 " target=%" PRIu32 ")\n",
                 timer->long_target, timer->target);
@@ -197,6 +262,14 @@ int _xtimer_set_absolute(xtimer_t *timer, uint32_t target)
         timer->long_target++;
     }
 
+#ifdef MODULE_XTIMER_WHEEL
+    timer_wheel_add(&_wheel, (list_node_t *)timer);
+
+    if (_first() == timer) {
+        DEBUG("timer_set_absolute(): timer is the first one. updating lltimer.\n");
+        _lltimer_set(target - XTIMER_OVERHEAD);
+    }
+#else
     if ( (timer->long_target > _long_cnt) || !_this_high_period(target) ) {
         DEBUG("xtimer_set_absolute(): the timer doesn't fit into the low-level timer's mask.\n");
         _add_timer_to_long_list(&long_list_head, timer);
@@ -216,12 +289,14 @@ int _xtimer_set_absolute(xtimer_t *timer, uint32_t target)
             }
         }
     }
+#endif
 
     irq_restore(state);
 
     return res;
 }
 
+#ifndef MODULE_XTIMER_WHEEL
 static void _add_timer_to_list(xtimer_t **list_head, xtimer_t *timer)
 {
     while (*list_head && (*list_head)->target <= timer->target) {
@@ -257,8 +332,20 @@ static int _remove_timer_from_list(xtimer_t **list_head, xtimer_t *timer)
     return 0;
 }
 
+#endif /* MODULE_XTIMER_WHEEL */
+
 static void _remove(xtimer_t *timer)
 {
+#ifdef MODULE_XTIMER_WHEEL
+    int first = (_first() == timer);
+
+    if (timer_wheel_remove(&_wheel, (list_node_t *)timer) && first) {
+        /* schedule callback on next timer target time */
+        xtimer_t *next = _first();
+        _lltimer_set(next ? next->target - XTIMER_OVERHEAD
+                          : _xtimer_lltimer_mask(0xFFFFFFFF));
+    }
+#else
     if (timer_list_head == timer) {
         uint32_t next;
         timer_list_head = timer->next;
@@ -278,6 +365,7 @@ static void _remove(xtimer_t *timer)
             }
         }
     }
+#endif
 }
 
 void xtimer_remove(xtimer_t *timer)
@@ -314,6 +402,7 @@ static inline int _this_high_period(uint32_t target) {
 #endif
 }
 
+#ifndef MODULE_XTIMER_WHEEL
 /**
  * @brief compare two timers' target values, return the one with lower value.
  *
@@ -403,6 +492,7 @@ static void _select_long_timers(void)
         }
     }
 }
+#endif /* MODULE_XTIMER_WHEEL */
 
 /**
  * @brief handle low-level timer overflow, advance to next short timer period
@@ -421,11 +511,13 @@ static void _next_period(void)
     _long_cnt++;
 #endif
 
+#ifndef MODULE_XTIMER_WHEEL
     /* swap overflow list to current timer list */
     timer_list_head = overflow_list_head;
     overflow_list_head = NULL;
 
     _select_long_timers();
+#endif
 }
 
 /**
@@ -435,6 +527,7 @@ static void _timer_callback(void)
 {
     uint32_t next_target;
     uint32_t reference;
+    xtimer_t *timer;
 
     _in_handler = 1;
 
@@ -442,7 +535,7 @@ static void _timer_callback(void)
           xtimer_now().ticks32, _xtimer_lltimer_mask(xtimer_now().ticks32),
           _xtimer_lltimer_mask(0xffffffff - xtimer_now().ticks32));
 
-    if (!timer_list_head) {
+    if (!_first()) {
         DEBUG("_timer_callback(): tick\n");
         /* there's no timer for this timer period,
          * so this was a timer overflow callback.
@@ -467,15 +560,12 @@ static void _timer_callback(void)
 
 overflow:
     /* check if next timers are close to expiring */
-    while (timer_list_head && (_time_left(_xtimer_lltimer_mask(timer_list_head->target), reference) < XTIMER_ISR_BACKOFF)) {
+    while ((timer = _first()) && (_time_left(_xtimer_lltimer_mask(timer->target), reference) < XTIMER_ISR_BACKOFF)) {
         /* make sure we don't fire too early */
-        while (_time_left(_xtimer_lltimer_mask(timer_list_head->target), reference)) {}
-
-        /* pick first timer in list */
-        xtimer_t *timer = timer_list_head;
+        while (_time_left(_xtimer_lltimer_mask(timer->target), reference)) {}
 
         /* advance list */
-        timer_list_head = timer->next;
+        _shift_first();
 
         /* make sure timer is recognized as being already fired */
         timer->target = 0;
@@ -491,15 +581,15 @@ overflow:
      * timers.*/
     if (reference > _xtimer_lltimer_now()) {
         DEBUG("_timer_callback: overflowed while executing callbacks. %i\n",
-              timer_list_head != NULL);
+              _first() != NULL);
         _next_period();
         reference = 0;
         goto overflow;
     }
 
-    if (timer_list_head) {
+    if ((timer = _first())) {
         /* schedule callback on next timer target time */
-        next_target = timer_list_head->target - XTIMER_OVERHEAD;
+        next_target = timer->target - XTIMER_OVERHEAD;
 
         /* make sure we're not setting a time in the past */
         if (next_target < (_xtimer_lltimer_now() + XTIMER_ISR_BACKOFF)) {
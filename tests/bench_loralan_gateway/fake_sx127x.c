@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Fake SX127x transceiver for the LoRaLAN gateway benchmark
+ *
+ * @author      Oleg Artamonov
+ *
+ * @}
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include "assert.h"
+#include "irq.h"
+#include "xtimer.h"
+
+#include "sx127x.h"
+#include "ls-init-device.h"
+
+#include "fake_sx127x.h"
+
+static void push_event(fake_sx127x_t *dev, netdev_event_t event)
+{
+    unsigned state = irq_disable();
+    /* Gateway never has more than one frame in the air and one transmission in progress */
+    assert(dev->ev_head - dev->ev_tail < FAKE_SX127X_EVENTS);
+    dev->events[dev->ev_head++ & (FAKE_SX127X_EVENTS - 1)] = event;
+    irq_restore(state);
+
+    /* Interrupt line of the transceiver */
+    netdev_t *netdev = (netdev_t *)dev;
+    netdev->event_callback(netdev, NETDEV_EVENT_ISR, netdev->event_callback_arg);
+}
+
+static void _isr(netdev_t *netdev)
+{
+    fake_sx127x_t *dev = (fake_sx127x_t *)netdev;
+
+    /* Interrupt requests may merge, serve all pending events */
+    while (1) {
+        unsigned state = irq_disable();
+        if (dev->ev_tail == dev->ev_head) {
+            irq_restore(state);
+            return;
+        }
+        netdev_event_t event = dev->events[dev->ev_tail++ & (FAKE_SX127X_EVENTS - 1)];
+        irq_restore(state);
+
+        netdev->event_callback(netdev, event, netdev->event_callback_arg);
+    }
+}
+
+static int _send(netdev_t *netdev, const iolist_t *iolist)
+{
+    fake_sx127x_t *dev = (fake_sx127x_t *)netdev;
+
+    uint8_t buf[LS_FRAME_SIZE];
+    size_t len = 0;
+
+    for (const iolist_t *iol = iolist; iol; iol = iol->iol_next) {
+        if (len + iol->iol_len > sizeof(buf)) {
+            return -EOVERFLOW;
+        }
+        memcpy(buf + len, iol->iol_base, iol->iol_len);
+        len += iol->iol_len;
+    }
+
+    dev->num_tx++;
+    if (dev->tx_cb) {
+        dev->tx_cb(buf, len, dev->tx_arg);
+    }
+
+    /* Fake frame takes no time on air */
+    push_event(dev, NETDEV_EVENT_TX_COMPLETE);
+
+    return len;
+}
+
+static int _recv(netdev_t *netdev, char *buf, int len, void *info)
+{
+    fake_sx127x_t *dev = (fake_sx127x_t *)netdev;
+
+    /* Gateway asks for the frame length first */
+    if (buf == NULL) {
+        return dev->rx_len;
+    }
+
+    if ((size_t)len < dev->rx_len) {
+        return -ENOBUFS;
+    }
+
+    memcpy(buf, dev->rx_buf, dev->rx_len);
+    if (info != NULL) {
+        memcpy(info, &dev->rx_info, sizeof(dev->rx_info));
+    }
+
+    dev->rx_time = xtimer_now_usec();
+    dev->num_rx++;
+
+    /* Radio is ready for the next frame */
+    mutex_unlock(&dev->air);
+
+    return dev->rx_len;
+}
+
+void fake_sx127x_setup(fake_sx127x_t *dev, fake_sx127x_tx_cb_t tx_cb, void *arg)
+{
+    memset(dev, 0, sizeof(fake_sx127x_t));
+
+    netdev_test_setup(&dev->dev, dev);
+    dev->dev.send_cb = _send;
+    dev->dev.recv_cb = _recv;
+    dev->dev.isr_cb = _isr;
+
+    mutex_init(&dev->air);
+
+    dev->tx_cb = tx_cb;
+    dev->tx_arg = arg;
+}
+
+void fake_sx127x_inject(fake_sx127x_t *dev, const uint8_t *buf, size_t len, int16_t rssi, int8_t snr)
+{
+    assert(len <= LS_FRAME_SIZE);
+
+    mutex_lock(&dev->air);
+
+    memcpy(dev->rx_buf, buf, len);
+    dev->rx_len = len;
+    dev->rx_info.rssi = rssi;
+    dev->rx_info.snr = snr;
+    dev->rx_info.lqi = 0;
+
+    push_event(dev, NETDEV_EVENT_RX_COMPLETE);
+}
+
+void fake_sx127x_flush(fake_sx127x_t *dev)
+{
+    mutex_lock(&dev->air);
+    mutex_unlock(&dev->air);
+}
+
+/* Driver functions the gateway uses directly */
+
+uint32_t sx127x_random(sx127x_t *dev)
+{
+    (void)dev;
+
+    /* Reproducible runs */
+    return 0x5EED;
+}
+
+void ls_setup_sx127x(netdev_t *netdev, ls_datarate_t dr, uint32_t frequency)
+{
+    fake_sx127x_t *dev = (fake_sx127x_t *)netdev;
+
+    dev->dr = dr;
+    dev->frequency = frequency;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Fake SX127x transceiver for the LoRaLAN gateway benchmark
+ *
+ * Frames "received" by the fake radio are injected by the benchmark, frames
+ * sent by the gateway are handed over to the callback and complete at once.
+ * Interrupts are raised the same way the real driver does, so the gateway
+ * services them in its own ISR thread.
+ *
+ * @author      Oleg Artamonov
+ */
+#ifndef FAKE_SX127X_H
+#define FAKE_SX127X_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "mutex.h"
+#include "net/netdev.h"
+#include "net/netdev_test.h"
+#include "sx127x_netdev.h"
+
+#include "ls-mac-types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of interrupt events the fake radio can keep, must be a power of two
+ */
+#define FAKE_SX127X_EVENTS 8
+
+/**
+ * @brief Callback called for every frame sent by the gateway
+ */
+typedef void (*fake_sx127x_tx_cb_t)(const uint8_t *buf, size_t len, void *arg);
+
+/**
+ * @brief Fake SX127x device
+ */
+typedef struct {
+    netdev_test_t dev;                              /**< Test network device, must be first */
+
+    mutex_t air;                                    /**< Locked while injected frame is not read by the gateway */
+    uint8_t rx_buf[LS_FRAME_SIZE];                  /**< Injected frame */
+    size_t rx_len;                                  /**< Length of the injected frame */
+    netdev_sx127x_lora_packet_info_t rx_info;       /**< Link quality of the injected frame */
+    uint32_t rx_time;                               /**< Time the injected frame was read by the gateway [us] */
+
+    netdev_event_t events[FAKE_SX127X_EVENTS];      /**< Events waiting for the interrupt to be serviced */
+    unsigned ev_head;                               /**< Number of events pushed */
+    unsigned ev_tail;                               /**< Number of events serviced */
+
+    fake_sx127x_tx_cb_t tx_cb;                      /**< Sent frames handler */
+    void *tx_arg;                                   /**< Sent frames handler argument */
+
+    ls_datarate_t dr;                               /**< Data rate set by the gateway */
+    uint32_t frequency;                             /**< Frequency set by the gateway [Hz] */
+
+    uint32_t num_rx;                                /**< Frames read by the gateway */
+    uint32_t num_tx;                                /**< Frames sent by the gateway */
+} fake_sx127x_t;
+
+/**
+ * @brief Sets up the fake radio, must be called before the gateway opens the channel.
+ *
+ * @param	*dev	pointer to the fake radio
+ * @param	tx_cb	sent frames handler, may be NULL
+ * @param	*arg	sent frames handler argument
+ */
+void fake_sx127x_setup(fake_sx127x_t *dev, fake_sx127x_tx_cb_t tx_cb, void *arg);
+
+/**
+ * @brief Makes the gateway receive the frame.
+ *
+ * Waits for the gateway to read the previously injected frame first,
+ * as the radio holds only one.
+ *
+ * @param	*dev	pointer to the fake radio
+ * @param	*buf	frame data
+ * @param	len		frame length, up to LS_FRAME_SIZE bytes
+ * @param	rssi	RSSI of the frame [dBm]
+ * @param	snr		SNR of the frame [dB]
+ */
+void fake_sx127x_inject(fake_sx127x_t *dev, const uint8_t *buf, size_t len, int16_t rssi, int8_t snr);
+
+/**
+ * @brief Waits for the gateway to read the last injected frame.
+ *
+ * @param	*dev	pointer to the fake radio
+ */
+void fake_sx127x_flush(fake_sx127x_t *dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAKE_SX127X_H */
+/** @} */
@@ -0,0 +1,497 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       LoRaLAN gateway MAC throughput benchmark
+ *
+ * Thousands of virtual nodes join the gateway and send uplinks through the
+ * fake transceiver. Gateway runs unmodified in its own threads, frames are
+ * injected as fast as it reads them.
+ *
+ * @author      Oleg Artamonov
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "bitarithm.h"
+#include "random.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#include "ls-mac.h"
+#include "ls-crypto.h"
+#include "ls-gate.h"
+#include "pending-fifo.h"
+#include "gate-commands.h"
+
+#include "fake_sx127x.h"
+
+/**
+ * @brief Number of virtual nodes, nodes above LS_GATE_MAX_NODES push out the least recent ones
+ */
+#ifndef BENCH_NODES
+#define BENCH_NODES LS_GATE_MAX_NODES
+#endif
+
+/**
+ * @brief Number of uplinks every node sends
+ */
+#ifndef BENCH_UPLINKS
+#define BENCH_UPLINKS 4
+#endif
+
+/**
+ * @brief Share of the confirmed uplinks [%]
+ */
+#ifndef BENCH_CONFIRMED_PCT
+#define BENCH_CONFIRMED_PCT 25
+#endif
+
+/**
+ * @brief Application payload length of the uplinks
+ */
+#ifndef BENCH_PAYLOAD_LEN
+#define BENCH_PAYLOAD_LEN 16
+#endif
+
+/**
+ * @brief Number of samples for each of the MAC stages timed separately
+ */
+#ifndef BENCH_STAGE_SAMPLES
+#define BENCH_STAGE_SAMPLES 2000
+#endif
+
+#define BENCH_DEV_ID_BASE   0x0123456700000000ULL
+#define BENCH_APP_ID        0x00000000DEADBEEFULL
+
+/* Prepared frame of the node, either join request or uplink */
+#define BENCH_FRAME_LEN     (LS_FRAME_MINIMUM_SIZE + \
+                             (BENCH_PAYLOAD_LEN > sizeof(ls_join_req_t) ? BENCH_PAYLOAD_LEN : sizeof(ls_join_req_t)))
+
+/**
+ * @brief Latency histogram, bucket N holds values in [2^(N-1), 2^N) us, bucket 0 is below 1 us
+ */
+#define HIST_BUCKETS 20
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t buckets[HIST_BUCKETS];
+} hist_t;
+
+/**
+ * @brief Virtual node
+ */
+typedef struct {
+    uint32_t dev_nonce;
+    uint32_t app_nonce;
+    ls_addr_t addr;
+    bool joined;
+    ls_frame_id_t fid;
+    uint8_t mic_key[LS_MIC_KEY_LEN];
+    uint8_t aes_key[AES_KEY_SIZE];
+} vnode_t;
+
+static uint8_t join_key[AES_KEY_SIZE] = {
+    0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+    0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C,
+};
+
+static ls_gate_t ls;
+static fake_sx127x_t radio;
+static ls_gate_channel_t channels[1] = {
+    { .dr = LS_DR5, .frequency = 868800000 },
+};
+
+static vnode_t vnodes[BENCH_NODES];
+static uint8_t frames[BENCH_NODES][BENCH_FRAME_LEN];
+static uint8_t frame_lens[BENCH_NODES];
+
+/* Replies to the host */
+static gc_pending_fifo_t fifo;
+
+static hist_t h_join, h_uplink, h_serial_text, h_serial_slip;
+static hist_t h_lookup, h_keys, h_mic;
+
+static volatile uint32_t num_joined, num_received, num_kicked;
+
+static void hist_add(hist_t *h, uint32_t us)
+{
+    unsigned bucket = us ? bitarithm_msb(us) + 1 : 0;
+    if (bucket >= HIST_BUCKETS) {
+        bucket = HIST_BUCKETS - 1;
+    }
+
+    if (h->count == 0 || us < h->min) {
+        h->min = us;
+    }
+    if (us > h->max) {
+        h->max = us;
+    }
+
+    h->count++;
+    h->sum += us;
+    h->buckets[bucket]++;
+}
+
+static void hist_print(const char *name, const hist_t *h)
+{
+    if (h->count == 0) {
+        printf("%s: no samples\n", name);
+        return;
+    }
+
+    printf("%s: %" PRIu32 " samples, min %" PRIu32 " us, mean %" PRIu32 " us, max %" PRIu32 " us\n",
+           name, h->count, h->min, (uint32_t)(h->sum / h->count), h->max);
+
+    for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+        if (h->buckets[i] == 0) {
+            continue;
+        }
+
+        if (i == 0) {
+            printf("    %8s .. %7u us: %" PRIu32 "\n", "", 1U, h->buckets[i]);
+        }
+        else {
+            printf("    %8lu .. %7lu us: %" PRIu32 "\n",
+                   1UL << (i - 1), 1UL << i, h->buckets[i]);
+        }
+    }
+}
+
+static inline vnode_t *vnode_by_id(uint64_t node_id)
+{
+    uint64_t idx = node_id - BENCH_DEV_ID_BASE;
+    if (idx >= BENCH_NODES) {
+        return NULL;
+    }
+
+    return &vnodes[idx];
+}
+
+static uint32_t node_joined_cb(ls_gate_node_t *node)
+{
+    uint32_t latency = xtimer_now_usec() - radio.rx_time;
+    hist_add(&h_join, latency);
+
+    vnode_t *v = vnode_by_id(node->node_id);
+    if (v == NULL) {
+        return 0;
+    }
+
+    v->addr = node->addr;
+    v->app_nonce = random_uint32();
+    num_joined++;
+
+    return v->app_nonce;
+}
+
+static void node_kicked_cb(ls_gate_node_t *node)
+{
+    (void)node;
+
+    num_kicked++;
+}
+
+/* Host link is infinitely fast */
+static void drain_replies(void)
+{
+    const uint8_t *data;
+    size_t len;
+    while ((len = gc_pending_fifo_peek(&fifo, &data)) > 0) {
+        gc_pending_fifo_consume(&fifo, len);
+    }
+}
+
+static void app_data_received_cb(ls_gate_node_t *node, ls_gate_channel_t *ch, uint8_t *buf, size_t bufsize, uint8_t status)
+{
+    hist_add(&h_uplink, xtimer_now_usec() - radio.rx_time);
+
+    gc_reply_ind(&fifo, node, ch->last_rssi, status, buf, bufsize);
+    num_received++;
+
+    drain_replies();
+}
+
+static void build_join_req(unsigned idx)
+{
+    vnode_t *v = &vnodes[idx];
+    ls_frame_t frame;
+
+    v->dev_nonce = random_uint32();
+    v->joined = false;
+
+    ls_join_req_t req = {
+        .dev_id = BENCH_DEV_ID_BASE + idx,
+        .app_id = BENCH_APP_ID,
+        .dev_nonce = v->dev_nonce,
+        .node_class = LS_ED_CLASS_A,
+    };
+
+    ls_assemble_frame(LS_ADDR_UNDEFINED, LS_UL_JOIN_REQ, (uint8_t *) &req, sizeof(req), &frame);
+
+    size_t payload_size;
+    ls_encrypt_frame(join_key, join_key, &frame, &payload_size);
+
+    frame_lens[idx] = LS_FRAME_MINIMUM_SIZE + payload_size;
+    memcpy(frames[idx], &frame, frame_lens[idx]);
+}
+
+static void build_uplink(unsigned idx)
+{
+    vnode_t *v = &vnodes[idx];
+    ls_frame_t frame;
+    uint8_t payload[BENCH_PAYLOAD_LEN];
+
+    for (unsigned i = 0; i < sizeof(payload); i++) {
+        payload[i] = idx + i;
+    }
+
+    ls_type_t type = (random_uint32_range(0, 100) < BENCH_CONFIRMED_PCT) ? LS_UL_CONF : LS_UL_UNC;
+    ls_assemble_frame(v->addr, type, payload, sizeof(payload), &frame);
+    frame.header.fid = ++v->fid;
+
+    size_t payload_size;
+    ls_encrypt_frame(v->mic_key, v->aes_key, &frame, &payload_size);
+
+    frame_lens[idx] = LS_FRAME_MINIMUM_SIZE + payload_size;
+    memcpy(frames[idx], &frame, frame_lens[idx]);
+}
+
+/**
+ * @brief Injects prepared frames of the nodes, returns time it took the gateway to process them [us]
+ */
+static uint32_t storm(bool joined_only)
+{
+    uint32_t start = xtimer_now_usec();
+
+    for (unsigned i = 0; i < BENCH_NODES; i++) {
+        if (joined_only && !vnodes[i].joined) {
+            continue;
+        }
+
+        /* Nodes are heard with different link quality */
+        fake_sx127x_inject(&radio, frames[i], frame_lens[i], -60 - (i % 60), 10 - (i % 20));
+    }
+
+    /* Gateway threads outrank the main one, all frames are processed once the last one is read */
+    fake_sx127x_flush(&radio);
+
+    return xtimer_now_usec() - start;
+}
+
+static void print_rate(const char *name, uint32_t frames_num, uint32_t time_us)
+{
+    uint32_t rate = time_us ? (uint32_t)(((uint64_t) frames_num * US_PER_SEC) / time_us) : 0;
+    printf("%s: %" PRIu32 " frames in %" PRIu32 " us, %" PRIu32 " frames/s\n", name, frames_num, time_us, rate);
+}
+
+static uint32_t bench_joins(void)
+{
+    for (unsigned i = 0; i < BENCH_NODES; i++) {
+        build_join_req(i);
+    }
+
+    uint32_t time_us = storm(false);
+    print_rate("Join storm", num_joined, time_us);
+
+    /* Nodes derive session keys from the join ACK contents the gateway reported */
+    unsigned num_active = 0;
+    for (unsigned i = 0; i < BENCH_NODES; i++) {
+        vnode_t *v = &vnodes[i];
+        ls_gate_node_t *node = ls_devlist_get_by_nodeid(&ls.devices, BENCH_DEV_ID_BASE + i);
+
+        if (node == NULL || node->addr != v->addr) {
+            continue;
+        }
+
+        ls_derive_keys(v->dev_nonce, v->app_nonce, v->addr, v->mic_key, v->aes_key);
+        v->fid = 0;
+        v->joined = true;
+        num_active++;
+    }
+
+    printf("Nodes in network: %u, kicked: %" PRIu32 "\n", num_active, num_kicked);
+
+    return time_us ? (uint32_t)(((uint64_t) num_joined * US_PER_SEC) / time_us) : 0;
+}
+
+static uint32_t bench_uplinks(void)
+{
+    uint32_t time_us = 0;
+    uint32_t received = num_received;
+
+    for (unsigned n = 0; n < BENCH_UPLINKS; n++) {
+        for (unsigned i = 0; i < BENCH_NODES; i++) {
+            if (vnodes[i].joined) {
+                build_uplink(i);
+            }
+        }
+
+        time_us += storm(true);
+    }
+
+    received = num_received - received;
+    print_rate("Uplink storm", received, time_us);
+    printf("Downlinks sent: %" PRIu32 "\n", radio.num_tx);
+
+    return time_us ? (uint32_t)(((uint64_t) received * US_PER_SEC) / time_us) : 0;
+}
+
+/**
+ * @brief Times the stages of the uplink processing one by one on the live devices list
+ */
+static void bench_stages(void)
+{
+    for (unsigned n = 0; n < BENCH_STAGE_SAMPLES; n++) {
+        unsigned idx = random_uint32_range(0, BENCH_NODES);
+        if (!vnodes[idx].joined) {
+            continue;
+        }
+
+        uint32_t start = xtimer_now_usec();
+        ls_gate_node_t *node = ls_devlist_get_by_nodeid(&ls.devices, BENCH_DEV_ID_BASE + idx);
+        hist_add(&h_lookup, xtimer_now_usec() - start);
+
+        if (node == NULL) {
+            continue;
+        }
+
+        /* Cold session, keys are derived again */
+        ls_gate_session_t session;
+        ls_devlist_invalidate_session(&ls.devices, node->addr);
+
+        start = xtimer_now_usec();
+        ls_devlist_get_session(&ls.devices, node, &session);
+        hist_add(&h_keys, xtimer_now_usec() - start);
+
+        ls_frame_t frame;
+        memcpy(&frame, frames[idx], frame_lens[idx]);
+
+        start = xtimer_now_usec();
+        if (!ls_validate_frame_mic_ctx(&session.mic_ctx, &frame)) {
+            printf("MIC mismatch for node %u\n", idx);
+        }
+        hist_add(&h_mic, xtimer_now_usec() - start);
+
+        /* Received data goes to the host in both framings the host can select */
+        uint8_t payload[BENCH_PAYLOAD_LEN];
+        for (unsigned i = 0; i < sizeof(payload); i++) {
+            payload[i] = idx + i;
+        }
+
+        gc_set_framing(GC_FRAMING_TEXT);
+        start = xtimer_now_usec();
+        gc_reply_ind(&fifo, node, channels[0].last_rssi, 0, payload, sizeof(payload));
+        hist_add(&h_serial_text, xtimer_now_usec() - start);
+        drain_replies();
+
+        gc_set_framing(GC_FRAMING_BINARY);
+        start = xtimer_now_usec();
+        gc_reply_ind(&fifo, node, channels[0].last_rssi, 0, payload, sizeof(payload));
+        hist_add(&h_serial_slip, xtimer_now_usec() - start);
+        drain_replies();
+    }
+
+    gc_set_framing(GC_FRAMING_TEXT);
+}
+
+static void print_stacks(void)
+{
+    puts("Peak stack use:");
+
+    for (kernel_pid_t pid = KERNEL_PID_FIRST; pid <= KERNEL_PID_LAST; pid++) {
+        volatile thread_t *t = thread_get(pid);
+        if (t == NULL) {
+            continue;
+        }
+
+#ifdef DEVELHELP
+        int used = t->stack_size - thread_measure_stack_free(t->stack_start);
+        printf("    %-24s %5d of %5d bytes\n", t->name, used, t->stack_size);
+#else
+        puts("    build with DEVELHELP=1 to measure");
+        break;
+#endif
+    }
+}
+
+int main(void)
+{
+    puts("LoRaLAN gateway benchmark");
+    printf("%u nodes, %u uplinks per node, %u%% confirmed, %u bytes payload\n",
+           (unsigned) BENCH_NODES, (unsigned) BENCH_UPLINKS, (unsigned) BENCH_CONFIRMED_PCT, (unsigned) BENCH_PAYLOAD_LEN);
+
+    gc_pending_fifo_init(&fifo);
+
+    fake_sx127x_setup(&radio, NULL, NULL);
+    channels[0]._internal.device = (netdev_t *) &radio;
+
+    ls.settings.gate_id = 0x0000000000000001ULL;
+    ls.settings.join_key = join_key;
+
+    ls.channels = channels;
+    ls.num_channels = sizeof(channels) / sizeof(channels[0]);
+
+    ls.accept_node_join_cb = NULL;
+    ls.node_joined_cb = node_joined_cb;
+    ls.node_kicked_cb = node_kicked_cb;
+    ls.app_data_received_cb = app_data_received_cb;
+    ls.app_data_ack_cb = NULL;
+    ls.pending_frames_req = NULL;
+
+    if (ls_gate_init(&ls) != LS_GATE_OK) {
+        puts("Gateway initialization failed");
+        return 1;
+    }
+
+    uint32_t joins_rate = bench_joins();
+    uint32_t uplinks_rate = bench_uplinks();
+    bench_stages();
+
+    puts("\nLatency from the frame read by the gateway:");
+    hist_print("Join accepted", &h_join);
+    hist_print("Uplink delivered", &h_uplink);
+
+    puts("\nStages:");
+    hist_print("Devices list lookup", &h_lookup);
+    hist_print("Session keys derivation", &h_keys);
+    hist_print("MIC validation", &h_mic);
+    hist_print("Host serialization, text", &h_serial_text);
+    hist_print("Host serialization, SLIP", &h_serial_slip);
+
+    puts("");
+    print_stacks();
+
+    printf("{ \"joins_per_sec\" : %" PRIu32 ", \"uplinks_per_sec\" : %" PRIu32 " }\n", joins_rate, uplinks_rate);
+
+    return 0;
+}
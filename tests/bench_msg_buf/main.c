@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Pooled message buffers benchmark
+ *
+ * @author      Oleg Artamonov
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "thread.h"
+#include "msg.h"
+#include "msg_buf.h"
+#include "xtimer.h"
+
+#ifndef TEST_DURATION
+#define TEST_DURATION       (1000000U)
+#endif
+
+#ifndef PAYLOAD_SIZE
+#define PAYLOAD_SIZE        (128)
+#endif
+
+#define POOL_BLOCKS         (4)
+
+enum {
+    MSG_COPY = 0x4201,
+    MSG_BUF,
+};
+
+volatile unsigned _flag = 0;
+static char _stack[THREAD_STACKSIZE_MAIN];
+
+static uint8_t _shared[PAYLOAD_SIZE];
+
+static msg_buf_pool_t _pool;
+static MSG_BUF_POOL_DATA(_pool_data, PAYLOAD_SIZE, POOL_BLOCKS);
+
+static void _timer_callback(void*arg)
+{
+    (void)arg;
+
+    _flag = 1;
+}
+
+static void *_second_thread(void *arg)
+{
+    (void)arg;
+    msg_t test;
+    uint8_t local[PAYLOAD_SIZE];
+
+    while(1) {
+        msg_receive(&test);
+
+        switch (test.type) {
+            case MSG_COPY:
+                /* sender may overwrite the buffer as soon as we block again */
+                memcpy(local, test.content.ptr, PAYLOAD_SIZE);
+                break;
+            case MSG_BUF:
+                msg_buf_free(msg_buf_get(&test));
+                break;
+        }
+    }
+
+    return NULL;
+}
+
+static uint32_t _run(kernel_pid_t other, uint16_t type)
+{
+    xtimer_t timer;
+    timer.callback = _timer_callback;
+
+    msg_t test;
+    test.type = type;
+
+    uint32_t n = 0;
+
+    _flag = 0;
+    xtimer_set(&timer, TEST_DURATION);
+    while(!_flag) {
+        if (type == MSG_COPY) {
+            test.content.ptr = _shared;
+            msg_send(&test, other);
+        }
+        else {
+            void *buf = msg_buf_alloc(&_pool);
+            if (buf && (msg_buf_send(&test, other, buf) != 1)) {
+                msg_buf_free(buf);
+            }
+        }
+        n++;
+    }
+
+    return n;
+}
+
+int main(void)
+{
+    printf("main starting\n");
+
+    msg_buf_pool_init(&_pool, _pool_data, PAYLOAD_SIZE, POOL_BLOCKS);
+
+    kernel_pid_t other = thread_create(_stack,
+                                       sizeof(_stack),
+                                       (THREAD_PRIORITY_MAIN - 1),
+                                       THREAD_CREATE_STACKTEST,
+                                       _second_thread,
+                                       NULL,
+                                       "second_thread");
+
+    uint32_t copy = _run(other, MSG_COPY);
+    uint32_t zero_copy = _run(other, MSG_BUF);
+
+    unsigned leaks = 0;
+#ifdef DEVELHELP
+    msg_buf_pool_print(&_pool);
+    leaks = msg_buf_pool_leaks(&_pool);
+#endif
+
+    printf("{ \"copy\" : %"PRIu32", \"zero_copy\" : %"PRIu32", \"leaks\" : %u }\n",
+           copy, zero_copy, leaks);
+
+    return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Priority inheritance mutex benchmark
+ *
+ * @author      Oleg Artamonov
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "mutex.h"
+#include "mutex_pi.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#ifndef TEST_DURATION
+#define TEST_DURATION       (2000000U)
+#endif
+
+#define LOW_HOLD_US         (1000U)
+#define LOW_PERIOD_US       (3000U)
+#define MID_BUSY_US         (10000U)
+#define MID_PERIOD_US       (25000U)
+#define HIGH_PERIOD_US      (7000U)
+
+enum {
+    PHASE_PLAIN = 0,
+    PHASE_PI,
+    PHASE_DONE,
+};
+
+typedef struct {
+    uint32_t count;
+    uint64_t sum_us;
+    uint32_t max_us;
+} wait_stats_t;
+
+static volatile unsigned _phase = PHASE_PLAIN;
+static volatile unsigned _flag = 0;
+
+static mutex_t _mutex = MUTEX_INIT;
+static mutex_pi_t _mutex_pi = MUTEX_PI_INIT;
+
+static wait_stats_t _stats[2];
+
+static char _stack_low[THREAD_STACKSIZE_DEFAULT];
+static char _stack_mid[THREAD_STACKSIZE_DEFAULT];
+static char _stack_high[THREAD_STACKSIZE_DEFAULT];
+
+static void _lock(int pi)
+{
+    if (pi) {
+        mutex_pi_lock(&_mutex_pi);
+    }
+    else {
+        mutex_lock(&_mutex);
+    }
+}
+
+static void _unlock(int pi)
+{
+    if (pi) {
+        mutex_pi_unlock(&_mutex_pi);
+    }
+    else {
+        mutex_unlock(&_mutex);
+    }
+}
+
+/* keeps the CPU busy, time spent preempted counts too */
+static void _spin(uint32_t us)
+{
+    uint32_t start = xtimer_now_usec();
+    while (xtimer_now_usec() - start < us) {}
+}
+
+static void *_low(void *arg)
+{
+    (void)arg;
+
+    while (_phase != PHASE_DONE) {
+        int pi = (_phase == PHASE_PI);
+
+        _lock(pi);
+        _spin(LOW_HOLD_US);
+        _unlock(pi);
+
+        xtimer_usleep(LOW_PERIOD_US - LOW_HOLD_US);
+    }
+
+    return NULL;
+}
+
+static void *_mid(void *arg)
+{
+    (void)arg;
+
+    while (_phase != PHASE_DONE) {
+        xtimer_usleep(MID_PERIOD_US - MID_BUSY_US);
+        _spin(MID_BUSY_US);
+    }
+
+    return NULL;
+}
+
+static void *_high(void *arg)
+{
+    (void)arg;
+
+    while (_phase != PHASE_DONE) {
+        xtimer_usleep(HIGH_PERIOD_US);
+
+        int pi = (_phase == PHASE_PI);
+
+        uint32_t start = xtimer_now_usec();
+        _lock(pi);
+        uint32_t wait = xtimer_now_usec() - start;
+        _unlock(pi);
+
+        _stats[pi].count++;
+        _stats[pi].sum_us += wait;
+        if (wait > _stats[pi].max_us) {
+            _stats[pi].max_us = wait;
+        }
+    }
+
+    return NULL;
+}
+
+static void _timer_callback(void *arg)
+{
+    (void)arg;
+
+    _flag = 1;
+}
+
+/* uncontended lock/unlock pairs in TEST_DURATION */
+static uint32_t _ops(int pi)
+{
+    xtimer_t timer;
+    timer.callback = _timer_callback;
+
+    uint32_t n = 0;
+
+    _flag = 0;
+    xtimer_set(&timer, TEST_DURATION);
+    while (!_flag) {
+        _lock(pi);
+        _unlock(pi);
+        n++;
+    }
+
+    return n;
+}
+
+static void _print_stats(const char *name, const wait_stats_t *stats)
+{
+    printf("%s: %" PRIu32 " locks, wait avg %" PRIu32 " us, max %" PRIu32 " us\n",
+           name, stats->count,
+           stats->count ? (uint32_t)(stats->sum_us / stats->count) : 0,
+           stats->max_us);
+}
+
+int main(void)
+{
+    puts("Priority inheritance mutex benchmark");
+
+    thread_create(_stack_low, sizeof(_stack_low), THREAD_PRIORITY_MAIN - 1,
+                  THREAD_CREATE_STACKTEST, _low, NULL, "t_low");
+    thread_create(_stack_mid, sizeof(_stack_mid), THREAD_PRIORITY_MAIN - 2,
+                  THREAD_CREATE_STACKTEST, _mid, NULL, "t_mid");
+    thread_create(_stack_high, sizeof(_stack_high), THREAD_PRIORITY_MAIN - 3,
+                  THREAD_CREATE_STACKTEST, _high, NULL, "t_high");
+
+    xtimer_usleep(TEST_DURATION);
+    _phase = PHASE_PI;
+    xtimer_usleep(TEST_DURATION);
+    _phase = PHASE_DONE;
+
+    /* let the threads finish their last iteration */
+    xtimer_usleep(MID_PERIOD_US * 2);
+
+    _print_stats("mutex_t", &_stats[0]);
+    _print_stats("mutex_pi_t", &_stats[1]);
+
+    uint32_t plain_ops = _ops(0);
+    uint32_t pi_ops = _ops(1);
+
+    printf("{ \"plain_max_us\" : %" PRIu32 ", \"pi_max_us\" : %" PRIu32
+           ", \"plain_ops\" : %" PRIu32 ", \"pi_ops\" : %" PRIu32 " }\n",
+           _stats[0].max_us, _stats[1].max_us, plain_ops, pi_ops);
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+
+def testfunc(child):
+    child.expect(r"{ \"plain_max_us\" : (\d+), \"pi_max_us\" : (\d+), "
+                 r"\"plain_ops\" : (\d+), \"pi_ops\" : (\d+) }", timeout=30)
+    # mid priority thread must not delay the high priority one with PI
+    assert int(child.match.group(2)) < int(child.match.group(1))
+    assert int(child.match.group(4)) > 0
+
+
+if __name__ == "__main__":
+    sys.path.append(os.path.join(os.environ['RIOTTOOLS'], 'testrunner'))
+    from testrunner import run
+    sys.exit(run(testfunc))
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       GNRC packet buffer allocation throughput and fragmentation benchmark
+ *
+ * @author      Oleg Artamonov
+ *
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "net/gnrc/pktbuf.h"
+#include "net/gnrc/netif/hdr.h"
+#include "random.h"
+#include "xtimer.h"
+
+#ifndef TEST_DURATION
+#define TEST_DURATION       (1000000U)
+#endif
+
+/* packets held at once */
+#define HELD                (16)
+
+#define IPV6_HDR_LEN        (40)
+#define UDP_HDR_LEN         (8)
+#define FRAME_LEN_MIN       (IPV6_HDR_LEN + UDP_HDR_LEN)
+#define FRAME_LEN_MAX       (127)
+#define DATAGRAM_LEN        (1280)
+
+static gnrc_pktsnip_t *_held[HELD];
+static unsigned _failed = 0;
+
+/**
+ * @brief received frame, netif header in front, IPv6 and UDP headers marked off
+ */
+static gnrc_pktsnip_t *_rx_frame(void)
+{
+    size_t len = random_uint32_range(FRAME_LEN_MIN, FRAME_LEN_MAX + 1);
+    gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(NULL, NULL, len, GNRC_NETTYPE_UNDEF);
+    if (pkt == NULL) {
+        return NULL;
+    }
+
+    gnrc_pktsnip_t *netif = gnrc_pktbuf_add(pkt, NULL, sizeof(gnrc_netif_hdr_t) + 2 * 8,
+                                            GNRC_NETTYPE_NETIF);
+    if (netif == NULL) {
+        gnrc_pktbuf_release(pkt);
+        return NULL;
+    }
+
+    if ((gnrc_pktbuf_mark(pkt, IPV6_HDR_LEN, GNRC_NETTYPE_TEST) == NULL) ||
+        (gnrc_pktbuf_mark(pkt, UDP_HDR_LEN, GNRC_NETTYPE_TEST) == NULL)) {
+        gnrc_pktbuf_release(netif);
+        return NULL;
+    }
+
+    return netif;
+}
+
+/**
+ * @brief outgoing datagram, headers are prepended to the payload
+ */
+static gnrc_pktsnip_t *_tx_datagram(void)
+{
+    size_t len = random_uint32_range(1, FRAME_LEN_MAX - FRAME_LEN_MIN + 1);
+    gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(NULL, NULL, len, GNRC_NETTYPE_UNDEF);
+    if (pkt == NULL) {
+        return NULL;
+    }
+
+    static const size_t hdr_len[] = { UDP_HDR_LEN, IPV6_HDR_LEN, sizeof(gnrc_netif_hdr_t) + 2 * 8 };
+    for (unsigned i = 0; i < sizeof(hdr_len) / sizeof(hdr_len[0]); i++) {
+        gnrc_pktsnip_t *hdr = gnrc_pktbuf_add(pkt, NULL, hdr_len[i], GNRC_NETTYPE_TEST);
+        if (hdr == NULL) {
+            gnrc_pktbuf_release(pkt);
+            return NULL;
+        }
+        pkt = hdr;
+    }
+
+    return pkt;
+}
+
+/**
+ * @brief reassembled datagram
+ */
+static gnrc_pktsnip_t *_datagram(void)
+{
+    return gnrc_pktbuf_add(NULL, NULL, DATAGRAM_LEN, GNRC_NETTYPE_UNDEF);
+}
+
+static void _hold(gnrc_pktsnip_t *pkt)
+{
+    for (unsigned i = 0; i < HELD; i++) {
+        if (_held[i] == NULL) {
+            _held[i] = pkt;
+            return;
+        }
+    }
+
+    unsigned i = random_uint32_range(0, HELD);
+    gnrc_pktbuf_release(_held[i]);
+    _held[i] = pkt;
+}
+
+/**
+ * @brief returns size of the largest snip that can be allocated now
+ */
+static size_t _largest(void)
+{
+    size_t low = 0;
+    size_t high = GNRC_PKTBUF_SIZE - 1;
+
+    while (low < high) {
+        size_t size = (low + high + 1) / 2;
+        gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(NULL, NULL, size, GNRC_NETTYPE_UNDEF);
+
+        if (pkt) {
+            gnrc_pktbuf_release(pkt);
+            low = size;
+        }
+        else {
+            high = size - 1;
+        }
+    }
+
+    return low;
+}
+
+int main(void)
+{
+    unsigned packets = 0;
+
+    puts("GNRC packet buffer benchmark");
+
+    gnrc_pktbuf_init();
+
+    uint32_t end = xtimer_now_usec() + TEST_DURATION;
+    while ((int32_t)(end - xtimer_now_usec()) > 0) {
+        gnrc_pktsnip_t *pkt;
+        uint32_t kind = random_uint32_range(0, 32);
+
+        if (kind == 0) {
+            pkt = _datagram();
+        }
+        else if (kind & 1) {
+            pkt = _rx_frame();
+        }
+        else {
+            pkt = _tx_datagram();
+        }
+
+        if (pkt == NULL) {
+            _failed++;
+            /* make room for the next one */
+            pkt = _held[kind % HELD];
+            _held[kind % HELD] = NULL;
+            gnrc_pktbuf_release(pkt);
+            continue;
+        }
+
+        _hold(pkt);
+        packets++;
+    }
+
+    printf("{ \"packets\" : %u, \"failed\" : %u, \"largest\" : %u }\n",
+           packets, _failed, (unsigned)_largest());
+
+    for (unsigned i = 0; i < HELD; i++) {
+        gnrc_pktbuf_release(_held[i]);
+        _held[i] = NULL;
+    }
+
+    if (gnrc_pktbuf_is_sane() && gnrc_pktbuf_is_empty()) {
+        puts("[SUCCESS]");
+    }
+    else {
+        puts("[FAILED]");
+    }
+
+    return 0;
+}
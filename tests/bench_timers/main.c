@@ -43,11 +43,16 @@
 #include "print_results.h"
 #include "spin_random.h"
 #include "bench_timers_config.h"
+#include "set_remove.h"
 
 #ifndef TEST_TRACE
 #define TEST_TRACE 0
 #endif
 
+#ifndef TEST_SET_REMOVE
+#define TEST_SET_REMOVE 0
+#endif
+
 /*
  * All different variations will be mixed to provide the most varied input
  * vector possible for the benchmark. A more varied input should yield a more
@@ -616,6 +621,12 @@ static void estimate_cpu_overhead(void)
 
 int main(void)
 {
+    if (TEST_SET_REMOVE) {
+        random_init(seed);
+        set_remove_run();
+        return 0;
+    }
+
     print_str("\nStatistical benchmark for timers\n");
     for (unsigned int k = 0; k < (sizeof(ref_states) / sizeof(ref_states[0])); ++k) {
         matstat_clear(&ref_states[k]);
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Set/remove cost benchmark for xtimer and rtctimers-millis
+ *
+ * @author      Oleg Artamonov
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "xtimer.h"
+#include "random.h"
+#ifdef MODULE_RTCTIMERS_MILLIS
+#include "rtctimers-millis.h"
+#endif
+
+#include "set_remove.h"
+
+/* timers set and removed in one batch */
+#define PROBES              (100)
+/* batches per measurement */
+#define ROUNDS              (10)
+
+/* armed timers never expire during the measurement */
+#define OFFSET_MIN_MS       (1U * MS_PER_SEC)
+#define OFFSET_MAX_MS       (60U * MS_PER_SEC)
+
+/**
+ * @brief   Timer API under measurement
+ */
+typedef struct {
+    const char *name;
+    void *timers;                       /**< MAX_TIMERS armed timers */
+    void *probes;                       /**< PROBES timers set and removed */
+    size_t size;                        /**< Size of the timer structure */
+    void (*set)(void *timer, uint32_t offset_ms);
+    void (*remove)(void *timer);
+} set_remove_api_t;
+
+/* offsets of the probes, drawn outside of the measured loop */
+static uint32_t _offsets[PROBES];
+
+static void _nop(void *arg)
+{
+    (void)arg;
+}
+
+static xtimer_t _xtimers[MAX_TIMERS];
+static xtimer_t _xtimer_probes[PROBES];
+
+static void _xtimers_set(void *timer, uint32_t offset_ms)
+{
+    ((xtimer_t *)timer)->callback = _nop;
+    xtimer_set(timer, offset_ms * US_PER_MS);
+}
+
+static void _xtimers_remove(void *timer)
+{
+    xtimer_remove(timer);
+}
+
+#ifdef MODULE_RTCTIMERS_MILLIS
+static rtctimers_millis_t _rtctimers[MAX_TIMERS];
+static rtctimers_millis_t _rtctimer_probes[PROBES];
+
+static void _rtctimers_set(void *timer, uint32_t offset_ms)
+{
+    ((rtctimers_millis_t *)timer)->callback = _nop;
+    rtctimers_millis_set(timer, offset_ms);
+}
+
+static void _rtctimers_remove(void *timer)
+{
+    rtctimers_millis_remove(timer);
+}
+#endif
+
+static const set_remove_api_t _apis[] = {
+    { "xtimer", _xtimers, _xtimer_probes, sizeof(xtimer_t),
+      _xtimers_set, _xtimers_remove },
+#ifdef MODULE_RTCTIMERS_MILLIS
+    { "rtctimers-millis", _rtctimers, _rtctimer_probes, sizeof(rtctimers_millis_t),
+      _rtctimers_set, _rtctimers_remove },
+#endif
+};
+
+static inline void *_timer(void *timers, size_t size, unsigned i)
+{
+    return (uint8_t *)timers + i * size;
+}
+
+static void _measure(const set_remove_api_t *api, unsigned count)
+{
+    uint32_t set = 0;
+    uint32_t remove = 0;
+
+    for (unsigned i = 0; i < count; i++) {
+        api->set(_timer(api->timers, api->size, i),
+                 random_uint32_range(OFFSET_MIN_MS, OFFSET_MAX_MS));
+    }
+
+    for (unsigned round = 0; round < ROUNDS; round++) {
+        for (unsigned i = 0; i < PROBES; i++) {
+            _offsets[i] = random_uint32_range(OFFSET_MIN_MS, OFFSET_MAX_MS);
+        }
+
+        uint32_t start = xtimer_now_usec();
+        for (unsigned i = 0; i < PROBES; i++) {
+            api->set(_timer(api->probes, api->size, i), _offsets[i]);
+        }
+        uint32_t middle = xtimer_now_usec();
+        for (unsigned i = 0; i < PROBES; i++) {
+            api->remove(_timer(api->probes, api->size, i));
+        }
+        uint32_t end = xtimer_now_usec();
+
+        set += middle - start;
+        remove += end - middle;
+    }
+
+    for (unsigned i = 0; i < count; i++) {
+        api->remove(_timer(api->timers, api->size, i));
+    }
+
+    /* average per call in nanoseconds */
+    printf("{ \"api\" : \"%s\", \"timers\" : %u, \"set\" : %" PRIu32 ", \"remove\" : %" PRIu32 " }\n",
+           api->name, count,
+           (uint32_t)(((uint64_t)set * NS_PER_US) / (PROBES * ROUNDS)),
+           (uint32_t)(((uint64_t)remove * NS_PER_US) / (PROBES * ROUNDS)));
+}
+
+void set_remove_run(void)
+{
+#if defined(MODULE_XTIMER_WHEEL) || defined(MODULE_RTCTIMERS_MILLIS_WHEEL)
+    puts("\nSet/remove benchmark, timing wheel");
+#else
+    puts("\nSet/remove benchmark, sorted lists");
+#endif
+
+#ifdef MODULE_RTCTIMERS_MILLIS
+    rtctimers_millis_init();
+#endif
+
+    for (unsigned k = 0; k < sizeof(_apis) / sizeof(_apis[0]); k++) {
+        for (unsigned count = 10; count < MAX_TIMERS; count *= 10) {
+            _measure(&_apis[k], count);
+        }
+        _measure(&_apis[k], MAX_TIMERS);
+    }
+
+    puts("[SUCCESS]");
+}
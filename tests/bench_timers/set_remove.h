@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Set/remove cost benchmark declarations
+ *
+ * @author      Oleg Artamonov
+ */
+
+#ifndef SET_REMOVE_H
+#define SET_REMOVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Largest number of timers armed during the measurement
+ */
+#ifndef MAX_TIMERS
+#define MAX_TIMERS          (1000)
+#endif
+
+/**
+ * @brief   Measures the cost of setting and removing a timer while many others are armed
+ *
+ * Runs with 10, 100 and so on up to MAX_TIMERS timers armed, for xtimer and,
+ * if the module is used, for rtctimers-millis. Prints one result line per run.
+ */
+void set_remove_run(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SET_REMOVE_H */
+/** @} */
@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+# Checks the set/remove benchmark, build with TEST_SET_REMOVE=1
+
+import os
+import sys
+
+MAX_TIMERS = int(os.environ.get('MAX_TIMERS', 1000))
+
+
+def timer_counts():
+    count = 10
+    while count < MAX_TIMERS:
+        yield count
+        count *= 10
+    yield MAX_TIMERS
+
+
+def result(api, timers):
+    return (r"{ \"api\" : \"%s\", \"timers\" : %d, "
+            r"\"set\" : (\d+), \"remove\" : (\d+) }" % (api, timers))
+
+
+def testfunc(child):
+    child.expect(r"Set/remove benchmark, (timing wheel|sorted lists)")
+    for timers in timer_counts():
+        child.expect(result("xtimer", timers), timeout=60)
+
+    # rtctimers-millis is measured on the boards having it only
+    counts = list(timer_counts())
+    if child.expect([result("rtctimers-millis", counts[0]), r"\[SUCCESS\]"],
+                    timeout=60) == 0:
+        for timers in counts[1:]:
+            child.expect(result("rtctimers-millis", timers), timeout=60)
+        child.expect_exact("[SUCCESS]")
+
+
+if __name__ == "__main__":
+    sys.path.append(os.path.join(os.environ['RIOTTOOLS'], 'testrunner'))
+    from testrunner import run
+    sys.exit(run(testfunc))
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Test application for the priority inheritance mutexes
+ *
+ * @author      Oleg Artamonov
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "mutex_pi.h"
+#include "rmutex_pi.h"
+#include "thread.h"
+
+#define PRIO_LOW        (THREAD_PRIORITY_MAIN - 1)
+#define PRIO_MID        (THREAD_PRIORITY_MAIN - 2)
+#define PRIO_HIGH       (THREAD_PRIORITY_MAIN - 3)
+
+#define RMUTEX_DEPTH    (3U)
+
+static char stack_low[THREAD_STACKSIZE_DEFAULT];
+static char stack_mid[THREAD_STACKSIZE_DEFAULT];
+static char stack_high[THREAD_STACKSIZE_DEFAULT];
+
+static mutex_pi_t mutex_a = MUTEX_PI_INIT;
+static mutex_pi_t mutex_b = MUTEX_PI_INIT;
+static rmutex_pi_t rmutex = RMUTEX_PI_INIT;
+
+static kernel_pid_t pid_low;
+static kernel_pid_t pid_mid;
+static kernel_pid_t pid_high;
+
+static unsigned failures = 0;
+
+static void check(const char *what, kernel_pid_t pid, int expected)
+{
+    int prio = thread_get(pid)->priority;
+
+    printf("%s: prio %i, expected %i%s\n", what, prio, expected,
+           (prio == expected) ? "" : " - MISMATCH");
+    if (prio != expected) {
+        failures++;
+    }
+}
+
+/* Chain: t_high waits for B held by t_mid, t_mid waits for A held by t_low */
+
+static void *chain_low(void *arg)
+{
+    (void)arg;
+
+    mutex_pi_lock(&mutex_a);
+    /* main wakes us up when the chain is built */
+    thread_sleep();
+
+    check("t_low holding A", pid_low, PRIO_HIGH);
+    mutex_pi_unlock(&mutex_a);
+    check("t_low released A", pid_low, PRIO_LOW);
+
+    return NULL;
+}
+
+static void *chain_mid(void *arg)
+{
+    (void)arg;
+
+    mutex_pi_lock(&mutex_b);
+    mutex_pi_lock(&mutex_a);
+
+    check("t_mid got A", pid_mid, PRIO_HIGH);
+    mutex_pi_unlock(&mutex_a);
+    /* t_high still waits for B */
+    check("t_mid released A", pid_mid, PRIO_HIGH);
+    mutex_pi_unlock(&mutex_b);
+    check("t_mid released B", pid_mid, PRIO_MID);
+
+    return NULL;
+}
+
+static void *chain_high(void *arg)
+{
+    (void)arg;
+
+    mutex_pi_lock(&mutex_b);
+    check("t_high got B", pid_high, PRIO_HIGH);
+    mutex_pi_unlock(&mutex_b);
+
+    return NULL;
+}
+
+static void test_chain(void)
+{
+    puts("\nTwo mutex chain");
+
+    pid_low = thread_create(stack_low, sizeof(stack_low), PRIO_LOW,
+                            THREAD_CREATE_STACKTEST, chain_low, NULL, "t_low");
+    check("t_low", pid_low, PRIO_LOW);
+
+    pid_mid = thread_create(stack_mid, sizeof(stack_mid), PRIO_MID,
+                            THREAD_CREATE_STACKTEST, chain_mid, NULL, "t_mid");
+    check("t_low, t_mid waits for A", pid_low, PRIO_MID);
+    check("t_mid, holds B", pid_mid, PRIO_MID);
+
+    pid_high = thread_create(stack_high, sizeof(stack_high), PRIO_HIGH,
+                             THREAD_CREATE_STACKTEST, chain_high, NULL, "t_high");
+    check("t_low, t_high waits for B", pid_low, PRIO_HIGH);
+    check("t_mid, t_high waits for B", pid_mid, PRIO_HIGH);
+
+    /* Unwinds the chain, all threads finish before main runs again */
+    thread_wakeup(pid_low);
+
+    if (mutex_a.owner != KERNEL_PID_UNDEF || mutex_b.owner != KERNEL_PID_UNDEF) {
+        puts("mutexes left locked - MISMATCH");
+        failures++;
+    }
+}
+
+static void *recursive_low(void *arg)
+{
+    (void)arg;
+
+    for (unsigned i = 0; i < RMUTEX_DEPTH; i++) {
+        rmutex_pi_lock(&rmutex);
+    }
+    thread_sleep();
+
+    for (unsigned i = RMUTEX_DEPTH; i > 1; i--) {
+        rmutex_pi_unlock(&rmutex);
+        /* Still held, t_high still waits */
+        check("t_low unlocked once", pid_low, PRIO_HIGH);
+    }
+
+    rmutex_pi_unlock(&rmutex);
+    check("t_low released", pid_low, PRIO_LOW);
+
+    return NULL;
+}
+
+static void *recursive_high(void *arg)
+{
+    (void)arg;
+
+    rmutex_pi_lock(&rmutex);
+    check("t_high got rmutex", pid_high, PRIO_HIGH);
+
+    if (!rmutex_pi_trylock(&rmutex) || rmutex.refcount != 2) {
+        puts("t_high: recursive trylock failed - MISMATCH");
+        failures++;
+    }
+
+    rmutex_pi_unlock(&rmutex);
+    rmutex_pi_unlock(&rmutex);
+
+    return NULL;
+}
+
+static void test_recursive(void)
+{
+    puts("\nRecursive mutex");
+
+    pid_low = thread_create(stack_low, sizeof(stack_low), PRIO_LOW,
+                            THREAD_CREATE_STACKTEST, recursive_low, NULL, "t_low");
+    if (rmutex_pi_trylock(&rmutex)) {
+        puts("main: locked rmutex held by t_low - MISMATCH");
+        failures++;
+    }
+    check("t_low", pid_low, PRIO_LOW);
+
+    pid_high = thread_create(stack_high, sizeof(stack_high), PRIO_HIGH,
+                             THREAD_CREATE_STACKTEST, recursive_high, NULL, "t_high");
+    check("t_low, t_high waits", pid_low, PRIO_HIGH);
+
+    thread_wakeup(pid_low);
+
+    if (rmutex.mutex.owner != KERNEL_PID_UNDEF || rmutex.refcount != 0) {
+        puts("rmutex left locked - MISMATCH");
+        failures++;
+    }
+}
+
+int main(void)
+{
+    puts("Priority inheritance mutex test");
+    puts("Please refer to the README.md for more information");
+
+    test_chain();
+    test_recursive();
+
+    if (failures) {
+        printf("\n[FAILED] %u checks\n", failures);
+    }
+    else {
+        puts("\n[SUCCESS]");
+    }
+
+    return 0;
+}
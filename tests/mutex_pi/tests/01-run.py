@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+CHAIN = [
+    "t_low",
+    "t_low, t_mid waits for A",
+    "t_mid, holds B",
+    "t_low, t_high waits for B",
+    "t_mid, t_high waits for B",
+    "t_low holding A",
+    "t_mid got A",
+    "t_mid released A",
+    "t_high got B",
+    "t_mid released B",
+    "t_low released A",
+]
+
+RECURSIVE = [
+    "t_low",
+    "t_low, t_high waits",
+    "t_low unlocked once",
+    "t_low unlocked once",
+    "t_high got rmutex",
+    "t_low released",
+]
+
+
+def expect_checks(child, checks):
+    for what in checks:
+        child.expect(r"%s: prio (\d+), expected (\d+)\r\n" % what)
+        assert child.match.group(1) == child.match.group(2), what
+
+
+def testfunc(child):
+    child.expect_exact("Two mutex chain")
+    expect_checks(child, CHAIN)
+    child.expect_exact("Recursive mutex")
+    expect_checks(child, RECURSIVE)
+    child.expect_exact("[SUCCESS]")
+
+
+if __name__ == "__main__":
+    sys.path.append(os.path.join(os.environ['RIOTTOOLS'], 'testrunner'))
+    from testrunner import run
+    sys.exit(run(testfunc))
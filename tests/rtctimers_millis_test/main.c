@@ -19,6 +19,8 @@
  */
 
 #include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
 
 #include "periph/pm.h"
 #include "pm_layered.h"
@@ -56,6 +58,79 @@ static void *timer1_thread(void *arg) {
     }
     return NULL;
 }
+
+/* Fire times of the batching test timers, ms from the start */
+#define BATCH_TIMERS 3
+#define BATCH_TOLERANCE RTCTIMERS_MILLIS_ISR_BACKOFF
+static rtctimers_millis_t batch_timers[BATCH_TIMERS];
+static volatile uint32_t batch_fired[BATCH_TIMERS];
+static uint32_t batch_start;
+
+static void batch_cb(void *arg) {
+    batch_fired[(uintptr_t)arg] = xtimer_now_usec()/1000 - batch_start;
+}
+
+static void batch_set(unsigned n, uint32_t offset, uint32_t slack) {
+    batch_timers[n].callback = batch_cb;
+    batch_timers[n].arg = (void *)(uintptr_t)n;
+    batch_fired[n] = UINT32_MAX;
+    rtctimers_millis_set_slack(&batch_timers[n], offset, slack);
+}
+
+static bool batch_check(const char *what, unsigned n, uint32_t expected) {
+    printf("%s: fired at %" PRIu32 " ms, expected %" PRIu32 " ms\n", what, batch_fired[n], expected);
+    return (batch_fired[n] + BATCH_TOLERANCE >= expected) && (batch_fired[n] <= expected + BATCH_TOLERANCE);
+}
+
+static bool batch_saved(uint32_t saved, uint32_t expected) {
+    uint32_t now_saved = rtctimers_millis_wakeups_saved();
+    printf("wakeups saved: %" PRIu32 ", expected %" PRIu32 "\n", now_saved - saved, expected);
+    return (now_saved - saved) == expected;
+}
+
+/**
+ * Timers with slack are fired along with the ones waking the MCU up
+ * whenever their window is open, both right behind them and further down
+ * the queue, and never before the window opens.
+ */
+static bool batch_test(void) {
+    bool ok = true;
+    uint32_t saved = rtctimers_millis_wakeups_saved();
+
+    puts("Batching next timer");
+    batch_start = xtimer_now_usec()/1000;
+    batch_set(0, 100, 0);
+    batch_set(1, 80, 100);
+    xtimer_usleep(300 * US_PER_MS);
+    ok &= batch_check("exact", 0, 100);
+    ok &= batch_check("batched", 1, 100);
+    ok &= batch_saved(saved, 1);
+
+    puts("Batching past a closed window");
+    saved = rtctimers_millis_wakeups_saved();
+    batch_start = xtimer_now_usec()/1000;
+    batch_set(0, 100, 0);
+    batch_set(1, 50, 200);
+    batch_set(2, 150, 0);
+    xtimer_usleep(400 * US_PER_MS);
+    ok &= batch_check("exact", 0, 100);
+    ok &= batch_check("batched", 1, 100);
+    ok &= batch_check("closed", 2, 150);
+    ok &= batch_saved(saved, 1);
+
+    puts("Window not open yet");
+    saved = rtctimers_millis_wakeups_saved();
+    batch_start = xtimer_now_usec()/1000;
+    batch_set(0, 100, 0);
+    batch_set(1, 150, 50);
+    xtimer_usleep(300 * US_PER_MS);
+    ok &= batch_check("exact", 0, 100);
+    ok &= batch_check("own wakeup", 1, 200);
+    ok &= batch_saved(saved, 0);
+
+    return ok;
+}
+
 /*
 static msg_t timer2_msg;
 static kernel_pid_t timer2_pid;
@@ -91,6 +166,8 @@ int main(void)
 	rtctimers_millis_init();
 	xtimer_init();
     
+    puts(batch_test() ? "[SUCCESS]" : "[FAILED]");
+
     uint32_t now = xtimer_now_usec()/1000;
     
     timer1_prev = now;
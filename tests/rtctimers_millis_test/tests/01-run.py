@@ -0,0 +1,38 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+TOLERANCE = 4
+
+CASES = [
+    ("Batching next timer", ["exact", "batched"], 1),
+    ("Batching past a closed window", ["exact", "batched", "closed"], 1),
+    ("Window not open yet", ["exact", "own wakeup"], 0),
+]
+
+
+def testfunc(child):
+    child.expect_exact("rtctimers-millis test")
+    for case, timers, saved in CASES:
+        child.expect_exact(case)
+        for what in timers:
+            child.expect(r"%s: fired at (\d+) ms, expected (\d+) ms\r\n" % what)
+            fired, expected = (int(x) for x in child.match.groups())
+            assert abs(fired - expected) <= TOLERANCE, what
+        child.expect(r"wakeups saved: (\d+), expected (\d+)\r\n")
+        assert int(child.match.group(1)) == saved, case
+    child.expect_exact("[SUCCESS]")
+    child.expect(r"Timer1: (\d+) ms\r\n")
+
+
+if __name__ == "__main__":
+    sys.path.append(os.path.join(os.environ['RIOTTOOLS'], 'testrunner'))
+    from testrunner import run
+    sys.exit(run(testfunc))
@@ -217,7 +217,9 @@ static void test_pktbuf_add__success(void)
         TEST_ASSERT_EQUAL_INT(1, pkt->users);
 
         if (pkt_prev != NULL) {
+#ifndef MODULE_GNRC_PKTBUF_SEG  /* snips are cached by size class from the top of the buffer */
             TEST_ASSERT(pkt_prev < pkt);
+#endif
             TEST_ASSERT(pkt_prev->data < pkt->data);
         }
 
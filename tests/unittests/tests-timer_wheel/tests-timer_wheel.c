@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "embUnit.h"
+
+#include "timer_wheel.h"
+
+#include "tests-timer_wheel.h"
+
+#define TIMERS_NUMOF    (64U)
+
+typedef struct {
+    list_node_t node;
+    uint64_t key;
+} test_timer_t;
+
+static timer_wheel_t wheel;
+static test_timer_t timers[TIMERS_NUMOF];
+
+static uint64_t _key(const list_node_t *timer)
+{
+    return ((const test_timer_t *)timer)->key;
+}
+
+static void set_up(void)
+{
+    memset(timers, 0, sizeof(timers));
+    timer_wheel_init(&wheel, _key);
+}
+
+static void _add(unsigned i, uint64_t key)
+{
+    timers[i].key = key;
+    timer_wheel_add(&wheel, &timers[i].node);
+}
+
+/* Takes the earliest timer out, TIMERS_NUMOF if the wheel is empty */
+static unsigned _pop(void)
+{
+    list_node_t *first = timer_wheel_first(&wheel);
+
+    if (!first) {
+        return TIMERS_NUMOF;
+    }
+
+    timer_wheel_remove(&wheel, first);
+    return (test_timer_t *)first - timers;
+}
+
+static void test_timer_wheel_empty(void)
+{
+    TEST_ASSERT_NULL(timer_wheel_first(&wheel));
+    TEST_ASSERT_EQUAL_INT(0, timer_wheel_remove(&wheel, &timers[0].node));
+}
+
+static void test_timer_wheel_order(void)
+{
+    /* every level and a few slots of the same level */
+    static const uint64_t keys[] = {
+        0x80000000, 0x3, 0x120, 0xFFFFFFFF, 0x10000, 0x1,
+        0x7, 0x125, 0x2000000, 0x11, 0x10001, 0x1000, 0x0,
+    };
+    const unsigned num = sizeof(keys) / sizeof(keys[0]);
+
+    for (unsigned i = 0; i < num; i++) {
+        _add(i, keys[i]);
+    }
+
+    uint64_t last = 0;
+    for (unsigned i = 0; i < num; i++) {
+        unsigned n = _pop();
+        TEST_ASSERT(n < num);
+        TEST_ASSERT(timers[n].key >= last);
+        last = timers[n].key;
+    }
+
+    TEST_ASSERT_EQUAL_INT(TIMERS_NUMOF, _pop());
+}
+
+static void test_timer_wheel_order__same_key(void)
+{
+    _add(0, 0x500);
+    _add(1, 0x500);
+    _add(2, 0x100);
+    _add(3, 0x500);
+
+    /* timers of the same key come in the order they were added */
+    TEST_ASSERT_EQUAL_INT(2, _pop());
+    TEST_ASSERT_EQUAL_INT(0, _pop());
+    TEST_ASSERT_EQUAL_INT(1, _pop());
+    TEST_ASSERT_EQUAL_INT(3, _pop());
+}
+
+static void test_timer_wheel_late_keys(void)
+{
+    _add(0, 0x1000);
+    _add(1, 0x5000);
+
+    /* cursor advances to the earliest timer */
+    TEST_ASSERT_EQUAL_INT(0, _pop());
+
+    /* keys earlier than the ones already returned */
+    _add(2, 0x800);
+    _add(3, 0x10);
+    _add(4, 0x1000);
+
+    TEST_ASSERT_EQUAL_INT(3, _pop());
+    TEST_ASSERT_EQUAL_INT(2, _pop());
+    TEST_ASSERT_EQUAL_INT(4, _pop());
+    TEST_ASSERT_EQUAL_INT(1, _pop());
+
+    /* late timer becomes the earliest one when the first is already known */
+    _add(5, 0x6000);
+    TEST_ASSERT(timer_wheel_first(&wheel) == &timers[5].node);
+    _add(6, 0x20);
+    TEST_ASSERT(timer_wheel_first(&wheel) == &timers[6].node);
+
+    /* and is removed from where it was put */
+    TEST_ASSERT_EQUAL_INT(1, timer_wheel_remove(&wheel, &timers[6].node));
+    TEST_ASSERT_EQUAL_INT(5, _pop());
+    TEST_ASSERT_EQUAL_INT(TIMERS_NUMOF, _pop());
+}
+
+static void test_timer_wheel_far(void)
+{
+    const uint64_t period = 0x100000000ULL;
+
+    _add(0, 3 * period + 5);
+    _add(1, period + 0x10);
+    _add(2, 0x20);
+    _add(3, period + 0x8);
+    _add(4, 2 * period);
+
+    /* far timer removed before the wheel gets to its period */
+    TEST_ASSERT_EQUAL_INT(1, timer_wheel_remove(&wheel, &timers[4].node));
+    TEST_ASSERT_EQUAL_INT(0, timer_wheel_remove(&wheel, &timers[4].node));
+
+    TEST_ASSERT_EQUAL_INT(2, _pop());
+    TEST_ASSERT_EQUAL_INT(3, _pop());
+
+    /* near timer added to the new period */
+    _add(5, period + 0x9);
+    TEST_ASSERT_EQUAL_INT(5, _pop());
+    TEST_ASSERT_EQUAL_INT(1, _pop());
+    TEST_ASSERT_EQUAL_INT(0, _pop());
+    TEST_ASSERT_EQUAL_INT(TIMERS_NUMOF, _pop());
+}
+
+static void test_timer_wheel_remove(void)
+{
+    _add(0, 0x100);
+    _add(1, 0x100);
+    _add(2, 0x12345);
+
+    /* never added timers of the same keys */
+    timers[3].key = 0x100;
+    timers[4].key = 0x12345;
+    timers[5].key = 0x7FFFFFFFFULL;
+    TEST_ASSERT_EQUAL_INT(0, timer_wheel_remove(&wheel, &timers[3].node));
+    TEST_ASSERT_EQUAL_INT(0, timer_wheel_remove(&wheel, &timers[4].node));
+    TEST_ASSERT_EQUAL_INT(0, timer_wheel_remove(&wheel, &timers[5].node));
+
+    /* removing the earliest one */
+    TEST_ASSERT(timer_wheel_first(&wheel) == &timers[0].node);
+    TEST_ASSERT_EQUAL_INT(1, timer_wheel_remove(&wheel, &timers[0].node));
+    TEST_ASSERT_EQUAL_INT(0, timer_wheel_remove(&wheel, &timers[0].node));
+
+    TEST_ASSERT_EQUAL_INT(1, _pop());
+    TEST_ASSERT_EQUAL_INT(1, timer_wheel_remove(&wheel, &timers[2].node));
+    TEST_ASSERT_NULL(timer_wheel_first(&wheel));
+}
+
+static void test_timer_wheel_random(void)
+{
+    /* deterministic LCG, keys around the current time like a timer core sets them */
+    uint32_t seed = 12345;
+    uint64_t now = 0xFFFF0000ULL;
+    uint8_t armed[TIMERS_NUMOF] = { 0 };
+
+    for (unsigned step = 0; step < 2000; step++) {
+        seed = seed * 1103515245 + 12345;
+        unsigned i = (seed >> 16) % TIMERS_NUMOF;
+
+        if (armed[i]) {
+            TEST_ASSERT_EQUAL_INT(1, timer_wheel_remove(&wheel, &timers[i].node));
+            armed[i] = 0;
+        }
+        else {
+            seed = seed * 1103515245 + 12345;
+            /* mostly near, a few late and a few far ones */
+            uint64_t offset = (seed >> 8) & ((step & 7) ? 0xFFFF : 0x1FFFFFFFF);
+            _add(i, ((step % 13) == 0) ? now - (offset & 0xFFFF) : now + offset);
+            armed[i] = 1;
+        }
+
+        if (step & 1) {
+            continue;
+        }
+
+        /* earliest one is the minimum of the armed timers */
+        unsigned min = TIMERS_NUMOF;
+        for (unsigned k = 0; k < TIMERS_NUMOF; k++) {
+            if (armed[k] && ((min == TIMERS_NUMOF) || (timers[k].key < timers[min].key))) {
+                min = k;
+            }
+        }
+
+        list_node_t *first = timer_wheel_first(&wheel);
+        if (min == TIMERS_NUMOF) {
+            TEST_ASSERT_NULL(first);
+            continue;
+        }
+
+        TEST_ASSERT_NOT_NULL(first);
+        TEST_ASSERT(timers[min].key == _key(first));
+
+        /* expire it, time moves on */
+        TEST_ASSERT_EQUAL_INT(1, timer_wheel_remove(&wheel, first));
+        armed[(test_timer_t *)first - timers] = 0;
+        if (_key(first) > now) {
+            now = _key(first);
+        }
+    }
+}
+
+Test *tests_timer_wheel_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_timer_wheel_empty),
+        new_TestFixture(test_timer_wheel_order),
+        new_TestFixture(test_timer_wheel_order__same_key),
+        new_TestFixture(test_timer_wheel_late_keys),
+        new_TestFixture(test_timer_wheel_far),
+        new_TestFixture(test_timer_wheel_remove),
+        new_TestFixture(test_timer_wheel_random),
+    };
+
+    EMB_UNIT_TESTCALLER(timer_wheel_tests, set_up, NULL, fixtures);
+
+    return (Test *)&timer_wheel_tests;
+}
+
+void tests_timer_wheel(void)
+{
+    TESTS_RUN(tests_timer_wheel_tests());
+}
+/** @} */
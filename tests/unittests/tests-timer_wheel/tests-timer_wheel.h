@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file
+ * @brief       Unittests for the ``timer_wheel`` module
+ */
+#ifndef TESTS_TIMER_WHEEL_H
+#define TESTS_TIMER_WHEEL_H
+
+#include "embUnit/embUnit.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_timer_wheel(void);
+
+/**
+ * @brief   Generates tests for timer_wheel
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_timer_wheel_tests(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TESTS_TIMER_WHEEL_H */
+/** @} */
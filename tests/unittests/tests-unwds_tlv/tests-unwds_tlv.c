@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "embUnit.h"
+
+#include "unwds-tlv.h"
+
+#include "tests-unwds_tlv.h"
+
+#define FIELDS  (3)
+
+static unwds_tlv_stream_t enc, dec;
+static uint8_t buf[UNWDS_TLV_MAX_SIZE(UNWDS_TLV_MAX_FIELDS)];
+
+static void set_up(void)
+{
+    unwds_tlv_init(&enc, FIELDS);
+    unwds_tlv_init(&dec, FIELDS);
+}
+
+/* Encodes the reading into buf and checks the decoder gets it back */
+static void round_trip(const int32_t *values, size_t *len)
+{
+    int32_t out[FIELDS];
+
+    *len = unwds_tlv_encode(&enc, values, buf, sizeof(buf));
+    TEST_ASSERT(*len > 0);
+    TEST_ASSERT(*len <= UNWDS_TLV_MAX_SIZE(FIELDS));
+
+    TEST_ASSERT_EQUAL_INT(*len, unwds_tlv_decode(&dec, buf, *len, out));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(values, out, sizeof(out)));
+}
+
+static void test_unwds_tlv_varint__limits(void)
+{
+    uint32_t value;
+
+    TEST_ASSERT_EQUAL_INT(1, unwds_tlv_put_varint(buf, sizeof(buf), 0));
+    TEST_ASSERT_EQUAL_INT(1, unwds_tlv_get_varint(buf, 1, &value));
+    TEST_ASSERT_EQUAL_INT(0, value);
+
+    TEST_ASSERT_EQUAL_INT(1, unwds_tlv_put_varint(buf, sizeof(buf), 0x7F));
+    TEST_ASSERT_EQUAL_INT(2, unwds_tlv_put_varint(buf, sizeof(buf), 0x80));
+
+    TEST_ASSERT_EQUAL_INT(5, unwds_tlv_put_varint(buf, sizeof(buf), UINT32_MAX));
+    TEST_ASSERT_EQUAL_INT(5, unwds_tlv_get_varint(buf, 5, &value));
+    TEST_ASSERT(value == UINT32_MAX);
+}
+
+static void test_unwds_tlv_varint__truncated(void)
+{
+    uint32_t value;
+
+    /* Doesn't fit */
+    TEST_ASSERT_EQUAL_INT(0, unwds_tlv_put_varint(buf, 4, UINT32_MAX));
+    TEST_ASSERT_EQUAL_INT(0, unwds_tlv_put_varint(buf, 0, 0));
+
+    /* Continuation bit set on the last byte */
+    TEST_ASSERT_EQUAL_INT(5, unwds_tlv_put_varint(buf, sizeof(buf), UINT32_MAX));
+    TEST_ASSERT_EQUAL_INT(0, unwds_tlv_get_varint(buf, 4, &value));
+
+    /* Longer than 32 bits */
+    memset(buf, 0x80, 5);
+    buf[5] = 0x01;
+    TEST_ASSERT_EQUAL_INT(0, unwds_tlv_get_varint(buf, 6, &value));
+}
+
+static void test_unwds_tlv_zigzag(void)
+{
+    TEST_ASSERT(unwds_tlv_zigzag(0) == 0);
+    TEST_ASSERT(unwds_tlv_zigzag(-1) == 1);
+    TEST_ASSERT(unwds_tlv_zigzag(1) == 2);
+    TEST_ASSERT(unwds_tlv_zigzag(INT32_MAX) == UINT32_MAX - 1);
+    TEST_ASSERT(unwds_tlv_zigzag(INT32_MIN) == UINT32_MAX);
+
+    TEST_ASSERT(unwds_tlv_unzigzag(unwds_tlv_zigzag(INT32_MIN)) == INT32_MIN);
+    TEST_ASSERT(unwds_tlv_unzigzag(unwds_tlv_zigzag(INT32_MAX)) == INT32_MAX);
+    TEST_ASSERT(unwds_tlv_unzigzag(unwds_tlv_zigzag(-12345)) == -12345);
+}
+
+static void test_unwds_tlv_round_trip(void)
+{
+    int32_t values[FIELDS] = { 215, 48, 1013 };
+    size_t len;
+
+    /* Key reading goes first */
+    round_trip(values, &len);
+    TEST_ASSERT(buf[0] & UNWDS_TLV_KEY_FLAG);
+
+    /* Small changes of the single field */
+    values[0]++;
+    round_trip(values, &len);
+    TEST_ASSERT_EQUAL_INT(3, len);
+    TEST_ASSERT(!(buf[0] & UNWDS_TLV_KEY_FLAG));
+
+    /* Nothing has changed, header and empty bitmap only */
+    round_trip(values, &len);
+    TEST_ASSERT_EQUAL_INT(2, len);
+
+    for (unsigned i = 0; i < 2 * UNWDS_TLV_KEY_INTERVAL; i++) {
+        values[i % FIELDS] -= i * 7;
+        round_trip(values, &len);
+    }
+}
+
+static void test_unwds_tlv_round_trip__key_interval(void)
+{
+    int32_t values[FIELDS] = { 1, 2, 3 };
+    size_t len;
+
+    for (unsigned i = 0; i < 2 * UNWDS_TLV_KEY_INTERVAL + 1; i++) {
+        round_trip(values, &len);
+
+        bool key = (buf[0] & UNWDS_TLV_KEY_FLAG) != 0;
+        TEST_ASSERT(key == ((i % UNWDS_TLV_KEY_INTERVAL) == 0));
+        TEST_ASSERT_EQUAL_INT(i & UNWDS_TLV_SEQ_MASK, buf[0] & UNWDS_TLV_SEQ_MASK);
+    }
+}
+
+static void test_unwds_tlv_round_trip__extreme_values(void)
+{
+    int32_t values[][FIELDS] = {
+        { INT32_MIN, INT32_MAX, 0 },
+        { INT32_MAX, INT32_MIN, -1 },
+        { 0, 0, INT32_MIN },
+        { -1, 1, INT32_MAX },
+        { INT32_MIN, INT32_MIN, INT32_MIN },
+    };
+    size_t len;
+
+    for (unsigned i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        round_trip(values[i], &len);
+    }
+
+    /* Zeros are skipped in the key reading */
+    int32_t zeros[FIELDS] = { 0 };
+    unwds_tlv_reset(&enc);
+    round_trip(zeros, &len);
+    TEST_ASSERT_EQUAL_INT(2, len);
+}
+
+static void test_unwds_tlv_decode__lost_reading(void)
+{
+    int32_t values[FIELDS] = { 100, -100, 0 };
+    int32_t out[FIELDS];
+    size_t len;
+
+    round_trip(values, &len);
+
+    /* Reading is lost on the way */
+    values[0] += 5;
+    TEST_ASSERT(unwds_tlv_encode(&enc, values, buf, sizeof(buf)) > 0);
+
+    /* Differences from it can't be decoded until the next key reading */
+    for (unsigned i = 2; i < UNWDS_TLV_KEY_INTERVAL; i++) {
+        values[1] += 3;
+        len = unwds_tlv_encode(&enc, values, buf, sizeof(buf));
+        TEST_ASSERT(len > 0);
+        TEST_ASSERT_EQUAL_INT(0, unwds_tlv_decode(&dec, buf, len, out));
+    }
+
+    values[2] = 42;
+    round_trip(values, &len);
+    TEST_ASSERT(buf[0] & UNWDS_TLV_KEY_FLAG);
+
+    values[2]--;
+    round_trip(values, &len);
+}
+
+static void test_unwds_tlv_encode__uplink_lost(void)
+{
+    int32_t values[FIELDS] = { 7, 8, 9 };
+    int32_t out[FIELDS];
+    size_t len;
+
+    round_trip(values, &len);
+
+    /* Reading is encoded, but never sent */
+    values[1] = 80;
+    TEST_ASSERT(unwds_tlv_encode(&enc, values, buf, sizeof(buf)) > 0);
+    TEST_ASSERT(!(buf[0] & UNWDS_TLV_KEY_FLAG));
+    unwds_tlv_uplink_lost();
+
+    /* Next one is the key reading, decoder catches up at once */
+    values[2] = 90;
+    len = unwds_tlv_encode(&enc, values, buf, sizeof(buf));
+    TEST_ASSERT(buf[0] & UNWDS_TLV_KEY_FLAG);
+    TEST_ASSERT_EQUAL_INT(len, unwds_tlv_decode(&dec, buf, len, out));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(values, out, sizeof(out)));
+
+    /* Key interval starts over */
+    values[0]++;
+    round_trip(values, &len);
+    TEST_ASSERT(!(buf[0] & UNWDS_TLV_KEY_FLAG));
+}
+
+static void test_unwds_tlv_encode__no_room(void)
+{
+    int32_t values[FIELDS] = { INT32_MIN, INT32_MAX, 1 };
+    size_t len;
+
+    /* Stream state is kept, key reading is still due */
+    TEST_ASSERT_EQUAL_INT(0, unwds_tlv_encode(&enc, values, buf, 4));
+    TEST_ASSERT_EQUAL_INT(0, unwds_tlv_encode(&enc, values, buf, 0));
+
+    round_trip(values, &len);
+    TEST_ASSERT_EQUAL_INT(UNWDS_TLV_KEY_FLAG, buf[0]);
+}
+
+static void test_unwds_tlv_decode__malformed(void)
+{
+    int32_t values[FIELDS] = { 1, 2, 3 };
+    int32_t out[FIELDS];
+    uint8_t key[UNWDS_TLV_MAX_SIZE(FIELDS)];
+
+    size_t len = unwds_tlv_encode(&enc, values, key, sizeof(key));
+    TEST_ASSERT(len > 0);
+
+    TEST_ASSERT_EQUAL_INT(0, unwds_tlv_decode(&dec, key, 0, out));
+
+    /* Value is cut off */
+    TEST_ASSERT_EQUAL_INT(0, unwds_tlv_decode(&dec, key, len - 1, out));
+
+    /* Field beyond the stream's ones */
+    buf[0] = UNWDS_TLV_KEY_FLAG;
+    buf[1] = 1 << FIELDS;
+    buf[2] = 0;
+    TEST_ASSERT_EQUAL_INT(0, unwds_tlv_decode(&dec, buf, 3, out));
+
+    /* Intact reading is still decoded */
+    TEST_ASSERT_EQUAL_INT(len, unwds_tlv_decode(&dec, key, len, out));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(values, out, sizeof(out)));
+}
+
+Test *tests_unwds_tlv_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_unwds_tlv_varint__limits),
+        new_TestFixture(test_unwds_tlv_varint__truncated),
+        new_TestFixture(test_unwds_tlv_zigzag),
+        new_TestFixture(test_unwds_tlv_round_trip),
+        new_TestFixture(test_unwds_tlv_round_trip__key_interval),
+        new_TestFixture(test_unwds_tlv_round_trip__extreme_values),
+        new_TestFixture(test_unwds_tlv_decode__lost_reading),
+        new_TestFixture(test_unwds_tlv_encode__uplink_lost),
+        new_TestFixture(test_unwds_tlv_encode__no_room),
+        new_TestFixture(test_unwds_tlv_decode__malformed),
+    };
+
+    EMB_UNIT_TESTCALLER(unwds_tlv_tests, set_up, NULL, fixtures);
+
+    return (Test *)&unwds_tlv_tests;
+}
+
+void tests_unwds_tlv(void)
+{
+    TESTS_RUN(tests_unwds_tlv_tests());
+}
+/** @} */
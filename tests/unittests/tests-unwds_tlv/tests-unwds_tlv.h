@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file
+ * @brief       Unittests for the ``unwds-tlv`` readings codec
+ */
+#ifndef TESTS_UNWDS_TLV_H
+#define TESTS_UNWDS_TLV_H
+
+#include "embUnit/embUnit.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_unwds_tlv(void);
+
+/**
+ * @brief   Generates tests for unwds-tlv
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_unwds_tlv_tests(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TESTS_UNWDS_TLV_H */
+/** @} */
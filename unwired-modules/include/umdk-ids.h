@@ -81,6 +81,8 @@ typedef enum {
     UNWDS_CUSTOMER_MODULE_ID = 100,
     /* System module 126 */
     UNWDS_CONFIG_MODULE_ID = 126,
+    /* Batched readings of several modules 127 */
+    UNWDS_BATCH_MODULE_ID = 127,
 } UNWDS_MODULE_IDS_t;
 
 #endif
@@ -35,8 +35,6 @@
 
 #define UMDK_ADC_PUBLISH_PERIOD_MIN 1
 
-#define UMDK_ADC_STACK_SIZE 1024
-
 #define UMDK_ADC_ADC_RESOLUTION ADC_RES_12BIT
 #define UMDK_ADC_CONVERT_TO_MILLIVOLTS 1
 
@@ -44,6 +42,8 @@ typedef enum {
     UMDK_ADC_DATA = 0,
 	UMDK_ADC_CMD_COMMAND = 1,
 	UMDK_ADC_CMD_POLL = 2,
+	UMDK_ADC_DATA_TLV = 3,		/**< Reading encoded with unwds-tlv */
+	UMDK_ADC_CMD_COV = 4,		/**< Change-of-value mode: sampling period [s] (2 bytes) | delta [mV] (2 bytes) */
     UMDK_ADC_FAIL = 0xFF,
 } umdk_adc_cmd_t;
 
@@ -57,19 +57,30 @@ extern "C" {
 
 #include "thread.h"
 #include "rtctimers-millis.h"
+#include "unwds-publisher.h"
+#include "unwds-tlv.h"
 
 static uwnds_cb_t *callback;
 
-static kernel_pid_t timer_pid;
+static unwds_publisher_t publisher;
 
-static msg_t timer_msg = {};
-static rtctimers_millis_t timer;
+#if UNWDS_TLV_REPLIES
+#if ADC_NUMOF > UNWDS_TLV_MAX_FIELDS
+#error "umdk-adc: too many ADC lines for the encoded reading"
+#endif
 
-static bool is_polled = false;
+/* One field per ADC line */
+static unwds_tlv_stream_t tlv;
+#endif
+
+#if ADC_NUMOF > UNWDS_PUBLISHER_COV_VALUES
+#error "umdk-adc: too many ADC lines for the change-of-value mode"
+#endif
 
 static struct {
 	uint8_t publish_period_sec;
 	uint32_t adc_lines_enabled;
+	unwds_publisher_cov_t cov;
 } adc_config;
 
 static void reset_config(void) {
@@ -78,6 +89,9 @@ static void reset_config(void) {
 	for (int i = 0; i < ADC_NUMOF; i++) {
 		adc_config.adc_lines_enabled |= (1 << i);
 	}
+
+	adc_config.cov.sample_sec = 0;
+	adc_config.cov.delta = 0;
 }
 
 static void init_config(void) {
@@ -108,12 +122,10 @@ static void init_adc(void)
     }
 }
 
-static void prepare_result(module_data_t *buf)
+static bool read_samples(uint16_t *samples)
 {
     int i;
 
-    uint16_t samples[ADC_NUMOF] = {};
-
     for (i = 0; i < ADC_NUMOF; i++) {
         if (!(adc_config.adc_lines_enabled & (1 << i))) {
             samples[i] = 0xFFFF;
@@ -147,7 +159,7 @@ static void prepare_result(module_data_t *buf)
 				break;
 			default:
 				puts("[umdk-" _UMDK_NAME_ "] Unsupported ADC resolution, aborting.");
-				return;
+				return false;
 				break; 
 		}
 		
@@ -157,6 +169,40 @@ static void prepare_result(module_data_t *buf)
 			}
 		}
 	}
+
+    return true;
+}
+
+static size_t sample_values(int32_t *values)
+{
+    uint16_t samples[ADC_NUMOF] = {};
+
+    if (!read_samples(samples)) {
+        return 0;
+    }
+
+    /* Disabled lines never change */
+    for (int i = 0; i < ADC_NUMOF; i++) {
+        values[i] = samples[i];
+    }
+
+    return ADC_NUMOF;
+}
+
+static void format_result(module_data_t *buf, const int32_t *values, size_t num)
+{
+    int i;
+
+    uint16_t samples[ADC_NUMOF] = {};
+
+    if (num != ADC_NUMOF) {
+        /* Lines weren't read */
+        return;
+    }
+
+    for (i = 0; i < ADC_NUMOF; i++) {
+        samples[i] = values[i];
+    }
 	
 	for (i = 0; i < ADC_NUMOF; i++) {
         if (samples[i] != 0xFFFF) {
@@ -172,55 +218,47 @@ static void prepare_result(module_data_t *buf)
             else {
                 puts(" ");
             }
-            
-            convert_to_be_sam((void *)&samples[i], sizeof(samples[i]));
         }
     }
 
     if (buf) {
         buf->data[0] = _UMDK_MID_;
+
+#if UNWDS_TLV_REPLIES
+        /* Disabled lines are 0xFFFF in the key readings only */
+        int32_t fields[ADC_NUMOF];
+        for (i = 0; i < ADC_NUMOF; i++) {
+            fields[i] = samples[i];
+        }
+
+        buf->data[1] = UMDK_ADC_DATA_TLV;
+        buf->length = 2 + unwds_tlv_encode(&tlv, fields, buf->data + 2, UNWDS_MAX_DATA_LEN - 2);
+#else
+        for (i = 0; i < ADC_NUMOF; i++) {
+            if (samples[i] != 0xFFFF) {
+                convert_to_be_sam((void *)&samples[i], sizeof(samples[i]));
+            }
+        }
+
         buf->data[1] = UMDK_ADC_DATA;
         memcpy(buf->data + 2, (uint8_t *) &samples, sizeof(samples));
         buf->length = sizeof(samples) + 2;
+#endif
     }
 }
 
-static void *timer_thread(void *arg)
+static void prepare_result(module_data_t *buf)
 {
-    (void)arg;
-    
-    msg_t msg;
-    msg_t msg_queue[4];
-    msg_init_queue(msg_queue, 4);
-
-    puts("[umdk-" _UMDK_NAME_ "] Periodic publisher thread started");
-
-    while (1) {
-        msg_receive(&msg);
-
-        module_data_t data = {};
-        data.as_ack = is_polled;
-        is_polled = false;
-
-        prepare_result(&data);
-
-        /* Notify the application */
-        callback(&data);
-
-        /* Restart after delay */
-        rtctimers_millis_set_msg(&timer, 60000 * adc_config.publish_period_sec, &timer_msg, timer_pid);
-    }
-
-    return NULL;
+    int32_t values[ADC_NUMOF];
+    format_result(buf, values, sample_values(values));
 }
 
 static void set_period (int period) {
     adc_config.publish_period_sec = period;
+    unwds_publisher_set_period(&publisher, 60000 * adc_config.publish_period_sec);
     save_config();
 
-    /* Don't restart timer if new period is zero */
     if (adc_config.publish_period_sec) {
-        rtctimers_millis_set_msg(&timer, 60000 * adc_config.publish_period_sec, &timer_msg, timer_pid);
         printf("[umdk-" _UMDK_NAME_ "] Period set to %d minutes\n", adc_config.publish_period_sec);
     } else {
         puts("[umdk-" _UMDK_NAME_ "] Timer stopped");
@@ -233,6 +271,7 @@ int umdk_adc_shell_cmd(int argc, char **argv) {
         puts (_UMDK_NAME_ " send - get and send results now");
         puts (_UMDK_NAME_ " period <N> - set period to N minutes");
         puts (_UMDK_NAME_ " lines <A B C D> - enable specific ADC lines");
+        puts (_UMDK_NAME_ " cov <S> <D> - sample every S seconds, send on D mV change, S = 0 to disable");
         puts (_UMDK_NAME_ " cfg - view current ADC configuration");
         puts (_UMDK_NAME_ " reset - reset settings to default");
         return 0;
@@ -245,8 +284,7 @@ int umdk_adc_shell_cmd(int argc, char **argv) {
     }
     
     if (strcmp(cmd, "send") == 0) {
-		/* Send signal to publisher thread */
-		msg_send(&timer_msg, timer_pid);
+		unwds_publisher_poll(&publisher, false);
     }
     
     if (strcmp(cmd, "period") == 0) {
@@ -259,9 +297,17 @@ int umdk_adc_shell_cmd(int argc, char **argv) {
         save_config();
     }
     
+    if (unwds_publisher_cov_shell_cmd(&publisher, argc, argv)) {
+        save_config();
+    }
+    
     if (strcmp(cmd, "cfg") == 0) {
         int i = 0;
         printf("[umdk-" _UMDK_NAME_ "] Period: %d min\n", adc_config.publish_period_sec);
+        if (adc_config.cov.sample_sec) {
+            printf("[umdk-" _UMDK_NAME_ "] Sampling every %u s, publishing on %u change\n",
+                   adc_config.cov.sample_sec, adc_config.cov.delta);
+        }
         for (i = 0; i < 32; i++) {
             if (adc_config.adc_lines_enabled & (1 << i)) {
                 printf("[umdk-" _UMDK_NAME_ "] Line #%d enabled\n", i+1);
@@ -292,20 +338,17 @@ void umdk_adc_init(uwnds_cb_t *event_callback)
     callback = event_callback;
     init_config();
 
-    init_adc();
+#if UNWDS_TLV_REPLIES
+    unwds_tlv_init(&tlv, ADC_NUMOF);
+#endif
 
-    /* Create handler thread */
-    char *stack = (char *) allocate_stack(UMDK_ADC_STACK_SIZE);
-    if (!stack) {
-    	return;
-    }
+    init_adc();
 
     unwds_add_shell_command( _UMDK_NAME_, "type '" _UMDK_NAME_ "' for commands list", umdk_adc_shell_cmd);
 
-    timer_pid = thread_create(stack, UMDK_ADC_STACK_SIZE, THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST, timer_thread, NULL, "ADC thread");
-
-    /* Start publishing timer */
-    rtctimers_millis_set_msg(&timer, 60000 * adc_config.publish_period_sec, &timer_msg, timer_pid);
+    /* Start publishing */
+    unwds_publisher_add(&publisher, prepare_result, callback, 60000 * adc_config.publish_period_sec);
+    unwds_publisher_set_cov(&publisher, sample_values, format_result, &adc_config.cov);
 }
 
 static void reply_ok(module_data_t *reply)
@@ -362,11 +405,17 @@ bool umdk_adc_cmd(module_data_t *cmd, module_data_t *reply)
             break;
         }
 
-        case UMDK_ADC_CMD_POLL:
-        	is_polled = true;
+        case UMDK_ADC_CMD_COV:
+            if (!unwds_publisher_cov_cmd(&publisher, _UMDK_MID_, cmd, reply)) {
+                reply_fail(reply);
+                break;
+            }
+
+            save_config();
+            break;
 
-            /* Send signal to publisher thread */
-            msg_send(&timer_msg, timer_pid);
+        case UMDK_ADC_CMD_POLL:
+        	unwds_publisher_poll(&publisher, true);
 
             return false; /* Don't reply */
 
@@ -33,8 +33,6 @@
 
 #include "unwds-common.h"
 
-#define UMDK_FDC1004_STACK_SIZE 1024
-
 #define UMDK_FDC1004_I2C 1
 
 #define UMDK_FDC1004_PUBLISH_PERIOD_MIN 1
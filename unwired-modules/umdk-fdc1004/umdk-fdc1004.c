@@ -58,17 +58,13 @@ extern "C" {
 
 #include "thread.h"
 #include "rtctimers-millis.h"
+#include "unwds-publisher.h"
 
 static fdc1004_t dev;
 
 static uwnds_cb_t *callback;
 
-static kernel_pid_t timer_pid;
-
-static msg_t timer_msg = {};
-static rtctimers_millis_t timer;
-
-static bool is_polled = false;
+static unwds_publisher_t publisher;
 
 static struct {
 	uint8_t publish_period_min;
@@ -100,33 +96,6 @@ static void prepare_result(module_data_t *buf) {
     }
 }
 
-static void *timer_thread(void *arg) {
-    (void) arg;
-    msg_t msg;
-    msg_t msg_queue[4];
-    msg_init_queue(msg_queue, 4);
-    
-    puts("[umdk-" _UMDK_NAME_ "] Periodic publisher thread started");
-
-    while (1) {
-        msg_receive(&msg);
-
-        module_data_t data = {};
-        data.as_ack = is_polled;
-        is_polled = false;
-
-        prepare_result(&data);
-
-        /* Notify the application */
-        callback(&data);
-
-        /* Restart after delay */
-        rtctimers_millis_set_msg(&timer, 60000 * fdc1004_config.publish_period_min, &timer_msg, timer_pid);
-    }
-
-    return NULL;
-}
-
 static void reset_config(void) {
 	fdc1004_config.publish_period_min = UMDK_FDC1004_PUBLISH_PERIOD_MIN;
 	fdc1004_config.i2c_dev = UMDK_FDC1004_I2C;
@@ -149,14 +118,12 @@ static inline void save_config(void) {
 }
 
 static void set_period (int period) {
-    rtctimers_millis_remove(&timer);
 
     fdc1004_config.publish_period_min = period;
+    unwds_publisher_set_period(&publisher, 60000 * fdc1004_config.publish_period_min);
 	save_config();
 
-	/* Don't restart timer if new period is zero */
 	if (fdc1004_config.publish_period_min) {
-        rtctimers_millis_set_msg(&timer, 60000 * fdc1004_config.publish_period_min, &timer_msg, timer_pid);
 		printf("[umdk-" _UMDK_NAME_ "] Period set to %d minute (s)\n", fdc1004_config.publish_period_min);
     } else {
         puts("[umdk-" _UMDK_NAME_ "] Timer stopped");
@@ -179,8 +146,7 @@ int umdk_fdc1004_shell_cmd(int argc, char **argv) {
     }
     
     if (strcmp(cmd, "send") == 0) {
-		/* Send signal to publisher thread */
-		msg_send(&timer_msg, timer_pid);
+		unwds_publisher_poll(&publisher, false);
     }
     
     if (strcmp(cmd, "period") == 0) {
@@ -208,18 +174,10 @@ void umdk_fdc1004_init(uwnds_cb_t *event_callback) {
         return;
 	}
 
-	/* Create handler thread */
-	char *stack = (char *) allocate_stack(UMDK_FDC1004_STACK_SIZE);
-	if (!stack) {
-		return;
-	}
-    
     unwds_add_shell_command( _UMDK_NAME_, "type '" _UMDK_NAME_ "' for commands list", umdk_fdc1004_shell_cmd);
     
-	timer_pid = thread_create(stack, UMDK_FDC1004_STACK_SIZE, THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST, timer_thread, NULL, "fdc1004 thread");
-
-    /* Start publishing timer */
-	rtctimers_millis_set_msg(&timer, 60000 * fdc1004_config.publish_period_min, &timer_msg, timer_pid);
+    /* Start publishing */
+	unwds_publisher_add(&publisher, prepare_result, callback, 60000 * fdc1004_config.publish_period_min);
 }
 
 static void reply_fail(module_data_t *reply) {
@@ -256,10 +214,7 @@ bool umdk_fdc1004_cmd(module_data_t *cmd, module_data_t *reply) {
 	}
 
 	case UMDK_FDC1004_CMD_POLL:
-		is_polled = true;
-
-		/* Send signal to publisher thread */
-		msg_send(&timer_msg, timer_pid);
+		unwds_publisher_poll(&publisher, true);
 
 		return false; /* Don't reply */
 
@@ -59,18 +59,14 @@ extern "C" {
 
 #include "thread.h"
 #include "rtctimers-millis.h"
+#include "unwds-publisher.h"
 
 #define ENABLE_DEBUG                    (0)
 #include "debug.h"
 
 static uwnds_cb_t *callback;
 
-static kernel_pid_t timer_pid;
-
-static msg_t timer_msg = {};
-static rtctimers_millis_t timer;
-
-static bool is_polled = false;
+static unwds_publisher_t publisher;
 
 static struct {
     uint8_t                     publish_period_sec;
@@ -506,42 +502,12 @@ static void prepare_result(module_data_t *buf)
     }
 }
 
-static void *timer_thread(void *arg)
-{
-    (void)arg;
-    
-    msg_t msg;
-    msg_t msg_queue[4];
-    msg_init_queue(msg_queue, 4);
-
-    puts("[umdk-" _UMDK_NAME_ "] Periodic publisher thread started");
-
-    while (1) {
-        msg_receive(&msg);
-
-        module_data_t data = {};
-        data.as_ack = is_polled;
-        is_polled = false;
-
-        prepare_result(&data);
-
-        /* Notify the application */
-        callback(&data);
-
-        /* Restart after delay */
-        rtctimers_millis_set_msg(&timer, 60 * 1000 * gassensor_config.publish_period_sec, &timer_msg, timer_pid);
-    }
-
-    return NULL;
-}
-
 static void set_period (int period) {
     gassensor_config.publish_period_sec = period;
+    unwds_publisher_set_period(&publisher, 60 * 1000 * gassensor_config.publish_period_sec);
     save_config();
 
-    /* Don't restart timer if new period is zero */
     if (gassensor_config.publish_period_sec) {
-        rtctimers_millis_set_msg(&timer, 60 * 1000 * gassensor_config.publish_period_sec, &timer_msg, timer_pid);
         printf("[umdk-" _UMDK_NAME_ "] Period set to %d minutes\n", gassensor_config.publish_period_sec);
     } else {
         puts("[umdk-" _UMDK_NAME_ "] Timer stopped");
@@ -566,8 +532,7 @@ int umdk_gassensor_shell_cmd(int argc, char **argv) {
     }
     
     if (strcmp(cmd, "send") == 0) {
-        /* Send signal to publisher thread */
-        msg_send(&timer_msg, timer_pid);
+        unwds_publisher_poll(&publisher, false);
     }
     
     if (strcmp(cmd, "period") == 0) {
@@ -622,18 +587,10 @@ void umdk_gassensor_init(uwnds_cb_t *event_callback)
 
     init_gassensor();
 
-    /* Create handler thread */
-    char *stack = (char *) allocate_stack(UMDK_GASSENSOR_STACK_SIZE);
-    if (!stack) {
-        return;
-    }
-
     unwds_add_shell_command( _UMDK_NAME_, "type '" _UMDK_NAME_ "' for commands list", umdk_gassensor_shell_cmd);
 
-    timer_pid = thread_create(stack, UMDK_GASSENSOR_STACK_SIZE, THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST, timer_thread, NULL, "ADC thread");
-
-    /* Start publishing timer */
-    rtctimers_millis_set_msg(&timer, 60 * 1000 * gassensor_config.publish_period_sec, &timer_msg, timer_pid);
+    /* Start publishing */
+    unwds_publisher_add(&publisher, prepare_result, callback, 60 * 1000 * gassensor_config.publish_period_sec);
 }
 
 static void reply_ok(module_data_t *reply)
@@ -668,10 +625,7 @@ bool umdk_gassensor_cmd(module_data_t *cmd, module_data_t *reply)
         }
 
         case UMDK_GASSENSOR_CMD_POLL:
-            is_polled = true;
-
-            /* Send signal to publisher thread */
-            msg_send(&timer_msg, timer_pid);
+            unwds_publisher_poll(&publisher, true);
 
             return false; /* Don't reply */
 
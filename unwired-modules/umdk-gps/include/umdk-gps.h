@@ -33,8 +33,6 @@
 
 #include "unwds-common.h"
 
-#define UMDK_GPS_READER_STACK_SIZE 1024
-
 #ifndef UMDK_GPS_UART
 #define UMDK_GPS_UART   1
 #endif
@@ -45,6 +43,7 @@ typedef enum {
 	UMDK_GPS_DATA = 0,
     UMDK_GPS_COMMAND = 1,
 	UMDK_GPS_CMD_POLL = 2,
+	UMDK_GPS_DATA_TLV = 3,		/**< Reading encoded with unwds-tlv */
 	UMDK_GPS_REPLY_ERROR = 0xFF,
 } umdk_gps_cmd_t;
 
@@ -54,6 +54,8 @@ extern "C" {
 
 #include "thread.h"
 #include "rtctimers-millis.h"
+#include "unwds-publisher.h"
+#include "unwds-tlv.h"
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
@@ -63,16 +65,19 @@ static uwnds_cb_t *callback;
 static mt3333_gps_data_t last_data;
 static mt3333_t gps;
 
-static kernel_pid_t timer_pid;
-static msg_t timer_msg = {};
-static rtctimers_millis_t timer;
+static unwds_publisher_t publisher;
+
+#if UNWDS_TLV_REPLIES
+/* valid, latitude, longitude, velocity, direction */
+#define UMDK_GPS_TLV_FIELDS 5
+
+static unwds_tlv_stream_t tlv;
+#endif
 
 static struct {
 	uint8_t publish_period_min;
 } gps_config;
 
-static bool is_polled = false;
-
 static void prepare_result(module_data_t *reply) {
     char lat[10], lon[10], dir[10];
     
@@ -97,6 +102,13 @@ static void prepare_result(module_data_t *reply) {
             valid = 1;
         }
         
+#if UNWDS_TLV_REPLIES
+        /* Parked device sends only the header */
+        int32_t fields[UMDK_GPS_TLV_FIELDS] = { valid, latitude, longitude, velocity, direction };
+
+        reply->data[1] = UMDK_GPS_DATA_TLV;
+        reply->length += unwds_tlv_encode(&tlv, fields, &reply->data[reply->length], UNWDS_MAX_DATA_LEN - reply->length);
+#else
         convert_to_be_sam((void *)&latitude, sizeof(latitude));
         convert_to_be_sam((void *)&longitude, sizeof(longitude));
         convert_to_be_sam((void *)&velocity, sizeof(velocity));
@@ -116,6 +128,7 @@ static void prepare_result(module_data_t *reply) {
         
         memcpy(&reply->data[reply->length], (void *)&direction, sizeof(direction));
         reply->length += sizeof(direction);
+#endif
 
         /*
         time_t time = last_data.time;
@@ -133,31 +146,6 @@ void gps_cb(mt3333_gps_data_t data)
     last_data = data;
 }
 
-static void *timer_thread(void *arg) {
-    (void)arg;
-    
-    msg_t msg;
-    
-    puts("[umdk-" _UMDK_NAME_ "] Periodic publisher thread started");
-
-    while (1) {
-        msg_receive(&msg);
-
-        module_data_t data = {};
-        data.as_ack = is_polled;
-        is_polled = false;
-
-        prepare_result(&data);
-
-        /* Notify the application */
-        callback(&data);
-        /* Restart after delay */
-        rtctimers_millis_set_msg(&timer, 60000 * gps_config.publish_period_min, &timer_msg, timer_pid);
-    }
-
-    return NULL;
-}
-
 static void reset_config(void) {
 	gps_config.publish_period_min = UMDK_GPS_PUBLISH_PERIOD_MIN;
 }
@@ -175,13 +163,11 @@ static inline void save_config(void) {
 }
 
 static void set_period (int period) {
-    rtctimers_millis_remove(&timer);
     gps_config.publish_period_min = period;
+    unwds_publisher_set_period(&publisher, 60000 * gps_config.publish_period_min);
 	save_config();
 
-	/* Don't restart timer if new period is zero */
 	if (gps_config.publish_period_min) {
-		rtctimers_millis_set_msg(&timer, 60000 * gps_config.publish_period_min, &timer_msg, timer_pid);
 		printf("[umdk-" _UMDK_NAME_ "] Period set to %d minute (s)\n", gps_config.publish_period_min);
 	} else {
 		puts("[umdk-" _UMDK_NAME_ "] Timer stopped");
@@ -203,8 +189,7 @@ int umdk_gps_shell_cmd(int argc, char **argv) {
     }
     
     if (strcmp(cmd, "send") == 0) {
-		is_polled = false;
-        msg_send(&timer_msg, timer_pid);
+        unwds_publisher_poll(&publisher, false);
     }
     
     if (strcmp(cmd, "period") == 0) {
@@ -222,6 +207,10 @@ void umdk_gps_init(uwnds_cb_t *event_callback)
     
     init_config();
 	printf("[umdk-" _UMDK_NAME_ "] Publish period: %d min\n", gps_config.publish_period_min);
+
+#if UNWDS_TLV_REPLIES
+    unwds_tlv_init(&tlv, UMDK_GPS_TLV_FIELDS);
+#endif
     
     /* Dynamically allocate MT3333 reading stack */
 	gps.reader_stack = (char *) allocate_stack(MT3333_READER_THREAD_STACK_SIZE_BYTES);
@@ -239,15 +228,8 @@ void umdk_gps_init(uwnds_cb_t *event_callback)
         return;
     }
     
-    char *stack = (char *) allocate_stack(UMDK_GPS_READER_STACK_SIZE);
-	if (!stack) {
-		return;
-	}
-    
-    timer_pid = thread_create(stack, UMDK_GPS_READER_STACK_SIZE, THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST, timer_thread, NULL, "gps thread");
-
-    /* Start publishing timer */
-	rtctimers_millis_set_msg(&timer, 60000 * gps_config.publish_period_min, &timer_msg, timer_pid);
+    /* Start publishing */
+	unwds_publisher_add(&publisher, prepare_result, callback, 60000 * gps_config.publish_period_min);
     
     unwds_add_shell_command(_UMDK_NAME_, "type '" _UMDK_NAME_ "' for commands list", umdk_gps_shell_cmd);
 }
@@ -259,10 +241,7 @@ bool umdk_gps_cmd(module_data_t *data, module_data_t *reply)
 	if (data->length > 0) {
 		switch (cmd) {
 		case UMDK_GPS_CMD_POLL:
-            is_polled = true;
-
-            /* Send signal to publisher thread */
-            msg_send(&timer_msg, timer_pid);
+            unwds_publisher_poll(&publisher, true);
 
             return false; /* Don't reply */
 
@@ -32,8 +32,6 @@
 
 #include "unwds-common.h"
 
-#define UMDK_HX711_STACK_SIZE 1024
-
 #define HX711_DATA_PIN      UNWD_GPIO_16
 #define HX711_SCK_PIN       UNWD_GPIO_17
 
@@ -51,15 +51,12 @@ extern "C" {
 #include "unwds-common.h"
 #include "thread.h"
 #include "rtctimers-millis.h"
+#include "unwds-publisher.h"
 #include "xtimer.h"
 
 static uwnds_cb_t *callback;
 
-static kernel_pid_t timer_pid;
-static msg_t timer_msg = {};
-static rtctimers_millis_t timer;
-
-static bool is_polled = false;
+static unwds_publisher_t publisher;
 
 
 static struct {
@@ -155,13 +152,9 @@ static void prepare_result(module_data_t *data) {
 
 void set_period(int period) {
     hx711_config.publish_period_min = period;
+    unwds_publisher_set_period(&publisher, 60000 * hx711_config.publish_period_min);
         
     printf("[umdk-" _UMDK_NAME_ "] Period set to %d minutes\n", hx711_config.publish_period_min);
-    if (hx711_config.publish_period_min != 0) {
-        rtctimers_millis_set_msg(&timer, 60000 * hx711_config.publish_period_min, &timer_msg, timer_pid);
-    } else {
-        rtctimers_millis_remove(&timer);
-    }
     
     save_config();
 }
@@ -186,9 +179,7 @@ int umdk_hx711_shell_cmd(int argc, char **argv) {
     }
     
     if (strcmp(cmd, "send") == 0) {
-        is_polled = false;
-        /* Send signal to publisher thread */
-		msg_send(&timer_msg, timer_pid);
+        unwds_publisher_poll(&publisher, false);
     }
     
     if (strcmp(cmd, "zero") == 0) {
@@ -232,33 +223,6 @@ int umdk_hx711_shell_cmd(int argc, char **argv) {
     return 1;
 }
 
-static void *timer_thread(void *arg) {
-    (void) arg;
-    msg_t msg;
-    msg_t msg_queue[4];
-    msg_init_queue(msg_queue, 4);
-
-    puts("[umdk-" _UMDK_NAME_ "] Periodic publisher thread started");
-
-    while (1) {
-        msg_receive(&msg);
-
-        module_data_t data = {};
-        data.as_ack = is_polled;
-        is_polled = false;
-
-        prepare_result(&data);
-
-        /* Notify the application */
-        callback(&data);
-
-        /* Restart after delay */
-        rtctimers_millis_set_msg(&timer, 60000 * hx711_config.publish_period_min, &timer_msg, timer_pid);
-    }
-    
-    return NULL;
-}
-
 void umdk_hx711_init(uwnds_cb_t *event_callback)
 {
 
@@ -272,17 +236,8 @@ void umdk_hx711_init(uwnds_cb_t *event_callback)
     /* put HX711 to sleep */
     gpio_set(HX711_SCK_PIN);
     
-    /* Create handler thread */
-	char *stack = (char *) allocate_stack(UMDK_HX711_STACK_SIZE);
-	if (!stack) {
-		return;
-	}
-    
-	timer_pid = thread_create(stack, UMDK_HX711_STACK_SIZE, THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST, timer_thread, NULL, "hx711 thread");
-    
-
-    /* Start publishing timer */
-	rtctimers_millis_set_msg(&timer, 60000 * hx711_config.publish_period_min, &timer_msg, timer_pid);
+    /* Start publishing */
+	unwds_publisher_add(&publisher, prepare_result, callback, 60000 * hx711_config.publish_period_min);
 
     puts("[umdk-" _UMDK_NAME_ "] HX711 ADC ready");
     
@@ -310,9 +265,7 @@ bool umdk_hx711_cmd(module_data_t *data, module_data_t *reply)
 
 	switch (c) {
 	case UMDK_HX711_CMD_POLL:
-        is_polled = true;
-        /* Send signal to publisher thread */
-		msg_send(&timer_msg, timer_pid);
+        unwds_publisher_poll(&publisher, true);
 		return false; /* Don't reply now */
         
     case UMDK_HX711_CMD_PERIOD: {
@@ -33,8 +33,6 @@
 
 #include "unwds-common.h"
 
-#define UMDK_LIGHT_STACK_SIZE         1024
-
 #define UMDK_LIGHT_I2C                1
 
 #define UMDK_LIGHT_PUBLISH_PERIOD_MIN 1
@@ -43,6 +41,7 @@ typedef enum {
     UMDK_LIGHT_DATA = 0,
 	UMDK_LIGHT_CMD_COMMAND = 1,
 	UMDK_LIGHT_CMD_POLL = 2,
+	UMDK_LIGHT_CMD_COV = 3,		/**< Change-of-value mode: sampling period [s] (2 bytes) | delta [lux] (2 bytes) */
     UMDK_LIGHT_CMD_FAIL = 0xFF,
 } umdk_light_cmd_t;
 
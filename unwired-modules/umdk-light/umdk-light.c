@@ -58,17 +58,13 @@ extern "C" {
 
 #include "thread.h"
 #include "rtctimers-millis.h"
+#include "unwds-publisher.h"
 
 static opt3001_t dev_opt3001;
 
 static uwnds_cb_t *callback;
 
-static kernel_pid_t timer_pid;
-
-static msg_t timer_msg = {};
-static rtctimers_millis_t timer;
-
-static bool is_polled = false;
+static unwds_publisher_t publisher;
 
 typedef enum {
     UMDK_LIGHT_OPT3001  = 1,
@@ -79,6 +75,7 @@ static uint8_t active_sensors = 0;
 static struct {
 	uint8_t publish_period_min;
 	uint8_t i2c_dev;
+	unwds_publisher_cov_t cov;
 } light_config;
 
 static bool init_sensor(void) {
@@ -94,7 +91,7 @@ static bool init_sensor(void) {
 	return (active_sensors != 0);
 }
 
-static void prepare_result(module_data_t *data) {
+static uint16_t measure(void) {
     uint16_t luminocity = 0;
     
     if (active_sensors & UMDK_LIGHT_OPT3001) {
@@ -112,6 +109,18 @@ static void prepare_result(module_data_t *data) {
         }
     }
 
+    return luminocity;
+}
+
+static size_t sample_values(int32_t *values) {
+    values[0] = measure();
+    return 1;
+}
+
+static void format_result(module_data_t *data, const int32_t *values, size_t num) {
+    (void)num;
+    uint16_t luminocity = values[0];
+
 	printf("[umdk-" _UMDK_NAME_ "] Luminocity %u lux\n", luminocity);
     
     if (data) {
@@ -126,37 +135,16 @@ static void prepare_result(module_data_t *data) {
     }
 }
 
-static void *timer_thread(void *arg) {
-    (void)arg;
-    
-    msg_t msg;
-    msg_t msg_queue[4];
-    msg_init_queue(msg_queue, 4);
-    
-    puts("[umdk-" _UMDK_NAME_ "] Periodic publisher thread started");
-
-    while (1) {
-        msg_receive(&msg);
-
-        module_data_t data = {};
-        data.as_ack = is_polled;
-        is_polled = false;
-
-        prepare_result(&data);
-
-        /* Notify the application */
-        callback(&data);
-
-        /* Restart after delay */
-        rtctimers_millis_set_msg(&timer, 60000 * light_config.publish_period_min, &timer_msg, timer_pid);
-    }
-
-    return NULL;
+static void prepare_result(module_data_t *data) {
+    int32_t values[1];
+    format_result(data, values, sample_values(values));
 }
 
 static void reset_config(void) {
 	light_config.publish_period_min = UMDK_LIGHT_PUBLISH_PERIOD_MIN;
 	light_config.i2c_dev = UMDK_LIGHT_I2C;
+	light_config.cov.sample_sec = 0;
+	light_config.cov.delta = 0;
 }
 
 static void init_config(void) {
@@ -176,14 +164,11 @@ static inline void save_config(void) {
 }
 
 static void set_period (int period) {
-    rtctimers_millis_remove(&timer);
-
     light_config.publish_period_min = period;
+    unwds_publisher_set_period(&publisher, 60000 * light_config.publish_period_min);
 	save_config();
 
-	/* Don't restart timer if new period is zero */
 	if (light_config.publish_period_min) {
-        rtctimers_millis_set_msg(&timer, 60000 * light_config.publish_period_min, &timer_msg, timer_pid);
 		printf("[umdk-" _UMDK_NAME_ "] Period set to %d minute (s)\n", light_config.publish_period_min);
     } else {
         puts("[umdk-" _UMDK_NAME_ "] Timer stopped");
@@ -195,6 +180,7 @@ int umdk_light_shell_cmd(int argc, char **argv) {
         puts (_UMDK_NAME_ " get - get results now");
         puts (_UMDK_NAME_ " send - get and send results now");
         puts (_UMDK_NAME_ " period <N> - set period to N minutes");
+        puts (_UMDK_NAME_ " cov <S> <D> - sample every S seconds, send on D lux change, S = 0 to disable");
         puts (_UMDK_NAME_ " reset - reset settings to default");
         return 0;
     }
@@ -206,8 +192,7 @@ int umdk_light_shell_cmd(int argc, char **argv) {
     }
     
     if (strcmp(cmd, "send") == 0) {
-		/* Send signal to publisher thread */
-		msg_send(&timer_msg, timer_pid);
+		unwds_publisher_poll(&publisher, false);
     }
     
     if (strcmp(cmd, "period") == 0) {
@@ -215,6 +200,10 @@ int umdk_light_shell_cmd(int argc, char **argv) {
         set_period(atoi(val));
     }
     
+    if (unwds_publisher_cov_shell_cmd(&publisher, argc, argv)) {
+        save_config();
+    }
+    
     if (strcmp(cmd, "reset") == 0) {
         reset_config();
         save_config();
@@ -235,18 +224,11 @@ void umdk_light_init(uwnds_cb_t *event_callback) {
         return;
 	}
 
-	/* Create handler thread */
-	char *stack = (char *) allocate_stack(UMDK_LIGHT_STACK_SIZE);
-	if (!stack) {
-		return;
-	}
-    
     unwds_add_shell_command( _UMDK_NAME_, "type '" _UMDK_NAME_ "' for commands list", umdk_light_shell_cmd);
 
-	timer_pid = thread_create(stack, UMDK_LIGHT_STACK_SIZE, THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST, timer_thread, NULL, "opt3001 thread");
-
-    /* Start publishing timer */
-	rtctimers_millis_set_msg(&timer, 60000 * light_config.publish_period_min, &timer_msg, timer_pid);
+    /* Start publishing */
+	unwds_publisher_add(&publisher, prepare_result, callback, 60000 * light_config.publish_period_min);
+	unwds_publisher_set_cov(&publisher, sample_values, format_result, &light_config.cov);
 }
 
 static void reply_fail(module_data_t *reply) {
@@ -282,11 +264,17 @@ bool umdk_light_cmd(module_data_t *cmd, module_data_t *reply) {
 		break;
 	}
 
-	case UMDK_LIGHT_CMD_POLL:
-		is_polled = true;
+	case UMDK_LIGHT_CMD_COV:
+		if (!unwds_publisher_cov_cmd(&publisher, _UMDK_MID_, cmd, reply)) {
+			reply_fail(reply);
+			break;
+		}
+
+		save_config();
+		break;
 
-		/* Send signal to publisher thread */
-		msg_send(&timer_msg, timer_pid);
+	case UMDK_LIGHT_CMD_POLL:
+		unwds_publisher_poll(&publisher, true);
 
 		return false; /* Don't reply */
 
@@ -33,8 +33,6 @@
 
 #include "unwds-common.h"
 
-#define UMDK_LMT01_STACK_SIZE 1024
-
 #define UMDK_LMT01_MAX_SENSOR_COUNT 4
 #define UMDK_LMT01_SENSOR_EN_PINS { UNWD_GPIO_4, UNWD_GPIO_5, UNWD_GPIO_25, UNWD_GPIO_26 }
 #define UMDK_LMT01_INT_PIN UNWD_GPIO_28
@@ -48,6 +46,7 @@ typedef enum {
 	UMDK_LMT01_CMD_SET_PERIOD = 0,
 	UMDK_LMT01_CMD_POLL = 1,
 	UMDK_LMT01_CMD_SET_GPIOS = 2,
+	UMDK_LMT01_CMD_COV = 3,		/**< Change-of-value mode: sampling period [s] (2 bytes) | delta [0.1 C] (2 bytes) */
 } umdk_lmt01_cmd_t;
 
 void umdk_lmt01_init(uwnds_cb_t *event_callback);
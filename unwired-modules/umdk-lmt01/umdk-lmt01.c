@@ -57,21 +57,18 @@ extern "C" {
 #include "thread.h"
 #include "xtimer.h"
 #include "rtctimers-millis.h"
+#include "unwds-publisher.h"
 
 static gpio_t en_pins[UMDK_LMT01_MAX_SENSOR_COUNT] = UMDK_LMT01_SENSOR_EN_PINS;
 static lmt01_t sensors[UMDK_LMT01_MAX_SENSOR_COUNT];
 
 static uwnds_cb_t *callback;
 
-static kernel_pid_t timer_pid;
-
-static msg_t timer_msg = {};
-static rtctimers_millis_t timer;
-
-static bool is_polled = false;
+static unwds_publisher_t publisher;
 
 static struct {
 	uint8_t publish_period_min;
+	unwds_publisher_cov_t cov;
 } lmt01_config;
 
 static void init_sensors(void) {
@@ -100,12 +97,9 @@ static void init_sensors(void) {
 	}
 }
 
-static void prepare_result(module_data_t *data) {
-	int results = 0;
+static void measure(int16_t *res, bool verbose) {
 	int i;
 
-	int16_t res[4] = { 0x7FFF, 0x7FFF, 0x7FFF, 0x7FFF };
-
 	for (i = 0; i < UMDK_LMT01_MAX_SENSOR_COUNT; i++) {
 		if (!en_pins[i]) {
 			continue;
@@ -114,11 +108,12 @@ static void prepare_result(module_data_t *data) {
 		int temp;
 		int pulses;
 		if ((pulses = lmt01_get_temp(&sensors[i], &temp)) > 0) {
-            char buf[10];
-            int_to_float_str(buf, temp, 1);
-			printf("[umdk-" _UMDK_NAME_ "] Measured %d pulses on #%d: %s\n", pulses, i, buf);
+			if (verbose) {
+				char buf[10];
+				int_to_float_str(buf, temp, 1);
+				printf("[umdk-" _UMDK_NAME_ "] Measured %d pulses on #%d: %s\n", pulses, i, buf);
+			}
 			res[i] = temp;
-			results++;
 		} else {
 			continue;
 		}
@@ -126,44 +121,47 @@ static void prepare_result(module_data_t *data) {
 		/* Delay between sensor switching */
         rtctimers_millis_sleep(UMDK_LMT01_SWITCHING_DELAY_MS);
 	}
-
-    if (data) {
-        data->data[0] = _UMDK_MID_;
-        memcpy(data->data + 1, (uint8_t *) res, sizeof(res));
-        data->length = sizeof(res) + 1;
-    }
 }
 
-static void *timer_thread(void *arg) {
-    (void)arg;
+static size_t sample_values(int32_t *values) {
+	int16_t res[UMDK_LMT01_MAX_SENSOR_COUNT] = { 0x7FFF, 0x7FFF, 0x7FFF, 0x7FFF };
+	measure(res, false);
 
-    msg_t msg;
-    msg_t msg_queue[4];
-    msg_init_queue(msg_queue, 4);
-
-    puts("[umdk-" _UMDK_NAME_ "] Periodic publisher thread started");
-
-    while (1) {
-        msg_receive(&msg);
+	for (int i = 0; i < UMDK_LMT01_MAX_SENSOR_COUNT; i++) {
+		values[i] = res[i];
+	}
 
-        module_data_t data = {};
-        data.as_ack = is_polled;
-        is_polled = false;
+	return UMDK_LMT01_MAX_SENSOR_COUNT;
+}
 
-        prepare_result(&data);
+static void format_result(module_data_t *data, const int32_t *values, size_t num) {
+	int16_t res[UMDK_LMT01_MAX_SENSOR_COUNT];
 
-        /* Notify the application */
-        callback(&data);
+	for (int i = 0; i < UMDK_LMT01_MAX_SENSOR_COUNT; i++) {
+		res[i] = ((size_t) i < num) ? values[i] : 0x7FFF;
+		if (res[i] != 0x7FFF) {
+			char buf[10];
+			int_to_float_str(buf, res[i], 1);
+			printf("[umdk-" _UMDK_NAME_ "] Temperature on #%d: %s\n", i, buf);
+		}
+	}
 
-        /* Restart after delay */
-        rtctimers_millis_set_msg(&timer, 60000 * lmt01_config.publish_period_min, &timer_msg, timer_pid);
+    if (data) {
+        data->data[0] = _UMDK_MID_;
+        memcpy(data->data + 1, (uint8_t *) res, sizeof(res));
+        data->length = sizeof(res) + 1;
     }
-    
-    return NULL;
+}
+
+static void prepare_result(module_data_t *data) {
+	int32_t values[UMDK_LMT01_MAX_SENSOR_COUNT];
+	format_result(data, values, sample_values(values));
 }
 
 static void reset_config(void) {
 	lmt01_config.publish_period_min = UMDK_LMT01_PUBLISH_PERIOD_MIN;
+	lmt01_config.cov.sample_sec = 0;
+	lmt01_config.cov.delta = 0;
 }
 
 static void init_config(void) {
@@ -179,12 +177,10 @@ static inline void save_config(void) {
 }
 
 static void set_period (int period) {
-    rtctimers_millis_remove(&timer);
 	lmt01_config.publish_period_min = period;
+	unwds_publisher_set_period(&publisher, 60000 * lmt01_config.publish_period_min);
 
-	/* Don't restart timer if new period is zero */
 	if (lmt01_config.publish_period_min) {
-		rtctimers_millis_set_msg(&timer, 60000 * lmt01_config.publish_period_min, &timer_msg, timer_pid);
 		printf("[umdk-" _UMDK_NAME_ "] Period set to %d minutes\n", lmt01_config.publish_period_min);
 	} else {
 		puts("[umdk-" _UMDK_NAME_ "] Timer stopped");
@@ -197,6 +193,7 @@ int umdk_lmt01_shell_cmd(int argc, char **argv) {
         puts (_UMDK_NAME_ " get - get results now");
         puts (_UMDK_NAME_ " send - get and send results now");
         puts (_UMDK_NAME_ " period <N> - set period to N minutes");
+        puts (_UMDK_NAME_ " cov <S> <D> - sample every S seconds, send on change by D (0.1 C), S = 0 to disable");
         puts (_UMDK_NAME_ " reset - reset settings to default");
         return 0;
     }
@@ -208,8 +205,7 @@ int umdk_lmt01_shell_cmd(int argc, char **argv) {
     }
     
     if (strcmp(cmd, "send") == 0) {
-		/* Send signal to publisher thread */
-		msg_send(&timer_msg, timer_pid);
+		unwds_publisher_poll(&publisher, false);
     }
     
     if (strcmp(cmd, "period") == 0) {
@@ -217,6 +213,10 @@ int umdk_lmt01_shell_cmd(int argc, char **argv) {
         set_period(atoi(val));
     }
     
+    if (unwds_publisher_cov_shell_cmd(&publisher, argc, argv)) {
+        save_config();
+    }
+    
     if (strcmp(cmd, "reset") == 0) {
         reset_config();
         save_config();
@@ -233,18 +233,11 @@ void umdk_lmt01_init(uwnds_cb_t *event_callback) {
 
 	init_sensors();
 
-	/* Create handler thread */
-	char *stack = (char *) allocate_stack(UMDK_LMT01_STACK_SIZE);
-	if (!stack) {
-		return;
-	}
-
     unwds_add_shell_command(_UMDK_NAME_, "type '" _UMDK_NAME_ "' for commands list", umdk_lmt01_shell_cmd);
     
-	timer_pid = thread_create(stack, UMDK_LMT01_STACK_SIZE, THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST, timer_thread, NULL, "lmt01 thread");
-
-    /* Start publishing timer */
-	rtctimers_millis_set_msg(&timer, 60000 * lmt01_config.publish_period_min, &timer_msg, timer_pid);
+    /* Start publishing */
+	unwds_publisher_add(&publisher, prepare_result, callback, 60000 * lmt01_config.publish_period_min);
+	unwds_publisher_set_cov(&publisher, sample_values, format_result, &lmt01_config.cov);
 }
 
 static void reply_fail(module_data_t *reply) {
@@ -281,15 +274,21 @@ bool umdk_lmt01_cmd(module_data_t *cmd, module_data_t *reply) {
 	}
 
 	case UMDK_LMT01_CMD_POLL:
-		is_polled = true;
-
-		/* Send signal to publisher thread */
-		msg_send(&timer_msg, timer_pid);
+		unwds_publisher_poll(&publisher, true);
 
 		return false; /* Don't reply now */
 
 		break;
 
+	case UMDK_LMT01_CMD_COV:
+		if (!unwds_publisher_cov_cmd(&publisher, _UMDK_MID_, cmd, reply)) {
+			reply_fail(reply);
+			break;
+		}
+
+		save_config();
+		break;
+
 	case UMDK_LMT01_CMD_SET_GPIOS: {
 		uint8_t *gpios = &cmd->data[1];
 		int num_gpios = cmd->length - 1;
@@ -33,8 +33,6 @@
 
 #include "unwds-common.h"
 
-#define UMDK_METEO_STACK_SIZE 1024
-
 #define UMDK_METEO_PUBLISH_PERIOD_MIN 1
 
 #define UMDK_METEO_I2C 1
@@ -55,6 +53,8 @@ typedef enum {
     UMDK_METEO_DATA = 0,
 	UMDK_METEO_COMMAND = 1,
 	UMDK_METEO_POLL = 2,
+	UMDK_METEO_DATA_TLV = 3,	/**< Reading encoded with unwds-tlv */
+	UMDK_METEO_COV = 4,			/**< Change-of-value mode: sampling period [s] (2 bytes) | delta (2 bytes) */
     UMDK_METEO_FAIL = 0xFF,
 } umdk_meteo_cmd_t;
 
@@ -61,6 +61,8 @@ extern "C" {
 
 #include "thread.h"
 #include "rtctimers-millis.h"
+#include "unwds-publisher.h"
+#include "unwds-tlv.h"
 
 static bmx280_t dev_bmx280;
 static sht21_t dev_sht21;
@@ -69,12 +71,14 @@ static lm75_t dev_lm75;
 
 static uwnds_cb_t *callback;
 
-static kernel_pid_t timer_pid;
+static unwds_publisher_t publisher;
 
-static msg_t timer_msg = {};
-static rtctimers_millis_t timer;
+#if UNWDS_TLV_REPLIES
+/* temperature, humidity, pressure */
+#define UMDK_METEO_TLV_FIELDS 3
 
-static bool is_polled = false;
+static unwds_tlv_stream_t tlv;
+#endif
 
 typedef enum {
     UMDK_METEO_BME280   = 1,
@@ -87,6 +91,7 @@ static uint8_t active_sensors = 0;
 
 static struct {
 	uint8_t publish_period_min;
+	unwds_publisher_cov_t cov;
 } meteo_config;
 
 static bool init_sensor(void) {
@@ -124,8 +129,10 @@ static bool init_sensor(void) {
 	return (active_sensors != 0);
 }
 
-static void prepare_result(module_data_t *data) {
-    int16_t measurements[3] = { SHRT_MAX };
+static void measure(int16_t *measurements) {
+    measurements[0] = SHRT_MAX;
+    measurements[1] = 0;
+    measurements[2] = 0;
     
     if (active_sensors & UMDK_METEO_BME280) {
         measurements[0] = (5 + bmx280_read_temperature(&dev_bmx280))/10; /* degrees C * 100 -> degrees C * 10 */
@@ -156,6 +163,22 @@ static void prepare_result(module_data_t *data) {
             measurements[1] = (measure.humidity + 50) / 100;
         }
     }
+}
+
+static size_t sample_values(int32_t *values) {
+    int16_t measurements[3];
+    measure(measurements);
+
+    for (int i = 0; i < 3; i++) {
+        values[i] = measurements[i];
+    }
+
+    return 3;
+}
+
+static void format_result(module_data_t *data, const int32_t *values, size_t num) {
+    (void)num;
+    int16_t measurements[3] = { values[0], values[1], values[2] };
     
     char buf[2][10];
     int_to_float_str(buf[0], measurements[0], 1);
@@ -163,48 +186,39 @@ static void prepare_result(module_data_t *data) {
     
 	printf("[umdk-" _UMDK_NAME_ "] Temperature %s C, humidity: %s%%, pressure: %d mbar\n", buf[0], buf[1], measurements[2]);
     
-    for (int i = 0; i < 3; i++) {
-        convert_to_be_sam((void *)&measurements[i], sizeof(measurements[i]));
-    }
-
     if (data) {
         data->data[0] = _UMDK_MID_;
-        data->data[1] = UMDK_METEO_DATA;
         data->length = 2;
 
+#if UNWDS_TLV_REPLIES
+        /* Weather changes slowly, mostly the differences of a few units are sent */
+        int32_t fields[UMDK_METEO_TLV_FIELDS] = { measurements[0], measurements[1], measurements[2] };
+
+        data->data[1] = UMDK_METEO_DATA_TLV;
+        data->length += unwds_tlv_encode(&tlv, fields, &data->data[data->length], UNWDS_MAX_DATA_LEN - data->length);
+#else
+        for (int i = 0; i < 3; i++) {
+            convert_to_be_sam((void *)&measurements[i], sizeof(measurements[i]));
+        }
+
+        data->data[1] = UMDK_METEO_DATA;
+
         /* Copy measurements into response */
         memcpy(&data->data[data->length], (uint8_t *)measurements, sizeof(measurements));
         data->length += sizeof(measurements);
+#endif
     }
 }
 
-static void *timer_thread(void *arg) {
-    (void)arg;
-    
-    msg_t msg;
-    
-    puts("[umdk-" _UMDK_NAME_ "] Periodic publisher thread started");
-
-    while (1) {
-        msg_receive(&msg);
-
-        module_data_t data = {};
-        data.as_ack = is_polled;
-        is_polled = false;
-
-        prepare_result(&data);
-
-        /* Notify the application */
-        callback(&data);
-        /* Restart after delay */
-        rtctimers_millis_set_msg(&timer, 60000 * meteo_config.publish_period_min, &timer_msg, timer_pid);
-    }
-
-    return NULL;
+static void prepare_result(module_data_t *data) {
+    int32_t values[3];
+    format_result(data, values, sample_values(values));
 }
 
 static void reset_config(void) {
 	meteo_config.publish_period_min = UMDK_METEO_PUBLISH_PERIOD_MIN;
+	meteo_config.cov.sample_sec = 0;
+	meteo_config.cov.delta = 0;
 }
 
 static void init_config(void) {
@@ -221,13 +235,11 @@ static inline void save_config(void) {
 }
 
 static void set_period (int period) {
-    rtctimers_millis_remove(&timer);
     meteo_config.publish_period_min = period;
+    unwds_publisher_set_period(&publisher, 60000 * meteo_config.publish_period_min);
 	save_config();
 
-	/* Don't restart timer if new period is zero */
 	if (meteo_config.publish_period_min) {
-		rtctimers_millis_set_msg(&timer, 60000 * meteo_config.publish_period_min, &timer_msg, timer_pid);
 		printf("[umdk-" _UMDK_NAME_ "] Period set to %d minute (s)\n", meteo_config.publish_period_min);
 	} else {
 		puts("[umdk-" _UMDK_NAME_ "] Timer stopped");
@@ -239,6 +251,7 @@ int umdk_meteo_shell_cmd(int argc, char **argv) {
         puts (_UMDK_NAME_ " get - get results now");
         puts (_UMDK_NAME_ " send - get and send results now");
         puts (_UMDK_NAME_ " period <N> - set period to N minutes");
+        puts (_UMDK_NAME_ " cov <S> <D> - sample every S seconds, send on change by D (0.1 C, 0.1 %, mbar), S = 0 to disable");
         puts (_UMDK_NAME_ " - reset settings to default");
         return 0;
     }
@@ -250,8 +263,7 @@ int umdk_meteo_shell_cmd(int argc, char **argv) {
     }
     
     if (strcmp(cmd, "send") == 0) {
-		/* Send signal to publisher thread */
-		msg_send(&timer_msg, timer_pid);
+		unwds_publisher_poll(&publisher, false);
     }
     
     if (strcmp(cmd, "period") == 0) {
@@ -259,6 +271,10 @@ int umdk_meteo_shell_cmd(int argc, char **argv) {
         set_period(atoi(val));
     }
     
+    if (unwds_publisher_cov_shell_cmd(&publisher, argc, argv)) {
+        save_config();
+    }
+    
     if (strcmp(cmd, "reset") == 0) {
         reset_config();
         save_config();
@@ -274,23 +290,20 @@ void umdk_meteo_init(uwnds_cb_t *event_callback) {
 	init_config();
 	printf("[umdk-" _UMDK_NAME_ "] Publish period: %d min\n", meteo_config.publish_period_min);
 
+#if UNWDS_TLV_REPLIES
+	unwds_tlv_init(&tlv, UMDK_METEO_TLV_FIELDS);
+#endif
+
 	if (!init_sensor()) {
 		puts("[umdk-" _UMDK_NAME_ "] No sensors found");
         return;
 	}
 
-	/* Create handler thread */
-	char *stack = (char *) allocate_stack(UMDK_METEO_STACK_SIZE);
-	if (!stack) {
-		return;
-	}
-    
     unwds_add_shell_command(_UMDK_NAME_, "type '" _UMDK_NAME_ "' for commands list", umdk_meteo_shell_cmd);
 
-	timer_pid = thread_create(stack, UMDK_METEO_STACK_SIZE, THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST, timer_thread, NULL, "bme280 thread");
-
-    /* Start publishing timer */
-	rtctimers_millis_set_msg(&timer, 60000 * meteo_config.publish_period_min, &timer_msg, timer_pid);
+    /* Start publishing */
+	unwds_publisher_add(&publisher, prepare_result, callback, 60000 * meteo_config.publish_period_min);
+	unwds_publisher_set_cov(&publisher, sample_values, format_result, &meteo_config.cov);
 }
 
 static void reply_fail(module_data_t *reply) {
@@ -326,11 +339,17 @@ bool umdk_meteo_cmd(module_data_t *cmd, module_data_t *reply) {
 		break;
 	}
 
-	case UMDK_METEO_POLL:
-		is_polled = true;
+	case UMDK_METEO_COV:
+		if (!unwds_publisher_cov_cmd(&publisher, _UMDK_MID_, cmd, reply)) {
+			reply_fail(reply);
+			break;
+		}
 
-		/* Send signal to publisher thread */
-		msg_send(&timer_msg, timer_pid);
+		save_config();
+		break;
+
+	case UMDK_METEO_POLL:
+		unwds_publisher_poll(&publisher, true);
 
 		return false; /* Don't reply */
 